@@ -7,6 +7,10 @@ LEX_SCRIPT="./run_lex_tests.sh"
 SYNTAX_SCRIPT="./run_stx_tests.sh"
 SEM_SCRIPT="./run_sem_tests.sh"
 CODEGEN_SCRIPT="./run_cc_tests.sh"
+STRESS_SCRIPT="./run_stress_tests.sh"
+BATCH_SCRIPT="./run_batch_tests.sh"
+PARALLEL_SCRIPT="./run_parallel_tests.sh"
+SERVE_SCRIPT="./run_serve_tests.sh"
 
 if [[ ! -x "${LEX_SCRIPT}" || ! -x "${SYNTAX_SCRIPT}" || ! -x "${SEM_SCRIPT}" ]]; then
 	echo "Required test scripts are missing or not executable." >&2
@@ -78,3 +82,15 @@ print_percent "${sem_data[0]}" "${sem_data[1]:-0}" "${sem_data[2]:-0}"
 
 echo "CodeGen: "
 ${CODEGEN_SCRIPT};
+
+echo "Stress: "
+${STRESS_SCRIPT};
+
+echo "Batch: "
+${BATCH_SCRIPT};
+
+echo "Parallel: "
+${PARALLEL_SCRIPT};
+
+echo "Serve: "
+${SERVE_SCRIPT};
@@ -0,0 +1,155 @@
+#!/usr/bin/env bash
+# Runs tests of batch mode (./compiler --batch input --out-dir dir).
+# Every corpus directory is compiled in one batch and each source must get the same code,
+# error messages and exit code as a separate `./compiler < source` run. Sources whose outputs
+# would share one name must be rejected before anything is written. Batch workers must not start
+# parallel passes of their own even when these are forced.
+
+set -u
+
+PROJECT_BIN="../src/compiler"
+EXAMPLES_DIR="exampleCodesIFJ25"
+PARALLEL_OPTIONS=(--threads=4 --semantic-parallel-min=0 --gen-parallel-min=0)
+
+# simple ANSI colors (disabled when stdout is not a TTY)
+if [[ -t 1 ]]; then
+	GREEN=$'\033[32m'
+	RED=$'\033[31m'
+	BOLD=$'\033[1m'
+	RESET=$'\033[0m'
+else
+	GREEN=""
+	RED=""
+	BOLD=""
+	RESET=""
+fi
+
+if [[ ! -x "${PROJECT_BIN}" ]]; then
+	echo "Compiler ${PROJECT_BIN} not found or not executable. Run 'make' first." >&2
+	exit 1
+fi
+
+TMP_DIR=$(mktemp -d)
+trap "rm -rf '${TMP_DIR}'" EXIT
+
+total=0
+passed=0
+failed=0
+
+pass() {
+	printf "${GREEN}[PASS]${RESET} %-30s\n" "$1"
+	((passed++))
+}
+
+fail() {
+	printf "${RED}[FAIL]${RESET} %-30s reason: ${BOLD}%s${RESET}\n" "$1" "$2"
+	((failed++))
+}
+
+# run_dir_case <corpus directory>
+# Compiles the directory in batch mode and compares every source with a direct compilation.
+run_dir_case() {
+	local name="batch_$1"
+	local out="${TMP_DIR}/$1"
+	((total++))
+
+	"${PROJECT_BIN}" --batch "${EXAMPLES_DIR}/$1" --out-dir "${out}" 2>/dev/null
+	local batch_exit_code=$?
+	if [[ ${batch_exit_code} -ne 0 || ! -f "${out}/summary.txt" ]]; then
+		fail "${name}" "Batch Error (code ${batch_exit_code})"
+		return
+	fi
+
+	local exit_code ms source stem
+	while IFS=$'\t' read -r exit_code ms source; do
+		[[ "${exit_code}" == \#* ]] && continue
+		stem=$(basename "${source}")
+		stem="${stem%.*}"
+		"${PROJECT_BIN}" < "${source}" > "${TMP_DIR}/code" 2> "${TMP_DIR}/err"
+		if [[ $? -ne ${exit_code} ]]; then
+			fail "${name}" "Exit Code Differs (${source})"
+			return
+		fi
+		if ! cmp -s "${TMP_DIR}/code" "${out}/${stem}.ifjcode25" ||
+			! cmp -s "${TMP_DIR}/err" "${out}/${stem}.err"; then
+			fail "${name}" "Output Differs (${source})"
+			return
+		fi
+	done < "${out}/summary.txt"
+
+	pass "${name}"
+}
+
+# run_nested_case <corpus directory>
+# Compiles the directory again with parallel passes forced, run_dir_case must have run first.
+# Outputs must be the same and statistics must show no semantic or codegen tasks.
+run_nested_case() {
+	local name="batch_nested_$1"
+	local out="${TMP_DIR}/nested_$1"
+	((total++))
+
+	"${PROJECT_BIN}" "${PARALLEL_OPTIONS[@]}" --stats-json --batch "${EXAMPLES_DIR}/$1" \
+		--out-dir "${out}" 2> "${TMP_DIR}/nested.err"
+	local batch_exit_code=$?
+	if [[ ${batch_exit_code} -ne 0 ]]; then
+		fail "${name}" "Batch Error (code ${batch_exit_code})"
+		return
+	fi
+	if grep -q '"\(semTasks\|genTasks\)":[1-9]' "${TMP_DIR}/nested.err"; then
+		fail "${name}" "Nested Pool Started"
+		return
+	fi
+	# summary.txt holds times of compilations
+	if ! diff -rq -x summary.txt "${TMP_DIR}/$1" "${out}" > /dev/null; then
+		fail "${name}" "Output Differs"
+		return
+	fi
+
+	pass "${name}"
+}
+
+# run_collision_case <name> <batch input> <output directory>
+# Batch must fail with internal error and leave the output directory unwritten.
+run_collision_case() {
+	local name="$1"
+	((total++))
+
+	"${PROJECT_BIN}" --batch "$2" --out-dir "$3" 2>/dev/null
+	local batch_exit_code=$?
+	if [[ ${batch_exit_code} -ne 99 ]]; then
+		fail "${name}" "Expected Exit 99, got ${batch_exit_code}"
+		return
+	fi
+	if [[ -e "$3" ]]; then
+		fail "${name}" "Output Written"
+		return
+	fi
+
+	pass "${name}"
+}
+
+run_dir_case "lex_tests"
+run_dir_case "syntax_tests"
+run_dir_case "sem_tests"
+run_dir_case "codegen_tests"
+run_nested_case "codegen_tests"
+
+# Same name in two directories of a list file
+mkdir -p "${TMP_DIR}/a" "${TMP_DIR}/b"
+printf 'import "ifj25" for Ifj\nclass Program {\n    static main() {\n    }\n}\n' > "${TMP_DIR}/a/x.txt"
+cp "${TMP_DIR}/a/x.txt" "${TMP_DIR}/b/x.txt"
+printf '%s\n' "${TMP_DIR}/a/x.txt" "${TMP_DIR}/b/x.txt" > "${TMP_DIR}/list"
+run_collision_case "collision_list" "${TMP_DIR}/list" "${TMP_DIR}/out_list"
+
+# Same name with another extension in one directory
+cp "${TMP_DIR}/a/x.txt" "${TMP_DIR}/a/x.wren"
+run_collision_case "collision_extension" "${TMP_DIR}/a" "${TMP_DIR}/out_dir"
+
+summary_color="${GREEN}"
+(( failed > 0 )) && summary_color="${RED}"
+
+printf "\n${summary_color}Summary:${RESET} %d total | ${GREEN}%d passed${RESET} | ${RED}%d failed${RESET}\n" \
+	"${total}" "${passed}" "${failed}"
+
+(( failed == 0 )) || exit 1
+exit 0
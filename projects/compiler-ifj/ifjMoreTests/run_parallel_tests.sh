@@ -0,0 +1,225 @@
+#!/usr/bin/env bash
+# Runs tests of parallel compiler passes.
+# Parallel passes normally start only with more CPUs and large programs, so every source is
+# compiled once serially and once with them forced (PARALLEL_OPTIONS). Code, error messages
+# and exit code must be the same. Statistics of the forced run show whether workers ran.
+# Code generation has no errors reachable from source (only internal checks), its error
+# path shares the ordered merge with the output that is compared here.
+
+set -u
+
+PROJECT_BIN="../src/compiler"
+EXAMPLES_DIR="exampleCodesIFJ25"
+PARALLEL_OPTIONS=(--threads=4 --semantic-parallel-min=0 --gen-parallel-min=0)
+
+# simple ANSI colors (disabled when stdout is not a TTY)
+if [[ -t 1 ]]; then
+	GREEN=$'\033[32m'
+	RED=$'\033[31m'
+	BOLD=$'\033[1m'
+	RESET=$'\033[0m'
+else
+	GREEN=""
+	RED=""
+	BOLD=""
+	RESET=""
+fi
+
+if [[ ! -x "${PROJECT_BIN}" ]]; then
+	echo "Compiler ${PROJECT_BIN} not found or not executable. Run 'make' first." >&2
+	exit 1
+fi
+
+TMP_DIR=$(mktemp -d)
+trap "rm -rf '${TMP_DIR}'" EXIT
+
+total=0
+passed=0
+failed=0
+
+pass() {
+	printf "${GREEN}[PASS]${RESET} %-30s\n" "$1"
+	((passed++))
+}
+
+fail() {
+	printf "${RED}[FAIL]${RESET} %-30s reason: ${BOLD}%s${RESET}\n" "$1" "$2"
+	((failed++))
+}
+
+# compare_source <source> [serial mode options] [parallel mode options]
+# Compiles source serially and in parallel, statistics of the parallel run go to stats.json.
+# Mode options (e.g. "--incremental dir") are passed as one word each and may be empty.
+# Returns 1 when the results differ.
+compare_source() {
+	local serial_mode=(${2:-})
+	local parallel_mode=(${3:-})
+	"${PROJECT_BIN}" "${serial_mode[@]}" < "$1" > "${TMP_DIR}/serial.code" 2> "${TMP_DIR}/serial.err"
+	local serial_exit_code=$?
+	"${PROJECT_BIN}" "${parallel_mode[@]}" "${PARALLEL_OPTIONS[@]}" --stats-json < "$1" \
+		> "${TMP_DIR}/parallel.code" 2> "${TMP_DIR}/parallel.all"
+	local parallel_exit_code=$?
+
+	# statistics are the last line of stderr
+	tail -n 1 "${TMP_DIR}/parallel.all" > "${TMP_DIR}/stats.json"
+	head -n -1 "${TMP_DIR}/parallel.all" > "${TMP_DIR}/parallel.err"
+
+	[[ ${serial_exit_code} -eq ${parallel_exit_code} ]] &&
+		cmp -s "${TMP_DIR}/serial.code" "${TMP_DIR}/parallel.code" &&
+		cmp -s "${TMP_DIR}/serial.err" "${TMP_DIR}/parallel.err"
+}
+
+# counter <name>
+# Prints counter of the last parallel run.
+counter() {
+	grep -o "\"$1\":[0-9]*" "${TMP_DIR}/stats.json" | cut -d: -f2
+}
+
+# run_dir_case <corpus directory>
+run_dir_case() {
+	local name="parallel_$1"
+	((total++))
+
+	local source
+	for source in "${EXAMPLES_DIR}/$1"/*.txt "${EXAMPLES_DIR}/$1"/*.wren; do
+		[[ -f "${source}" ]] || continue
+		if ! compare_source "${source}"; then
+			fail "${name}" "Output Differs (${source})"
+			return
+		fi
+	done
+
+	pass "${name}"
+}
+
+# run_worker_case <name> <expected exit code> <expected stderr pattern> <source>
+# Source must be checked by worker threads and give the expected error.
+run_worker_case() {
+	local name="$1"
+	((total++))
+
+	if ! compare_source "$4"; then
+		fail "${name}" "Output Differs"
+		return
+	fi
+	if [[ "$(counter semTasks)" -lt 2 ]]; then
+		fail "${name}" "Semantic Workers Not Used"
+		return
+	fi
+	"${PROJECT_BIN}" < "$4" > /dev/null 2>&1
+	local exit_code=$?
+	if [[ ${exit_code} -ne $2 ]] || ! grep -q "$3" "${TMP_DIR}/parallel.err"; then
+		fail "${name}" "Wrong Error (code ${exit_code})"
+		return
+	fi
+
+	pass "${name}"
+}
+
+# run_gen_case <name> <source>
+# Source must be generated by codegen workers, serially and in parallel also through the
+# incremental cache: cold, warm, and warm after an edit of the source.
+run_gen_case() {
+	local name="$1"
+	((total++))
+
+	if ! compare_source "$2"; then
+		fail "${name}" "Output Differs"
+		return
+	fi
+	if [[ "$(counter genTasks)" -lt 4 ]]; then
+		fail "${name}" "Codegen Workers Not Used"
+		return
+	fi
+
+	local modes=("--incremental ${TMP_DIR}/cache_serial" "--incremental ${TMP_DIR}/cache_parallel")
+	local run
+	for run in cold warm; do
+		if ! compare_source "$2" "${modes[0]}" "${modes[1]}"; then
+			fail "${name}" "Incremental Output Differs (${run})"
+			return
+		fi
+	done
+	sed -i 's/x = a + 1$/x = a + 7/' "$2"
+	if ! compare_source "$2" "${modes[0]}" "${modes[1]}" ||
+		[[ "$(counter genTasks)" -ne 1 ]]; then
+		fail "${name}" "Incremental Output Differs (edited)"
+		return
+	fi
+
+	pass "${name}"
+}
+
+run_dir_case "sem_tests"
+run_dir_case "codegen_tests"
+run_dir_case "gen_tests"
+
+# Two functions checked by workers fail, the error of the first one in source order wins
+cat > "${TMP_DIR}/worker_error.txt" << 'EOF'
+import "ifj25" for Ifj
+class Program {
+    static first(a) {
+        var x
+        x = a + 1
+        return x
+    }
+    static second(b) {
+        var y
+        y = missing(b)
+        return y
+    }
+    static third(c) {
+        var z
+        z = alsoMissing(c)
+        return z
+    }
+    static main() {
+        var r
+        r = first(1)
+        Ifj.write(r)
+    }
+}
+EOF
+run_worker_case "semantic_worker_error" 3 "at line 10," "${TMP_DIR}/worker_error.txt"
+
+# Functions with labels and temporaries, each worker numbers them on its own
+awk '
+BEGIN {
+	print "import \"ifj25\" for Ifj"
+	print "class Program {"
+	for (f = 0; f < 6; f++) {
+		print "    static f" f "(a) {"
+		print "        var x"
+		print "        var i"
+		print "        i = 0"
+		print "        x = a + " f
+		print "        while (i < 3) {"
+		print "            if (x > 10) {"
+		print "                x = x - 1"
+		print "            } else {"
+		print "                x = x + i"
+		print "            }"
+		print "            i = i + 1"
+		print "        }"
+		print "        return x"
+		print "    }"
+	}
+	print "    static main() {"
+	print "        var r"
+	for (f = 0; f < 6; f++) {
+		print "        r = f" f "(" 4 * f ")"
+		print "        Ifj.write(r)"
+	}
+	print "    }"
+	print "}"
+}' > "${TMP_DIR}/functions.txt"
+run_gen_case "codegen_workers" "${TMP_DIR}/functions.txt"
+
+summary_color="${GREEN}"
+(( failed > 0 )) && summary_color="${RED}"
+
+printf "\n${summary_color}Summary:${RESET} %d total | ${GREEN}%d passed${RESET} | ${RED}%d failed${RESET}\n" \
+	"${total}" "${passed}" "${failed}"
+
+(( failed == 0 )) || exit 1
+exit 0
@@ -0,0 +1,197 @@
+#!/usr/bin/env bash
+# Runs tests of compiler daemon (./compiler --serve socket) and its client.
+# Every corpus source is compiled through the client and must get the same code, error
+# messages and exit code as `./compiler < source`. A request process killed by a signal must
+# be reported as exit code 128 + signal, like in shell. Statistics options of the daemon must
+# not leak into responses.
+
+set -u
+
+PROJECT_BIN="../src/compiler"
+CLIENT_BIN="../src/client/compiler-client"
+EXAMPLES_DIR="exampleCodesIFJ25"
+
+# simple ANSI colors (disabled when stdout is not a TTY)
+if [[ -t 1 ]]; then
+	GREEN=$'\033[32m'
+	RED=$'\033[31m'
+	BOLD=$'\033[1m'
+	RESET=$'\033[0m'
+else
+	GREEN=""
+	RED=""
+	BOLD=""
+	RESET=""
+fi
+
+if [[ ! -x "${PROJECT_BIN}" ]]; then
+	echo "Compiler ${PROJECT_BIN} not found or not executable. Run 'make' first." >&2
+	exit 1
+fi
+
+if [[ ! -x "${CLIENT_BIN}" ]]; then
+	echo "Client ${CLIENT_BIN} not found or not executable. Run 'make client' first." >&2
+	exit 1
+fi
+
+TMP_DIR=$(mktemp -d)
+SERVER_PID=""
+cleanup() {
+	[[ -n "${SERVER_PID}" ]] && kill "${SERVER_PID}" 2>/dev/null
+	rm -rf "${TMP_DIR}"
+}
+trap cleanup EXIT
+
+export IFJ_COMPILER_SOCKET="${TMP_DIR}/compiler.sock"
+
+total=0
+passed=0
+failed=0
+
+pass() {
+	printf "${GREEN}[PASS]${RESET} %-30s\n" "$1"
+	((passed++))
+}
+
+fail() {
+	printf "${RED}[FAIL]${RESET} %-30s reason: ${BOLD}%s${RESET}\n" "$1" "$2"
+	((failed++))
+}
+
+# start_server [compiler options...]
+# Starts daemon in background, its own stderr goes to server.err.
+start_server() {
+	"${PROJECT_BIN}" "$@" --serve "${IFJ_COMPILER_SOCKET}" 2> "${TMP_DIR}/server.err" &
+	SERVER_PID=$!
+	local i
+	for ((i = 0; i < 100; i++)); do
+		[[ -S "${IFJ_COMPILER_SOCKET}" ]] && return 0
+		sleep 0.05
+	done
+	echo "Compiler daemon did not create ${IFJ_COMPILER_SOCKET}." >&2
+	exit 1
+}
+
+# stop_server
+# Stops daemon with SIGTERM, returns its exit code.
+stop_server() {
+	kill -TERM "${SERVER_PID}"
+	wait "${SERVER_PID}"
+	local server_exit_code=$?
+	SERVER_PID=""
+	return ${server_exit_code}
+}
+
+# compare_source <source>
+# Returns 1 when compilation through client differs from direct compilation.
+compare_source() {
+	"${PROJECT_BIN}" < "$1" > "${TMP_DIR}/direct.code" 2> "${TMP_DIR}/direct.err"
+	local direct_exit_code=$?
+	"${CLIENT_BIN}" < "$1" > "${TMP_DIR}/client.code" 2> "${TMP_DIR}/client.err"
+	local client_exit_code=$?
+
+	[[ ${direct_exit_code} -eq ${client_exit_code} ]] &&
+		cmp -s "${TMP_DIR}/direct.code" "${TMP_DIR}/client.code" &&
+		cmp -s "${TMP_DIR}/direct.err" "${TMP_DIR}/client.err"
+}
+
+# run_dir_case <corpus directory>
+run_dir_case() {
+	local name="serve_$1"
+	((total++))
+
+	local source
+	for source in "${EXAMPLES_DIR}/$1"/*.txt "${EXAMPLES_DIR}/$1"/*.wren; do
+		[[ -f "${source}" ]] || continue
+		if ! compare_source "${source}"; then
+			fail "${name}" "Output Differs (${source})"
+			return
+		fi
+	done
+
+	pass "${name}"
+}
+
+# run_crash_case
+# Kills process of a long request with SIGSEGV, client must exit with 128 + 11.
+run_crash_case() {
+	local name="serve_crash_signal"
+	((total++))
+
+	# flat sum large enough to keep request process alive until it is found
+	awk 'BEGIN {
+		print "import \"ifj25\" for Ifj"
+		print "class Program {"
+		print "    static main() {"
+		print "        var result"
+		printf "        result = 1"
+		for (i = 1; i < 2000000; i++) printf " + 1"
+		print ""
+		print "    }"
+		print "}"
+	}' > "${TMP_DIR}/long.txt"
+
+	"${CLIENT_BIN}" < "${TMP_DIR}/long.txt" > /dev/null 2>&1 &
+	local client_pid=$!
+
+	# daemon -> request process, the only child of daemon while the client waits
+	local request_pid="" i
+	for ((i = 0; i < 200; i++)); do
+		request_pid=$(pgrep -P "${SERVER_PID}")
+		[[ -n "${request_pid}" ]] && break
+		sleep 0.01
+	done
+	if [[ -z "${request_pid}" ]]; then
+		wait "${client_pid}"
+		fail "${name}" "Request Process Not Found"
+		return
+	fi
+
+	kill -SEGV "${request_pid}"
+	wait "${client_pid}"
+	local client_exit_code=$?
+	if [[ ${client_exit_code} -ne 139 ]]; then
+		fail "${name}" "Expected Exit 139, got ${client_exit_code}"
+		return
+	fi
+
+	pass "${name}"
+}
+
+start_server
+
+run_dir_case "lex_tests"
+run_dir_case "syntax_tests"
+run_dir_case "sem_tests"
+run_dir_case "codegen_tests"
+run_dir_case "gen_tests"
+run_crash_case
+
+((total++))
+if stop_server && [[ ! -e "${IFJ_COMPILER_SOCKET}" ]]; then
+	pass "serve_stop"
+else
+	fail "serve_stop" "Daemon Did Not Stop Cleanly"
+fi
+
+# Statistics belong to the daemon, request processes must not write them to the client
+start_server --stats-json
+((total++))
+if ! compare_source "${EXAMPLES_DIR}/sem_tests/test5_wrong_args_5.txt" ||
+	! compare_source "${EXAMPLES_DIR}/gen_tests/add_only.wren"; then
+	stop_server
+	fail "serve_stats_in_daemon" "Statistics In Response"
+elif ! stop_server || [[ $(grep -c '^{"totalMs"' "${TMP_DIR}/server.err") -ne 1 ]]; then
+	fail "serve_stats_in_daemon" "Daemon Did Not Report"
+else
+	pass "serve_stats_in_daemon"
+fi
+
+summary_color="${GREEN}"
+(( failed > 0 )) && summary_color="${RED}"
+
+printf "\n${summary_color}Summary:${RESET} %d total | ${GREEN}%d passed${RESET} | ${RED}%d failed${RESET}\n" \
+	"${total}" "${passed}" "${failed}"
+
+(( failed == 0 )) || exit 1
+exit 0
@@ -0,0 +1,124 @@
+#!/usr/bin/env bash
+# Runs stress tests with generated sources that are too large to keep in the repository.
+# Every case generates a program, compiles it via stdin, runs the result in the interpreter
+# and compares its output with the expected value. The per-test timeout also guards against
+# non-linear behavior of the compiler.
+
+set -u
+
+PROJECT_BIN="../src/compiler"
+INTERPRETER_BIN="tools/ic25int-linux-x86_64"
+
+# timeout per test (format accepted by `timeout`, e.g., 5s). Set TEST_TIMEOUT=0 to disable.
+TEST_TIMEOUT="${TEST_TIMEOUT:-10s}"
+USE_TIMEOUT=1
+if [[ "${TEST_TIMEOUT}" == "0" ]]; then
+	USE_TIMEOUT=0
+else
+	if ! command -v timeout >/dev/null 2>&1; then
+		echo "Utility 'timeout' not found but TEST_TIMEOUT is enabled." >&2
+		exit 1
+	fi
+fi
+
+# simple ANSI colors (disabled when stdout is not a TTY)
+if [[ -t 1 ]]; then
+	GREEN=$'\033[32m'
+	RED=$'\033[31m'
+	BOLD=$'\033[1m'
+	RESET=$'\033[0m'
+else
+	GREEN=""
+	RED=""
+	BOLD=""
+	RESET=""
+fi
+
+if [[ ! -x "${PROJECT_BIN}" ]]; then
+	echo "Compiler ${PROJECT_BIN} not found or not executable. Run 'make' first." >&2
+	exit 1
+fi
+
+if [[ ! -x "${INTERPRETER_BIN}" ]]; then
+	echo "Interpreter ${INTERPRETER_BIN} not found or not executable." >&2
+	exit 1
+fi
+
+TMP_SRC=$(mktemp)
+TMP_CODE=$(mktemp)
+TMP_OUT=$(mktemp)
+trap "rm -f '${TMP_SRC}' '${TMP_CODE}' '${TMP_OUT}'" EXIT
+
+# gen_sum <operands> <paren depth>
+# Prints program writing a flat sum "1 + 1 + ... + 1" of <operands> ones wrapped in <paren depth>
+# redundant parentheses. The flat sum parses as a left-deep chain of operators, so every pass
+# over the AST must walk it without recursing on the left side.
+gen_sum() {
+	awk -v n="$1" -v depth="$2" '
+	BEGIN {
+		print "import \"ifj25\" for Ifj"
+		print "class Program {"
+		print "    static main() {"
+		print "        var result"
+		printf "        result = "
+		for (i = 0; i < depth; i++) printf "("
+		printf "1"
+		for (i = 1; i < n; i++) printf " + 1"
+		for (i = 0; i < depth; i++) printf ")"
+		print ""
+		print "        Ifj.write(result)"
+		print "        Ifj.write(\"\\n\")"
+		print "    }"
+		print "}"
+	}'
+}
+
+total=0
+passed=0
+failed=0
+
+# run_case <name> <expected output> <generator...>
+run_case() {
+	local name="$1"
+	local expected="$2"
+	shift 2
+	((total++))
+
+	"$@" > "${TMP_SRC}"
+
+	local compile_exit_code
+	if [[ ${USE_TIMEOUT} -eq 1 ]]; then
+		timeout "${TEST_TIMEOUT}" "${PROJECT_BIN}" < "${TMP_SRC}" > "${TMP_CODE}" 2>/dev/null
+	else
+		"${PROJECT_BIN}" < "${TMP_SRC}" > "${TMP_CODE}" 2>/dev/null
+	fi
+	compile_exit_code=$?
+	if [[ ${compile_exit_code} -ne 0 ]]; then
+		printf "${RED}[FAIL]${RESET} %-30s reason: ${BOLD}Compile Error${RESET} (code %s)\n" \
+			"${name}" "${compile_exit_code}"
+		((failed++))
+		return
+	fi
+
+	"${INTERPRETER_BIN}" "${TMP_CODE}" < /dev/null > "${TMP_OUT}" 2>/dev/null
+	if [[ "$(cat "${TMP_OUT}")" != "${expected}" ]]; then
+		printf "${RED}[FAIL]${RESET} %-30s reason: ${BOLD}Wrong Output${RESET}\n" "${name}"
+		((failed++))
+		return
+	fi
+
+	printf "${GREEN}[PASS]${RESET} %-30s\n" "${name}"
+	((passed++))
+}
+
+run_case "sum_100000_operands" "100000" gen_sum 100000 0
+run_case "sum_100000_parens" "100000" gen_sum 100000 100000
+
+summary_color="${GREEN}"
+(( failed > 0 )) && summary_color="${RED}"
+
+printf "\n${summary_color}Summary:${RESET} %d total | ${GREEN}%d passed${RESET} | ${RED}%d failed${RESET}\n" \
+	"${total}" "${passed}" "${failed}"
+
+(( failed == 0 )) || exit 1
+exit 0
@@ -0,0 +1,124 @@
+/**
+ * @file arena.c
+ * @author Ondrej Prazak (xprazao00)
+ * @brief Bump allocator for data that lives as long as one compilation
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "stats.h"
+
+void arenaInit(Arena *arena, size_t blockSize)
+{
+    arena->head = NULL;
+    arena->spare = NULL;
+    arena->blockSize = blockSize ? blockSize : ARENA_BLOCK_SIZE;
+}
+
+void *arenaAlloc(Arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    ArenaBlock *block = arena->head;
+    if (!block || block->size - block->used < size)
+    {
+        // Velké alokace dostanou vlastní blok, aby neplýtvaly zbytkem aktuálního
+        size_t blockSize = size > arena->blockSize ? size : arena->blockSize;
+        if (arena->spare && blockSize == arena->blockSize)
+        {
+            // Blok z předchozí kompilace (arenaReset)
+            block = arena->spare;
+            arena->spare = block->next;
+        }
+        else
+        {
+            block = malloc(sizeof(ArenaBlock) + blockSize);
+            if (!block)
+            {
+                errorExit(INTERNAL_ERROR, "Failed to allocate arena block", 0, NULL);
+            }
+            block->size = blockSize;
+            STATS_COUNT(STAT_ARENA_BLOCKS, 1);
+            STATS_COUNT(STAT_ARENA_BYTES, blockSize);
+        }
+        block->used = 0;
+
+        if (arena->head && size > arena->blockSize)
+        {
+            // Vložíme za aktuální blok, aby se dal dál používat jeho zbytek
+            block->next = arena->head->next;
+            arena->head->next = block;
+        }
+        else
+        {
+            block->next = arena->head;
+            arena->head = block;
+        }
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    STATS_COUNT(STAT_ARENA_ALLOCS, 1);
+    return ptr;
+}
+
+void *arenaCalloc(Arena *arena, size_t size)
+{
+    void *ptr = arenaAlloc(arena, size);
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+char *arenaStrdup(Arena *arena, const char *str)
+{
+    size_t len = strlen(str);
+    char *copy = arenaAlloc(arena, len + 1);
+    memcpy(copy, str, len + 1);
+    return copy;
+}
+
+static void arenaFreeBlocks(ArenaBlock *block)
+{
+    while (block)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+void arenaReset(Arena *arena)
+{
+    ArenaBlock *block = arena->head;
+    while (block)
+    {
+        ArenaBlock *next = block->next;
+        if (block->size == arena->blockSize)
+        {
+            block->next = arena->spare;
+            arena->spare = block;
+        }
+        else
+        {
+            free(block);  // Velké bloky jsou vzácné, příště by stejně nestačily
+        }
+        block = next;
+    }
+
+    arena->head = NULL;
+}
+
+void arenaDispose(Arena *arena)
+{
+    arenaFreeBlocks(arena->head);
+    arenaFreeBlocks(arena->spare);
+    arena->head = NULL;
+    arena->spare = NULL;
+}
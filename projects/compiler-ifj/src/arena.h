@@ -0,0 +1,92 @@
+/**
+ * @file arena.h
+ * @author Ondrej Prazak (xprazao00)
+ * @brief Bump allocator for data that lives as long as one compilation
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE 16384
+#define ARENA_ALIGNMENT 8
+
+/**
+ * @brief One chunk of arena memory, blocks are chained newest first
+ *
+ */
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    unsigned char data[];
+} ArenaBlock;
+
+/**
+ * @brief Arena owning every block it handed out, freed all at once
+ *
+ */
+typedef struct Arena
+{
+    ArenaBlock *head;
+    ArenaBlock *spare;  // blocks kept by arenaReset, reused before malloc
+    size_t blockSize;
+} Arena;
+
+/**
+ * @brief Initialize empty arena, first block is allocated lazily
+ *
+ * @param arena arena to initialize
+ * @param blockSize default size of one block (0 uses ARENA_BLOCK_SIZE)
+ */
+void arenaInit(Arena *arena, size_t blockSize);
+
+/**
+ * @brief Allocate size bytes aligned to ARENA_ALIGNMENT
+ *
+ * @param arena arena to allocate from
+ * @param size number of bytes
+ * @return void* never NULL, exits with INTERNAL_ERROR when out of memory
+ */
+void *arenaAlloc(Arena *arena, size_t size);
+
+/**
+ * @brief Same as arenaAlloc but memory is zeroed
+ *
+ * @param arena arena to allocate from
+ * @param size number of bytes
+ * @return void*
+ */
+void *arenaCalloc(Arena *arena, size_t size);
+
+/**
+ * @brief Copy zero terminated string into arena
+ *
+ * @param arena arena to allocate from
+ * @param str string to copy
+ * @return char*
+ */
+char *arenaStrdup(Arena *arena, const char *str);
+
+/**
+ * @brief Release all allocations but keep blocks of default size for next use
+ *
+ * Every pointer from arena becomes invalid. Meant for arena reused by many compilations.
+ *
+ * @param arena arena to reset
+ */
+void arenaReset(Arena *arena);
+
+/**
+ * @brief Free all blocks of arena, every pointer from it becomes invalid
+ *
+ * @param arena arena to dispose
+ */
+void arenaDispose(Arena *arena);
+
+#endif  // ARENA_H
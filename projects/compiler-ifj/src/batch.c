@@ -0,0 +1,363 @@
+/**
+ * @file batch.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Compilation of many source files in one process
+ * @version 0.1
+ * @date 2025-12-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "batch.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "driver.h"
+#include "error.h"
+#include "scankernel.h"
+#include "sourcemap.h"
+#include "threadpool.h"
+#include "utils.h"
+
+#define BATCH_INITIAL_FILES 64
+
+typedef struct
+{
+    char* path;      // Source file
+    int code;        // Exit code the compiler would end with
+    double seconds;  // Compile time
+} BatchFile;
+
+typedef struct
+{
+    BatchFile* files;
+    long count;
+    long capacity;
+    const char* outDir;
+    pthread_mutex_t lock;  // Guards next
+    long next;             // First file not taken by a worker
+} Batch;
+
+static double batchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void batchAddFile(Batch* batch, const char* path)
+{
+    if (batch->count == batch->capacity)
+    {
+        long capacity = batch->capacity ? batch->capacity * 2 : BATCH_INITIAL_FILES;
+        BatchFile* files = realloc(batch->files, sizeof(BatchFile) * capacity);
+        if (!files)
+        {
+            errorExit(INTERNAL_ERROR, "Failed to allocate batch", 0, NULL);
+        }
+        batch->files = files;
+        batch->capacity = capacity;
+    }
+
+    BatchFile* file = &batch->files[batch->count++];
+    file->path = strdup(path);
+    if (!file->path)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate batch", 0, NULL);
+    }
+    file->code = 0;
+    file->seconds = 0;
+}
+
+static bool batchIsSource(const char* name)
+{
+    const char* dot = strrchr(name, '.');
+    return dot && (strcmp(dot, ".wren") == 0 || strcmp(dot, ".txt") == 0);
+}
+
+static int batchComparePaths(const void* a, const void* b)
+{
+    return strcmp(((const BatchFile*)a)->path, ((const BatchFile*)b)->path);
+}
+
+/**
+ * @brief Sources of directory sorted by name, so the order does not depend on file system
+ */
+static bool batchListDirectory(Batch* batch, const char* dirPath)
+{
+    DIR* dir = opendir(dirPath);
+    if (!dir) return false;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (!batchIsSource(entry->d_name)) continue;
+
+        size_t size = strlen(dirPath) + strlen(entry->d_name) + 2;
+        char* path = malloc(size);
+        if (!path)
+        {
+            closedir(dir);
+            errorExit(INTERNAL_ERROR, "Failed to allocate batch", 0, NULL);
+        }
+        snprintf(path, size, "%s/%s", dirPath, entry->d_name);
+
+        struct stat info;
+        if (stat(path, &info) == 0 && S_ISREG(info.st_mode)) batchAddFile(batch, path);
+        free(path);
+    }
+    closedir(dir);
+
+    qsort(batch->files, batch->count, sizeof(BatchFile), batchComparePaths);
+    return true;
+}
+
+/**
+ * @brief Sources listed one per line, empty lines are skipped
+ */
+static bool batchListFile(Batch* batch, const char* listPath)
+{
+    FILE* list = fopen(listPath, "r");
+    if (!list) return false;
+
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    while ((length = getline(&line, &size, list)) >= 0)
+    {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+            line[--length] = '\0';
+        if (length > 0) batchAddFile(batch, line);
+    }
+    free(line);
+    fclose(list);
+    return true;
+}
+
+/**
+ * @brief Output path of source, `outDir/name` + suffix, caller frees
+ */
+static char* batchOutputPath(const char* outDir, const char* source, const char* suffix)
+{
+    const char* name = strrchr(source, '/');
+    name = name ? name + 1 : source;
+    const char* dot = strrchr(name, '.');
+    int nameLength = dot && dot != name ? (int)(dot - name) : (int)strlen(name);
+
+    size_t size = strlen(outDir) + nameLength + strlen(suffix) + 2;
+    char* path = malloc(size);
+    if (!path)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate batch output path", 0, NULL);
+    }
+    snprintf(path, size, "%s/%.*s%s", outDir, nameLength, name, suffix);
+    return path;
+}
+
+typedef struct
+{
+    char* name;          // Output path without suffix
+    const char* source;  // Source the name belongs to
+} BatchOutput;
+
+static int batchCompareOutputs(const void* a, const void* b)
+{
+    return strcmp(((const BatchOutput*)a)->name, ((const BatchOutput*)b)->name);
+}
+
+/**
+ * @brief Rejects batch whose two sources would write the same output files
+ *
+ * Only base name of source is kept, so `a/x.txt` and `b/x.txt` (or `x.txt` and `x.wren`)
+ * collide. Checked before any worker starts, nothing is written then.
+ */
+static void batchCheckOutputs(Batch* batch)
+{
+    if (batch->count < 2) return;
+
+    BatchOutput* outputs = malloc(sizeof(BatchOutput) * batch->count);
+    if (!outputs)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate batch", 0, NULL);
+    }
+    for (long i = 0; i < batch->count; i++)
+    {
+        outputs[i].name = batchOutputPath(batch->outDir, batch->files[i].path, "");
+        outputs[i].source = batch->files[i].path;
+    }
+    qsort(outputs, batch->count, sizeof(BatchOutput), batchCompareOutputs);
+
+    bool collision = false;
+    for (long i = 1; i < batch->count; i++)
+    {
+        if (strcmp(outputs[i - 1].name, outputs[i].name) != 0) continue;
+        fprintf(stderr, "Batch sources %s and %s share output %s\n", outputs[i - 1].source,
+                outputs[i].source, outputs[i].name);
+        collision = true;
+    }
+    for (long i = 0; i < batch->count; i++) free(outputs[i].name);
+    free(outputs);
+
+    if (collision)
+    {
+        errorExit(INTERNAL_ERROR, "Batch sources have the same output name", 0, NULL);
+    }
+}
+
+/**
+ * @brief Compiles one source, errorExit is caught and its message goes to .err file
+ */
+static void batchCompile(Batch* batch, BatchFile* file, SymTableStack* symStack,
+                         CompileState* state)
+{
+    char* outPath = batchOutputPath(batch->outDir, file->path, ".ifjcode25");
+    char* errPath = batchOutputPath(batch->outDir, file->path, ".err");
+    FILE* source = fopen(file->path, "r");
+    FILE* out = fopen(outPath, "w");
+    FILE* err = fopen(errPath, "w");
+    free(outPath);
+    free(errPath);
+
+    double start = batchNow();
+    if (!source || !out || !err)
+    {
+        if (err)
+        {
+            fprintf(err, "Error (code %d) at line 0: Couldnt open source file\n", INTERNAL_ERROR);
+        }
+        file->code = INTERNAL_ERROR;
+    }
+    else
+    {
+        ErrorTrap trap;
+        memset(&trap, 0, sizeof(trap));
+        trap.log = err;
+
+        emitSetOutput(out);
+        errorTrapSet(&trap);
+        if (setjmp(trap.jump) == 0)
+        {
+            compileRun(state, source, symStack, NULL);
+            file->code = 0;
+        }
+        else
+        {
+            // Stav leží mimo rámec setjmp, po skoku v něm zůstal zdroj, AST i parser souboru
+            file->code = trap.code;
+            compileStateDispose(state);
+            sourceMapSetCurrent(NULL);
+        }
+        errorTrapSet(NULL);
+        emitSetOutput(NULL);
+    }
+    file->seconds = batchNow() - start;
+
+    if (source) fclose(source);
+    if (out) fclose(out);
+    if (err) fclose(err);
+}
+
+/**
+ * @brief Worker takes files until none is left, all of them share its symbol table stack
+ */
+static void batchWorker(void* arg)
+{
+    Batch* batch = arg;
+    SymTableStack* symStack = compileSymStackCreate();
+    CompileState state;
+
+    while (true)
+    {
+        pthread_mutex_lock(&batch->lock);
+        long index = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+        if (index >= batch->count) break;
+
+        batchCompile(batch, &batch->files[index], symStack, &state);
+        compileSymStackReset(symStack);
+    }
+
+    freeSymTableStack(symStack);
+}
+
+static bool batchWriteSummary(Batch* batch, double seconds)
+{
+    size_t size = strlen(batch->outDir) + strlen(BATCH_SUMMARY) + 2;
+    char* path = malloc(size);
+    if (!path)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate batch output path", 0, NULL);
+    }
+    snprintf(path, size, "%s/%s", batch->outDir, BATCH_SUMMARY);
+    FILE* summary = fopen(path, "w");
+    free(path);
+    if (!summary) return false;
+
+    long failed = 0;
+    fprintf(summary, "# exit\tms\tsource\n");
+    for (long i = 0; i < batch->count; i++)
+    {
+        BatchFile* file = &batch->files[i];
+        fprintf(summary, "%d\t%.3f\t%s\n", file->code, file->seconds * 1e3, file->path);
+        if (file->code != 0) failed++;
+    }
+    fprintf(summary, "# %ld files, %ld failed, %.3f ms\n", batch->count, failed, seconds * 1e3);
+    return fclose(summary) == 0;
+}
+
+int batchRun(const char* input, const char* outDir)
+{
+    Batch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.outDir = outDir;
+
+    struct stat info;
+    bool listed = stat(input, &info) == 0 && S_ISDIR(info.st_mode)
+                      ? batchListDirectory(&batch, input)
+                      : batchListFile(&batch, input);
+    if (!listed)
+    {
+        errorExit(INTERNAL_ERROR, "Couldnt read batch input", 0, NULL);
+    }
+    batchCheckOutputs(&batch);
+    if (mkdir(outDir, 0777) != 0 && errno != EEXIST)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to create output directory", 0, NULL);
+    }
+
+    // Výběr skenovacích jader proběhne dřív, než ho začnou číst vlákna
+    scanKernelsGet();
+
+    int threads = threadPoolDefaultSize();
+    if (threads > batch.count) threads = batch.count > 0 ? (int)batch.count : 1;
+
+    double start = batchNow();
+    pthread_mutex_init(&batch.lock, NULL);
+    ThreadPool* pool = threadPoolCreate(threads);
+    for (int i = 0; i < threads; i++) threadPoolSubmit(pool, batchWorker, &batch);
+    threadPoolWait(pool);
+    threadPoolDestroy(pool);
+    pthread_mutex_destroy(&batch.lock);
+
+    bool written = batchWriteSummary(&batch, batchNow() - start);
+    for (long i = 0; i < batch.count; i++) free(batch.files[i].path);
+    free(batch.files);
+
+    if (!written)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to write batch summary", 0, NULL);
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file batch.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Compilation of many source files in one process
+ * @version 0.1
+ * @date 2025-12-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#define BATCH_SUMMARY "summary.txt"  // file in output directory with results of all sources
+
+/**
+ * @brief Compiles every source of input on thread pool
+ *
+ * Input is a directory (all its *.wren and *.txt files) or a list file with one source path
+ * per line. Code of source `dir/name.ext` is written to `outDir/name.ifjcode25` and its error
+ * messages to `outDir/name.err`, both are the same as stdout and stderr of
+ * `./compiler < dir/name.ext`. Two sources with the same name (from different directories
+ * of a list file, or differing only in extension) are rejected before anything is compiled.
+ * Summary lists exit code and compile time of every source in input order. Every worker reuses
+ * one symbol table stack (arena and builtins) for all its sources.
+ *
+ * @param input directory or list file
+ * @param outDir output directory, created when missing
+ * @return int 0 when all sources were processed (whatever their exit codes),
+ *         INTERNAL_ERROR when input or output directory cannot be used or outputs collide
+ */
+int batchRun(const char* input, const char* outDir);
+
+#endif  // BATCH_H
@@ -0,0 +1,639 @@
+/**
+ * @file compile_bench.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Benchmark of compiler phases on seeded synthetic IFJ25 programs
+ *
+ * Usage: ./compile_bench [--shape name] [--size kB] [--seed n] [--runs n]
+ *                        [--baseline file [--save]] [--generate]
+ * For every shape (expr, funcs, strings, nesting, accessors, mixed) generates valid program
+ * of given size, compiles it repeatedly and reports median and p95 time of every phase and
+ * throughput. With --baseline the medians are compared against the file, a missing file (or
+ * --save) is written instead. --generate only prints program of the shape to stdout.
+ * Programs are valid for the compiler, but their recursion and loops need not terminate, so
+ * they are not meant to be run.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../driver.h"
+#include "../scanner.h"
+#include "../stats.h"
+#include "../utils.h"
+
+#define DEFAULT_KILOBYTES 512
+#define DEFAULT_RUNS 15
+#define MAX_BASELINE 64
+
+typedef enum
+{
+    SHAPE_EXPR,       // hluboké výrazy se závorkami
+    SHAPE_FUNCS,      // mnoho malých funkcí, které se navzájem volají
+    SHAPE_STRINGS,    // dlouhé a víceřádkové řetězce
+    SHAPE_NESTING,    // vnořené if/else a while
+    SHAPE_ACCESSORS,  // gettery a settery nad globálními proměnnými
+    SHAPE_MIXED,      // všechno předchozí náhodně promíchané
+    SHAPE_COUNT
+} Shape;
+
+static const char *SHAPE_NAMES[SHAPE_COUNT] = {"expr",    "funcs",     "strings",
+                                               "nesting", "accessors", "mixed"};
+
+typedef enum
+{
+    BENCH_SCAN,  // samostatný průchod scannerem, neobsažen v total
+    BENCH_PARSE,
+    BENCH_SEMANTIC,
+    BENCH_BIND,
+    BENCH_INFER,
+    BENCH_GENERATE,
+    BENCH_TOTAL,
+    BENCH_PHASE_COUNT
+} BenchPhase;
+
+static const char *PHASE_NAMES[BENCH_PHASE_COUNT] = {"scan",  "parse",    "semantic", "bind",
+                                                     "infer", "generate", "total"};
+
+typedef struct
+{
+    char shape[16];
+    char phase[16];
+    double median;
+} BaselineEntry;
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Deterministický generátor, stejný seed dává stejný program
+static unsigned long long benchSeed;
+
+static unsigned benchRandom(unsigned limit)
+{
+    benchSeed = benchSeed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(benchSeed >> 33) % limit;
+}
+
+static const char *WORDS[] = {"lorem", "ipsum", "dolor", "sit",   "amet",  "value",
+                              "index", "scanner", "token", "result", "while", "return"};
+
+static void writeWords(FILE *out, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        fputs(WORDS[benchRandom(sizeof(WORDS) / sizeof(WORDS[0]))], out);
+        fputc(' ', out);
+    }
+}
+
+/* =========================================================================
+   PROGRAM GENERATOR
+   ========================================================================= */
+
+static void writeLeaf(FILE *out)
+{
+    switch (benchRandom(5))
+    {
+        case 0:
+            fputs("a", out);
+            break;
+        case 1:
+            fputs("b", out);
+            break;
+        case 2:
+            fprintf(out, "%u", benchRandom(1000));
+            break;
+        case 3:
+            fprintf(out, "%u.%u", benchRandom(100), benchRandom(100));
+            break;
+        default:
+            fprintf(out, "0x%X", benchRandom(4096));
+            break;
+    }
+}
+
+static void writeOperator(FILE *out)
+{
+    static const char *OPERATORS[] = {" + ", " - ", " * "};
+    fputs(OPERATORS[benchRandom(3)], out);
+}
+
+/**
+ * @brief Numeric expression over parameters a and b nested depth levels deep
+ */
+static void writeExpression(FILE *out, unsigned depth)
+{
+    if (depth == 0)
+    {
+        writeLeaf(out);
+        return;
+    }
+
+    switch (benchRandom(5))
+    {
+        case 0:
+            fputc('(', out);
+            writeExpression(out, depth - 1);
+            writeOperator(out);
+            writeLeaf(out);
+            fputc(')', out);
+            break;
+        case 1:
+            fputc('(', out);
+            writeLeaf(out);
+            writeOperator(out);
+            writeExpression(out, depth - 1);
+            fputc(')', out);
+            break;
+        case 2:
+            writeExpression(out, depth - 1);
+            writeOperator(out);
+            writeLeaf(out);
+            break;
+        case 3:
+            fputc('(', out);
+            writeExpression(out, depth - 1);
+            fprintf(out, " / %u)", 1 + benchRandom(9));
+            break;
+        default:
+            // Větvení do obou stran jen do malé hloubky, jinak výraz exponenciálně roste
+            fputc('(', out);
+            writeExpression(out, depth / 4);
+            writeOperator(out);
+            writeExpression(out, depth / 4);
+            fputc(')', out);
+            break;
+    }
+}
+
+static void writeExprFunction(FILE *out, FILE *calls, unsigned id)
+{
+    fprintf(out, "    static expr%u(a, b) {\n        var r\n        r = ", id);
+    writeExpression(out, 8 + benchRandom(24));
+    fputs("\n        if (r > a) {\n            r = r - b\n        } else {\n"
+          "            r = r + b\n        }\n        return r\n    }\n\n",
+          out);
+    fprintf(calls, "        r = expr%u(%u, %u)\n", id, benchRandom(100), benchRandom(100));
+}
+
+static unsigned funcArity(unsigned id)
+{
+    return id % 4;
+}
+
+static void writeArguments(FILE *out, unsigned count, unsigned available)
+{
+    static const char *PARAMS[] = {"x", "y", "z"};
+    for (unsigned i = 0; i < count; i++)
+    {
+        if (i > 0) fputs(", ", out);
+        if (available > 0 && benchRandom(2) == 0)
+            fputs(PARAMS[benchRandom(available)], out);
+        else
+            fprintf(out, "%u", benchRandom(100));
+    }
+}
+
+static void writeFuncsFunction(FILE *out, FILE *calls, unsigned id)
+{
+    static const char *PARAMS[] = {"x", "y", "z"};
+    unsigned arity = funcArity(id);
+
+    fprintf(out, "    static fun%u(", id);
+    for (unsigned i = 0; i < arity; i++)
+    {
+        fprintf(out, "%s%s", i > 0 ? ", " : "", PARAMS[i]);
+    }
+    fputs(") {\n        var t\n        t = 0\n", out);
+
+    // Volání dříve i později definovaných funkcí, dopředné volání smí být jen přiřazením
+    fputs("        var c\n", out);
+    for (unsigned call = benchRandom(4); call > 0; call--)
+    {
+        unsigned callee = benchRandom(id + 16);
+        fprintf(out, "        c = fun%u(", callee);
+        writeArguments(out, funcArity(callee), arity);
+        fputs(")\n        t = t + c\n", out);
+    }
+    fputs("        return t\n    }\n\n", out);
+
+    fprintf(calls, "        r = fun%u(", id);
+    writeArguments(calls, arity, 0);
+    fputs(")\n", calls);
+}
+
+static void writeStringsFunction(FILE *out, FILE *calls, unsigned id)
+{
+    fprintf(out, "    static text%u() {\n        var s\n        s = \"", id);
+    writeWords(out, 10 + benchRandom(40));
+    fputs("\\n\\t\\x41\"\n", out);
+
+    for (unsigned part = benchRandom(4); part > 0; part--)
+    {
+        fputs("        s = s + \"", out);
+        writeWords(out, 5 + benchRandom(20));
+        fputs("\"\n", out);
+    }
+
+    fputs("        var m\n        m = \"\"\"\n", out);
+    for (unsigned line = 1 + benchRandom(6); line > 0; line--)
+    {
+        fputs("            ", out);
+        writeWords(out, 8 + benchRandom(8));
+        fputs("\"quoted\"\n", out);
+    }
+    fputs("            \"\"\"\n        s = s + m\n        return s\n    }\n\n", out);
+    fprintf(calls, "        r = text%u()\n", id);
+}
+
+/**
+ * @brief Body of nest function, levels outside of loops also declare block local variable
+ *
+ * Declaration inside a loop would be executed repeatedly, so loop bodies only assign to
+ * variables declared at the start of function.
+ */
+static void writeNestedBlock(FILE *out, unsigned depth, unsigned indent, bool inLoop)
+{
+    if (depth == 0)
+    {
+        fprintf(out, "%*si = i + 1\n", indent, "");
+        return;
+    }
+
+    fprintf(out, "%*sv%u = i\n", indent, "", depth);
+    if (!inLoop)
+    {
+        fprintf(out, "%*svar w%u\n%*sw%u = v%u + 1\n", indent, "", depth, indent, "", depth,
+                depth);
+    }
+
+    if (benchRandom(2) == 0)
+    {
+        fprintf(out, "%*sif (v%u < n) {\n", indent, "", depth);
+        writeNestedBlock(out, depth - 1, indent + 4, inLoop);
+        fprintf(out, "%*s} else {\n%*si = i - 1\n%*s}\n", indent, "", indent + 4, "", indent,
+                "");
+    }
+    else
+    {
+        fprintf(out, "%*swhile (i < n) {\n", indent, "");
+        writeNestedBlock(out, depth - 1, indent + 4, true);
+        fprintf(out, "%*si = i + %u\n%*s}\n", indent + 4, "", 1 + benchRandom(3), indent, "");
+    }
+}
+
+static void writeNestingFunction(FILE *out, FILE *calls, unsigned id)
+{
+    unsigned depth = 4 + benchRandom(12);
+    fprintf(out, "    static nest%u(n) {\n        var i\n        i = 0\n", id);
+    for (unsigned level = 1; level <= depth; level++)
+    {
+        fprintf(out, "        var v%u\n", level);
+    }
+    writeNestedBlock(out, depth, 8, false);
+    fputs("        return i\n    }\n\n", out);
+    fprintf(calls, "        r = nest%u(%u)\n", id, benchRandom(10));
+}
+
+static void writeAccessorsFunction(FILE *out, FILE *calls, unsigned id)
+{
+    fprintf(out,
+            "    static prop%u {\n        return __p%u\n    }\n\n"
+            "    static prop%u=(v) {\n        __p%u = v\n    }\n\n"
+            "    static use%u(x) {\n        prop%u = x\n        var y\n"
+            "        y = prop%u\n        prop%u = y\n        return y\n    }\n\n",
+            id, id, id, id, id, id, id, id);
+    fprintf(calls, "        r = use%u(%u)\n", id, benchRandom(100));
+}
+
+/**
+ * @brief Write valid IFJ25 program of given shape with at least size bytes
+ */
+static void generateProgram(FILE *out, Shape shape, size_t size, unsigned long long seed)
+{
+    typedef void (*UnitWriter)(FILE *, FILE *, unsigned);
+    static const UnitWriter WRITERS[SHAPE_MIXED] = {writeExprFunction, writeFuncsFunction,
+                                                    writeStringsFunction, writeNestingFunction,
+                                                    writeAccessorsFunction};
+
+    benchSeed = seed;
+    char *callsText = NULL;
+    size_t callsLength = 0;
+    FILE *calls = open_memstream(&callsText, &callsLength);
+    if (!calls)
+    {
+        perror("open_memstream");
+        exit(1);
+    }
+
+    fputs("import \"ifj25\" for Ifj\n\nclass Program {\n", out);
+    long start = ftell(out);
+    unsigned count[SHAPE_MIXED] = {0};
+    while ((size_t)(ftell(out) - start) < size)
+    {
+        Shape unit = shape == SHAPE_MIXED ? (Shape)benchRandom(SHAPE_MIXED) : shape;
+        WRITERS[unit](out, calls, count[unit]++);
+    }
+    // Funkce funN volají až fun(N + 15), chybějící se doplní jako prázdné
+    if (count[SHAPE_FUNCS] > 0)
+    {
+        for (unsigned id = count[SHAPE_FUNCS]; id < count[SHAPE_FUNCS] + 16; id++)
+        {
+            fprintf(out, "    static fun%u(", id);
+            for (unsigned i = 0; i < funcArity(id); i++)
+            {
+                fprintf(out, "%sp%u", i > 0 ? ", " : "", i);
+            }
+            fputs(") {\n        return 1\n    }\n\n", out);
+        }
+    }
+
+    fclose(calls);
+    fputs("    static main() {\n        var r\n", out);
+    fwrite(callsText, 1, callsLength, out);
+    fputs("        Ifj.write(r)\n    }\n}\n", out);
+    free(callsText);
+}
+
+/* =========================================================================
+   MEASUREMENT
+   ========================================================================= */
+
+/**
+ * @brief Tokenize whole source, returns number of tokens
+ */
+static size_t scanAll(FILE *source)
+{
+    rewind(source);
+    Scanner scanner;
+    initScanner(&scanner, source);
+    if (readPrologue(&scanner) != 0)
+    {
+        fprintf(stderr, "generated program has invalid prologue\n");
+        exit(1);
+    }
+
+    size_t tokens = 0;
+    Token token;
+    while (getNextToken(&scanner, &token) == 0 && token.type != EOF_TOKEN)
+    {
+        tokens++;
+        freeToken(&token);
+    }
+    if (token.type != EOF_TOKEN)
+    {
+        fprintf(stderr, "lexical error on line %d\n", scannerLine(&scanner));
+        exit(1);
+    }
+    freeToken(&token);
+    disposeScanner(&scanner);
+    return tokens;
+}
+
+/**
+ * @brief Compiles source with compileProgram, times of phases are read from statistics
+ *
+ * Errors in generated program end the process through errorExit with its message.
+ */
+static void compileTimed(FILE *source, SymTableStack *symStack, double seconds[])
+{
+    rewind(source);
+    compileSymStackReset(symStack);
+
+    uint64_t phases[PHASE_COUNT];
+    statsTakePhases(phases);  // Časy mimo compileProgram se nezapočítají
+    compileProgram(source, symStack, NULL);
+    statsTakePhases(phases);
+
+    // Čtení zdroje a prológ patří k parseru, kontrola deklarací k sémantice
+    seconds[BENCH_PARSE] =
+        (phases[PHASE_READ] + phases[PHASE_PROLOGUE] + phases[PHASE_PARSE]) / 1e9;
+    seconds[BENCH_SEMANTIC] = (phases[PHASE_SEMANTIC] + phases[PHASE_FUN_DEC]) / 1e9;
+    seconds[BENCH_BIND] = phases[PHASE_BIND] / 1e9;
+    seconds[BENCH_INFER] = phases[PHASE_INFER] / 1e9;
+    seconds[BENCH_GENERATE] = phases[PHASE_GENERATE] / 1e9;
+
+    seconds[BENCH_TOTAL] = seconds[BENCH_PARSE] + seconds[BENCH_SEMANTIC] +
+                           seconds[BENCH_BIND] + seconds[BENCH_INFER] +
+                           seconds[BENCH_GENERATE];
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Sorts samples and returns value at given percentile (nearest rank)
+ */
+static double percentile(double *samples, int count, int percent)
+{
+    qsort(samples, count, sizeof(double), compareDoubles);
+    int rank = (count * percent + 99) / 100;
+    return samples[rank > 0 ? rank - 1 : 0];
+}
+
+/* =========================================================================
+   BASELINE
+   ========================================================================= */
+
+static int loadBaseline(const char *path, BaselineEntry entries[])
+{
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+
+    int count = 0;
+    double p95;
+    while (count < MAX_BASELINE && fscanf(file, "%15s %15s %lf %lf", entries[count].shape,
+                                          entries[count].phase, &entries[count].median,
+                                          &p95) == 4)
+    {
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+static const BaselineEntry *findBaseline(const BaselineEntry entries[], int count,
+                                         const char *shape, const char *phase)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(entries[i].shape, shape) == 0 && strcmp(entries[i].phase, phase) == 0)
+        {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+/* =========================================================================
+   MAIN
+   ========================================================================= */
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: compile_bench [--shape name] [--size kB] [--seed n] [--runs n]\n"
+                    "                     [--baseline file [--save]] [--generate]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int onlyShape = -1;
+    size_t kilobytes = DEFAULT_KILOBYTES;
+    unsigned long long seed = 1;
+    int runs = DEFAULT_RUNS;
+    const char *baselinePath = NULL;
+    bool save = false;
+    bool generateOnly = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--shape") == 0 && hasValue)
+        {
+            const char *name = argv[++i];
+            for (int shape = 0; shape < SHAPE_COUNT; shape++)
+            {
+                if (strcmp(name, SHAPE_NAMES[shape]) == 0) onlyShape = shape;
+            }
+            if (onlyShape < 0) usage();
+        }
+        else if (strcmp(argv[i], "--size") == 0 && hasValue)
+            kilobytes = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue)
+            runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--baseline") == 0 && hasValue)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--save") == 0)
+            save = true;
+        else if (strcmp(argv[i], "--generate") == 0)
+            generateOnly = true;
+        else
+            usage();
+    }
+    if (kilobytes == 0 || runs <= 0) usage();
+
+    if (generateOnly)
+    {
+        generateProgram(stdout, onlyShape < 0 ? SHAPE_MIXED : (Shape)onlyShape,
+                        kilobytes << 10, seed);
+        return 0;
+    }
+
+    BaselineEntry baseline[MAX_BASELINE];
+    int baselineCount = -1;
+    if (baselinePath && !save) baselineCount = loadBaseline(baselinePath, baseline);
+    FILE *baselineOut = NULL;
+    if (baselinePath && baselineCount < 0)
+    {
+        baselineOut = fopen(baselinePath, "w");
+        if (!baselineOut)
+        {
+            perror(baselinePath);
+            return 1;
+        }
+    }
+
+    // Vygenerovaný kód se zahazuje, měří se jen jeho tvorba
+    FILE *sink = fopen("/dev/null", "w");
+    double *samples = malloc(sizeof(double) * BENCH_PHASE_COUNT * runs);
+    double *values = malloc(sizeof(double) * runs);
+    if (!sink || !samples || !values)
+    {
+        perror("compile_bench");
+        return 1;
+    }
+    emitSetOutput(sink);
+    statsCollect();
+    SymTableStack *symStack = compileSymStackCreate();
+
+    for (int shape = 0; shape < SHAPE_COUNT; shape++)
+    {
+        if (onlyShape >= 0 && shape != onlyShape) continue;
+
+        FILE *source = tmpfile();
+        if (!source)
+        {
+            perror("tmpfile");
+            return 1;
+        }
+        generateProgram(source, (Shape)shape, kilobytes << 10, seed);
+        double megabytes = (double)ftell(source) / (1 << 20);
+
+        size_t tokens = 0;
+        for (int run = 0; run < runs; run++)
+        {
+            double *seconds = &samples[run * BENCH_PHASE_COUNT];
+            double start = nowSeconds();
+            tokens = scanAll(source);
+            seconds[BENCH_SCAN] = nowSeconds() - start;
+            compileTimed(source, symStack, seconds);
+        }
+        fclose(source);
+
+        printf("%s: %.2f MB, %zu tokens, %d runs\n", SHAPE_NAMES[shape], megabytes, tokens,
+               runs);
+        printf("  %-9s %10s %10s %10s\n", "phase", "median ms", "p95 ms", "baseline");
+
+        double totalMedian = 0.0;
+        double scanMedian = 0.0;
+        for (int phase = 0; phase < BENCH_PHASE_COUNT; phase++)
+        {
+            for (int run = 0; run < runs; run++)
+            {
+                values[run] = samples[run * BENCH_PHASE_COUNT + phase] * 1000.0;
+            }
+            double median = percentile(values, runs, 50);
+            double p95 = percentile(values, runs, 95);
+            if (phase == BENCH_TOTAL) totalMedian = median;
+            if (phase == BENCH_SCAN) scanMedian = median;
+
+            printf("  %-9s %10.3f %10.3f", PHASE_NAMES[phase], median, p95);
+            const BaselineEntry *entry =
+                baselineCount > 0 ? findBaseline(baseline, baselineCount, SHAPE_NAMES[shape],
+                                                 PHASE_NAMES[phase])
+                                  : NULL;
+            if (entry && entry->median > 0.0)
+            {
+                printf(" %+9.1f%%", (median / entry->median - 1.0) * 100.0);
+            }
+            putchar('\n');
+
+            if (baselineOut)
+            {
+                fprintf(baselineOut, "%s %s %.6f %.6f\n", SHAPE_NAMES[shape],
+                        PHASE_NAMES[phase], median, p95);
+            }
+        }
+
+        printf("  throughput: scan %.1f MB/s %.2f Mtok/s, compile %.1f MB/s %.2f Mtok/s\n",
+               megabytes / (scanMedian / 1000.0), tokens / (scanMedian * 1000.0),
+               megabytes / (totalMedian / 1000.0), tokens / (totalMedian * 1000.0));
+    }
+
+    if (baselineOut)
+    {
+        fclose(baselineOut);
+        printf("baseline written to %s\n", baselinePath);
+    }
+    freeSymTableStack(symStack);
+    emitSetOutput(NULL);
+    fclose(sink);
+    free(samples);
+    free(values);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file keyword_bench.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Microbenchmark of keyword recognition (perfect hash vs. linear strcmp scan)
+ *
+ * Usage: ./keyword_bench file...
+ * Checks that every keyword is in the hash table, collects every identifier-like word from
+ * given sources, checks that both lookups agree and reports time per lookup.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../scanner.h"
+
+#define BENCH_ROUNDS 200
+
+/**
+ * @brief All keywords, reference for linear lookup and for check of the hash table
+ */
+static const struct
+{
+    const char *keyword;
+    TokenType type;
+} KEYWORDS[] = {{"class", KW_CLASS},    {"if", KW_IF},
+                {"else", KW_ELSE},      {"is", KW_IS},
+                {"null", KW_VAL_NULL},  {"return", KW_RETURN},
+                {"var", KW_VAR},        {"while", KW_WHILE},
+                {"Ifj", KW_IFJ},        {"static", KW_STATIC},
+                {"import", KW_IMPORT},  {"for", KW_FOR},
+                {"Num", KW_TYPE_NUM},   {"String", KW_TYPE_STRING},
+                {"Null", KW_TYPE_NULL}, {"Bool", KW_TYPE_BOOL},
+                {"true", KW_VAL_TRUE},  {"false", KW_VAL_FALSE},
+                {NULL, IDENTIFIER}};
+
+/**
+ * @brief Original linear keyword lookup kept as reference
+ */
+static TokenType identifyKeywordLinear(const char *string)
+{
+    for (int i = 0; KEYWORDS[i].keyword != NULL; i++)
+    {
+        if (strcmp(string, KEYWORDS[i].keyword) == 0)
+        {
+            return KEYWORDS[i].type;
+        }
+    }
+    return IDENTIFIER;
+}
+
+/**
+ * @brief Checks that every keyword is found in the compile-time hash table
+ * @return Number of keywords missing from the table (wrong slot chars or collision)
+ */
+static int checkKeywordTable(void)
+{
+    int missing = 0;
+    for (int i = 0; KEYWORDS[i].keyword != NULL; i++)
+    {
+        if (identifyKeyword(KEYWORDS[i].keyword) != KEYWORDS[i].type)
+        {
+            fprintf(stderr, "keyword_bench: keyword '%s' not in hash table\n",
+                    KEYWORDS[i].keyword);
+            missing++;
+        }
+    }
+    return missing;
+}
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Appends all identifier-like words of file into words array
+ */
+static void collectWords(const char *path, char ***words, size_t *count, size_t *capacity)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "keyword_bench: cannot open %s\n", path);
+        exit(1);
+    }
+
+    char word[256];
+    size_t len = 0;
+    int c;
+    do
+    {
+        c = fgetc(file);
+        if (c != EOF && (isalnum(c) || c == '_') && len < sizeof(word) - 1)
+        {
+            word[len++] = (char)c;
+            continue;
+        }
+        if (len > 0 && !isdigit((unsigned char)word[0]))
+        {
+            if (*count == *capacity)
+            {
+                *capacity = *capacity ? *capacity * 2 : 1024;
+                *words = realloc(*words, *capacity * sizeof(char *));
+                if (!*words) exit(1);
+            }
+            word[len] = '\0';
+            (*words)[(*count)++] = strdup(word);
+        }
+        len = 0;
+    } while (c != EOF);
+
+    fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+    if (checkKeywordTable() != 0) return 1;
+
+    char **words = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    for (int i = 1; i < argc; i++) collectWords(argv[i], &words, &count, &capacity);
+
+    if (count == 0)
+    {
+        fprintf(stderr, "keyword_bench: no words collected\n");
+        return 1;
+    }
+
+    size_t keywords = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        TokenType expected = identifyKeywordLinear(words[i]);
+        if (identifyKeyword(words[i]) != expected)
+        {
+            fprintf(stderr, "keyword_bench: mismatch for '%s'\n", words[i]);
+            return 1;
+        }
+        if (expected != IDENTIFIER) keywords++;
+    }
+
+    volatile unsigned sink = 0;
+    double start = nowSeconds();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (size_t i = 0; i < count; i++) sink += identifyKeywordLinear(words[i]);
+    double linear = nowSeconds() - start;
+
+    start = nowSeconds();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (size_t i = 0; i < count; i++) sink += identifyKeyword(words[i]);
+    double hashed = nowSeconds() - start;
+
+    double lookups = (double)count * BENCH_ROUNDS;
+    printf("words: %zu (%zu keywords), %d rounds\n", count, keywords, BENCH_ROUNDS);
+    printf("linear strcmp: %7.2f ns/lookup\n", linear / lookups * 1e9);
+    printf("perfect hash:  %7.2f ns/lookup (%.1fx)\n", hashed / lookups * 1e9, linear / hashed);
+
+    for (size_t i = 0; i < count; i++) free(words[i]);
+    free(words);
+    return 0;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file scan_bench.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Benchmark of scanner skip kernels (scalar vs. SSE2 vs. AVX2) on synthetic source
+ *
+ * Usage: ./scan_bench [megabytes]
+ * Generates source (default 100 MB) dominated by indentation, comments and long string
+ * literals, tokenizes it with every kernel level supported by CPU, checks that all token
+ * streams agree and reports throughput.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../scanner.h"
+
+#define DEFAULT_MEGABYTES 100
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Deterministický generátor, aby všechny běhy měřily stejný vstup
+static unsigned long long benchSeed = 0x2545F4914F6CDD1DULL;
+
+static unsigned benchRandom(unsigned limit)
+{
+    benchSeed = benchSeed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned)(benchSeed >> 33) % limit;
+}
+
+static const char *WORDS[] = {"lorem", "ipsum", "dolor", "sit",   "amet",  "value",
+                              "index", "scanner", "token", "result", "while", "return"};
+
+static void writeWords(FILE *out, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        fputs(WORDS[benchRandom(sizeof(WORDS) / sizeof(WORDS[0]))], out);
+        fputc(' ', out);
+    }
+}
+
+/**
+ * @brief Write synthetic IFJ25 source of at least size bytes
+ */
+static void generateSource(FILE *out, size_t size)
+{
+    fputs("import \"ifj25\" for Ifj\nclass Program {\n    static main() {\n", out);
+
+    while ((size_t)ftell(out) < size)
+    {
+        unsigned indent = 4 + 4 * benchRandom(4);
+        fprintf(out, "%*s", indent, "");
+
+        switch (benchRandom(4))
+        {
+            case 0:
+                fprintf(out, "var x%u = %u + x // ", benchRandom(100), benchRandom(1000));
+                writeWords(out, 6 + benchRandom(10));
+                fputc('\n', out);
+                break;
+            case 1:
+                fputs("/* ", out);
+                for (unsigned line = benchRandom(4); line > 0; line--)
+                {
+                    writeWords(out, 8);
+                    fprintf(out, "\n%*s * ", indent, "");
+                }
+                writeWords(out, 4);
+                fputs("*/\n", out);
+                break;
+            case 2:
+                fputs("s = \"", out);
+                writeWords(out, 10 + benchRandom(20));
+                fputs("\\n\\t\\x41\"\n", out);
+                break;
+            default:
+                fputs("m = \"\"\"\n", out);
+                for (unsigned line = 1 + benchRandom(6); line > 0; line--)
+                {
+                    fprintf(out, "%*s", indent + 4, "");
+                    writeWords(out, 8 + benchRandom(8));
+                    fputs("\"quoted\"\n", out);
+                }
+                fprintf(out, "%*s\"\"\"\n", indent, "");
+                break;
+        }
+    }
+
+    fputs("    }\n}\n", out);
+}
+
+typedef struct
+{
+    size_t tokens;
+    unsigned long long checksum;
+    double seconds;
+} ScanResult;
+
+/**
+ * @brief Tokenize whole source with given kernels, reading of file is not measured
+ */
+static int scanAll(FILE *source, const ScanKernels *kernels, ScanResult *result)
+{
+    rewind(source);
+    Scanner scanner;
+    initScanner(&scanner, source);
+    scanner.kernels = kernels;
+
+    result->tokens = 0;
+    result->checksum = 0;
+
+    Token token;
+    double start = nowSeconds();
+    while (true)
+    {
+        if (getNextToken(&scanner, &token) != 0)
+        {
+            fprintf(stderr, "lexical error on line %d\n", scannerLine(&scanner));
+            freeToken(&token);
+            disposeScanner(&scanner);
+            return 1;
+        }
+        if (token.type == EOF_TOKEN) break;
+
+        result->tokens++;
+        result->checksum =
+            result->checksum * 31 + (unsigned long long)token.type * 7 + token.offset;
+        if (token.value && token.value->stringVal)
+        {
+            result->checksum += strlen(token.value->stringVal);
+        }
+        freeToken(&token);
+    }
+    result->seconds = nowSeconds() - start;
+
+    freeToken(&token);
+    disposeScanner(&scanner);
+    return 0;
+}
+
+/**
+ * @brief Walk whole buffer with findCommentStop only, measures kernel without the scanner
+ */
+static double kernelOnly(const Scanner *scanner, const ScanKernels *kernels, size_t *stops)
+{
+    const char *pos = scanner->buffer;
+    const char *end = scanner->buffer + scanner->length;
+
+    *stops = 0;
+    double start = nowSeconds();
+    while ((pos = kernels->findCommentStop(pos, end)) < end)
+    {
+        (*stops)++;
+        pos++;
+    }
+    return nowSeconds() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MEGABYTES;
+    if (megabytes == 0) megabytes = DEFAULT_MEGABYTES;
+
+    FILE *source = tmpfile();
+    if (!source)
+    {
+        perror("tmpfile");
+        return 1;
+    }
+    generateSource(source, megabytes << 20);
+    double size = (double)ftell(source) / (1 << 20);
+    printf("source: %.1f MB\n", size);
+
+    ScanResult reference = {0, 0, 0.0};
+    bool haveReference = false;
+    int status = 0;
+
+    for (int level = SCAN_KERNEL_SCALAR; level < SCAN_KERNEL_COUNT; level++)
+    {
+        const ScanKernels *kernels = scanKernelsForLevel((ScanKernelLevel)level);
+        if (!kernels)
+        {
+            continue;
+        }
+
+        ScanResult result;
+        if (scanAll(source, kernels, &result) != 0)
+        {
+            status = 1;
+            break;
+        }
+
+        if (!haveReference)
+        {
+            reference = result;
+            haveReference = true;
+        }
+        else if (result.tokens != reference.tokens || result.checksum != reference.checksum)
+        {
+            fprintf(stderr, "MISMATCH: %s kernels produced different token stream\n",
+                    kernels->name);
+            status = 1;
+        }
+
+        printf("%-7s %zu tokens  %7.3f s  %8.1f MB/s  %.2fx\n", kernels->name, result.tokens,
+               result.seconds, size / result.seconds, reference.seconds / result.seconds);
+    }
+
+    // Samotný kernel nad celým bufferem, bez alokací tokenů
+    rewind(source);
+    Scanner scanner;
+    initScanner(&scanner, source);
+    for (int level = SCAN_KERNEL_SCALAR; level < SCAN_KERNEL_COUNT; level++)
+    {
+        const ScanKernels *kernels = scanKernelsForLevel((ScanKernelLevel)level);
+        if (!kernels)
+        {
+            continue;
+        }
+
+        size_t stops;
+        double seconds = kernelOnly(&scanner, kernels, &stops);
+        printf("%-7s findCommentStop only: %zu stops  %7.3f s  %8.1f MB/s\n", kernels->name,
+               stops, seconds, size / seconds);
+    }
+    disposeScanner(&scanner);
+
+    fclose(source);
+    return status;
+}
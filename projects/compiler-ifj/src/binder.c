@@ -0,0 +1,237 @@
+/**
+ * @file binder.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Binding pass resolving storage of identifiers before code generation
+ * @version 0.1
+ * @date 2025-11-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "binder.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief State of binding pass
+ *
+ */
+typedef struct
+{
+    Arena* arena;  // arena of symtable, frame names live there
+    Scope* scope;  // innermost frozen scope, resolves identifiers without link
+    Scope* seen;   // locals of current function by name, detects shadowing
+    int slotCount;   // number of locals in current function frame
+    int frameDepth;  // same meaning as CodeGenerator frameDepth, 1 inside function
+} Binder;
+
+static void bindNode(Binder* binder, AstNode* node);
+
+/**
+ * @brief printf into memory of arena
+ *
+ * @param arena - arena to allocate from
+ * @param fmt - format string
+ * @return char* - formatted string
+ */
+static char* bindFormat(Arena* arena, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+
+    char* str = arenaAlloc(arena, len + 1);
+    vsnprintf(str, len + 1, fmt, args);
+    va_end(args);
+    return str;
+}
+
+/**
+ * @brief Gives local variable or parameter next slot of function frame
+ *
+ * Shadowing declaration of already used name gets slot appended to stay unique in frame.
+ *
+ * @param binder - binding state
+ * @param symbol - local symbol
+ */
+static void bindLocal(Binder* binder, Symbol* symbol)
+{
+    if (symbol->storage != STORAGE_UNBOUND) return;
+
+    symbol->storage = STORAGE_LOCAL;
+    symbol->slot = binder->slotCount++;
+
+    if (scopeFindSymbol(binder->seen, symbol->name))
+    {
+        symbol->frameName = bindFormat(binder->arena, "%s$%d$%d", symbol->name,
+                                       binder->frameDepth, symbol->slot);
+    }
+    else
+    {
+        symbol->frameName = bindFormat(binder->arena, "%s$%d", symbol->name, binder->frameDepth);
+        scopeAddSymbol(binder->seen, symbol);
+    }
+}
+
+/**
+ * @brief Binds globals, functions, getters and setters from global scope
+ *
+ * @param binder - binding state
+ * @param global - global scope
+ */
+static void bindGlobalScope(Binder* binder, Scope* global)
+{
+    for (int i = 0; i < global->size; i++)
+    {
+        Symbol* symbol = global->symbols[i];
+        if (!symbol || symbol == TOMBSTONE) continue;
+
+        // Unikátní jméno getteru/setteru končí "#get"/"#set"
+        int baseLen = (int)strlen(symbol->name) - 4;
+        switch (symbol->kind)
+        {
+            case SYM_VAR:
+                symbol->storage = STORAGE_GLOBAL;
+                symbol->frameName = symbol->name;
+                break;
+            case SYM_GET:
+                symbol->storage = STORAGE_GETTER;
+                symbol->frameName = bindFormat(binder->arena, "%.*s_get", baseLen, symbol->name);
+                break;
+            case SYM_SET:
+                symbol->storage = STORAGE_SETTER;
+                symbol->frameName = bindFormat(binder->arena, "%.*s_set", baseLen, symbol->name);
+                break;
+            case SYM_FUNC:
+                symbol->storage = STORAGE_FUNC;
+                symbol->frameName = symbol->name;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Binds parameters and body of function, getter or setter in fresh frame
+ *
+ * @param binder - binding state
+ * @param node - AST_FUN_DEC, AST_FUN_GET or AST_FUN_SET
+ */
+static void bindFunction(Binder* binder, AstNode* node)
+{
+    Binder saved = *binder;
+
+    binder->seen = scopeCreate(binder->arena, INITIAL_CAPACITY_SCOPE);
+    binder->slotCount = 0;
+    binder->frameDepth++;
+    if (node->scope) binder->scope = node->scope;
+
+    AstBin* children = node->children;
+    if (children->left)
+    {
+        // Parametry dostanou první sloty v pořadí deklarace
+        NodeVec* params = &((AstN*)children->left->children)->nodes;
+        for (long i = 0; i < params->count; i++)
+        {
+            if (params->items[i]->symbol) bindLocal(binder, params->items[i]->symbol);
+        }
+    }
+    bindNode(binder, children->right);
+
+    *binder = saved;
+}
+
+/**
+ * @brief Walks AST and binds declarations and identifiers
+ *
+ * @param binder - binding state
+ * @param node - node to bind
+ */
+static void bindNode(Binder* binder, AstNode* node)
+{
+    if (!node) return;
+
+    switch (node->type)
+    {
+        case AST_FUN_DEC:
+        case AST_FUN_GET:
+        case AST_FUN_SET:
+            bindFunction(binder, node);
+            return;
+
+        case AST_VAR_DEC:
+            if (node->symbol && binder->frameDepth > 0) bindLocal(binder, node->symbol);
+            return;
+
+        case AST_IDENTIFIER:
+            // Identifikátor bez vazby dohledáme ve snapshotu scope
+            if (!node->symbol && binder->scope)
+                node->symbol = scopeChainFindSymbol(binder->scope, node->token.value->stringVal);
+            if (node->symbol && binder->frameDepth > 0 &&
+                (node->symbol->kind == SYM_VAR || node->symbol->kind == SYM_PARAM))
+                bindLocal(binder, node->symbol);
+            return;
+
+        case AST_LITERAL:
+        case AST_TYPE:
+            return;
+
+        case AST_CLASS_DEC:
+        case AST_BLOCK:
+        case AST_PARAMS:
+        {
+            Scope* outer = binder->scope;
+            if (node->scope) binder->scope = node->scope;
+
+            NodeVec* nodes = &((AstN*)node->children)->nodes;
+            for (long i = 0; i < nodes->count; i++) bindNode(binder, nodes->items[i]);
+
+            binder->scope = outer;
+            return;
+        }
+
+        case AST_EXPRESSION:
+        {
+            // Sloty se přidělují zleva doprava, levá větev řetězce operátorů se prochází cyklem
+            NodeVec spine;
+            nodeVecInit(&spine);
+            astLeftSpine(node, &spine);
+            bindNode(binder, ((AstBin*)spine.items[spine.count - 1]->children)->left);
+            for (long i = spine.count - 1; i >= 0; i--)
+                bindNode(binder, ((AstBin*)spine.items[i]->children)->right);
+            nodeVecDispose(&spine);
+            return;
+        }
+
+        default:
+        {
+            AstBin* children = node->children;
+            if (!children) return;
+            bindNode(binder, children->left);
+            bindNode(binder, children->right);
+            return;
+        }
+    }
+}
+
+void bindProgram(AstNode* root, SymTableStack* stack)
+{
+    if (!root || !stack || stack->top < 0) return;
+
+    Binder binder;
+    binder.arena = &stack->arena;
+    binder.scope = stack->scopes[0];
+    binder.seen = NULL;
+    binder.slotCount = 0;
+    binder.frameDepth = 0;
+
+    bindGlobalScope(&binder, stack->scopes[0]);
+    bindNode(&binder, root);
+}
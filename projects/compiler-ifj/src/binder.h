@@ -0,0 +1,29 @@
+/**
+ * @file binder.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Binding pass resolving storage of identifiers before code generation
+ * @version 0.1
+ * @date 2025-11-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef BINDER_H
+#define BINDER_H
+
+#include "parser.h"
+#include "symtable.h"
+
+/**
+ * @brief Assigns storage class, frame slot and unique frame name to every symbol used in AST
+ *
+ * Runs after semantic analysis. Codegen then reads operands from node->symbol and does
+ * no symtable lookup.
+ *
+ * @param root - AST_CLASS_DEC root of program
+ * @param stack - symtable stack with global scope at index 0, names are allocated in its arena
+ */
+void bindProgram(AstNode* root, SymTableStack* stack);
+
+#endif  // BINDER_H
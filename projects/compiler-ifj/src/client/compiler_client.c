@@ -0,0 +1,156 @@
+/**
+ * @file compiler_client.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Drop-in replacement of compiler binary forwarding compilation to `compiler --serve`
+ *
+ * Usage: IFJ_COMPILER_SOCKET=path ./compiler-client [--test-codegen file] < source
+ * Sends source to daemon and reproduces its stdout, stderr and exit code, so test scripts
+ * can use the client as PROJECT_BIN while one warm daemon does the work.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../error.h"
+#include "../serve.h"
+
+static int clientFail(const char *msg)
+{
+    fprintf(stderr, "compiler-client: %s\n", msg);
+    return INTERNAL_ERROR;
+}
+
+static int readAll(int fd, void *data, size_t length)
+{
+    char *pos = data;
+    while (length > 0)
+    {
+        ssize_t got = read(fd, pos, length);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return 0;
+        pos += got;
+        length -= (size_t)got;
+    }
+    return 1;
+}
+
+static int writeAll(int fd, const void *data, size_t length)
+{
+    const char *pos = data;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, pos, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return 0;
+        pos += written;
+        length -= (size_t)written;
+    }
+    return 1;
+}
+
+static uint32_t decode(const unsigned char *bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 |
+           (uint32_t)bytes[3];
+}
+
+/**
+ * @brief Reads whole stream into memory
+ */
+static char *readSource(FILE *input, size_t *length)
+{
+    size_t capacity = 65536;
+    char *data = malloc(capacity);
+    *length = 0;
+    while (data)
+    {
+        *length += fread(data + *length, 1, capacity - *length, input);
+        if (*length < capacity) break;
+        capacity *= 2;
+        char *grown = realloc(data, capacity);
+        if (!grown) free(data);
+        data = grown;
+    }
+    return data;
+}
+
+/**
+ * @brief Forwards count bytes of response to fd
+ */
+static int forward(int conn, int fd, uint32_t count)
+{
+    char buffer[65536];
+    while (count > 0)
+    {
+        size_t chunk = count < sizeof(buffer) ? count : sizeof(buffer);
+        if (!readAll(conn, buffer, chunk) || !writeAll(fd, buffer, chunk)) return 0;
+        count -= (uint32_t)chunk;
+    }
+    return 1;
+}
+
+int main(int argc, char const *argv[])
+{
+    FILE *input = stdin;
+    if (argc == 3 && strcmp(argv[1], "--test-codegen") == 0)
+    {
+        input = fopen(argv[2], "r");
+        if (!input) return clientFail("cannot open source file");
+    }
+    else if (argc != 1)
+    {
+        return clientFail("unknown option");
+    }
+
+    const char *socketPath = getenv(SERVE_SOCKET_ENV);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (!socketPath || strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        return clientFail("set " SERVE_SOCKET_ENV " to socket of `compiler --serve`");
+    }
+    strcpy(address.sun_path, socketPath);
+
+    size_t length;
+    char *source = readSource(input, &length);
+    if (input != stdin) fclose(input);
+    if (!source || length > UINT32_MAX) return clientFail("cannot read source");
+
+    int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conn < 0 || connect(conn, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        free(source);
+        return clientFail("cannot connect to compiler daemon");
+    }
+
+    unsigned char header[SERVE_RESPONSE_HEADER];
+    header[0] = (unsigned char)(length >> 24);
+    header[1] = (unsigned char)(length >> 16);
+    header[2] = (unsigned char)(length >> 8);
+    header[3] = (unsigned char)length;
+    // Démon může odpovědět dřív, než přečte celý zdroj (nepodařený fork), odpověď se čte vždy
+    signal(SIGPIPE, SIG_IGN);
+    if (writeAll(conn, header, SERVE_REQUEST_HEADER)) writeAll(conn, source, length);
+    free(source);
+
+    if (!readAll(conn, header, SERVE_RESPONSE_HEADER) ||
+        !forward(conn, STDOUT_FILENO, decode(header + 4)) ||
+        !forward(conn, STDERR_FILENO, decode(header + 8)))
+    {
+        close(conn);
+        return clientFail("compiler daemon did not answer");
+    }
+
+    close(conn);
+    return (int)decode(header);
+}
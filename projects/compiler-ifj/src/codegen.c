@@ -12,10 +12,14 @@
 
 #include "codegen.h"
 
+#include <setjmp.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "error.h"
+#include "stats.h"
+#include "threadpool.h"
 #include "utils.h"
 
 /**
@@ -28,30 +32,32 @@ void codeGeneratorInit(CodeGenerator *codeGen, SymTableStack *symStack)
     codeGen->inFunction = false;
     codeGen->labelCounter = 0;
     codeGen->tempVarCounter = 0;
+    codeGen->labelScope = NULL;
+    codeGen->cache = NULL;
 }
 
 /**
  * @brief Generate unique label
- * E.g. Base = "if" -> "if_0", "if_1"...
+ * E.g. Base = "if" -> "if_0", "if_1"... Inside function the label is prefixed by its name,
+ * "$main$0$if_0", so code of every function stays the same regardless of the others.
  * @param gen Pointer to code generator state
  * @param base Base for label name
  * @return Newly allocated string with unique label (caller must free)
  */
 char *genUniqueLabel(CodeGenerator *gen, const char *base)
 {
-    char *label = malloc(64);
+    const char *scope = gen->labelScope ? gen->labelScope : "";
+    size_t size = strlen(scope) + strlen(base) + 16;
+    char *label = malloc(size);
     if (!label)
     {
         errorExit(INTERNAL_ERROR, "Failed to allocate label", 0, NULL);
     }
 
-    char num[16];
-    sprintf(num, "%d", gen->labelCounter++);  // conversion int → string
-
-    strcpy(label, "$");   // IFJcode25 label must start with $
-    strcat(label, base);  // add base
-    strcat(label, "_");   // add "_"
-    strcat(label, num);   // add number
+    // IFJcode25 label must start with $
+    snprintf(label, size, "$%s%s%s_%d", scope, gen->labelScope ? "$" : "", base,
+             gen->labelCounter++);
+    STATS_COUNT(STAT_LABELS, 1);
 
     return label;
 }
@@ -71,6 +77,7 @@ char *genTempVar(CodeGenerator *gen)
     // Same algorithm as for label
     char num[16];
     sprintf(num, "%d", gen->tempVarCounter++);
+    STATS_COUNT(STAT_TEMPS, 1);
 
     strcpy(var, "$$tmp_");
     strcat(var, num);
@@ -78,14 +85,49 @@ char *genTempVar(CodeGenerator *gen)
     return var;
 }
 
+/**
+ * @brief Returns symbol of identifier or declaration resolved by bindProgram
+ * @param node Identifier, parameter or variable declaration node
+ * @return Bound symbol, exits with INTERNAL_ERROR when binding is missing
+ */
+Symbol *genBoundSymbol(AstNode *node)
+{
+    if (!node->symbol || node->symbol->storage == STORAGE_UNBOUND)
+    {
+        errorExit(INTERNAL_ERROR, "Identifier without binding in code generation",
+                  tokenLine(&node->token), &node->token);
+    }
+    return node->symbol;
+}
+
+/**
+ * @brief Returns frame of bound variable ("GF" or "LF")
+ * @param sym Bound symbol with STORAGE_GLOBAL or STORAGE_LOCAL
+ */
+const char *genFramePrefix(Symbol *sym)
+{
+    return sym->storage == STORAGE_GLOBAL ? "GF" : "LF";
+}
+
 /**
  * @brief Start generating output code.
  * @param astRoot Pointer to initialised AST node representing root node of AST.
  */
 void generate(AstNode *astRoot, SymTableStack *symStack)
+{
+    generateCached(astRoot, symStack, NULL);
+}
+
+/**
+ * @brief Generate output code, unchanged functions are copied from cache.
+ * @param astRoot Pointer to initialised AST node representing root node of AST.
+ * @param cache Initialised cache or NULL.
+ */
+void generateCached(AstNode *astRoot, SymTableStack *symStack, GenCache *cache)
 {
     CodeGenerator codeGen;
     codeGeneratorInit(&codeGen, symStack);
+    codeGen.cache = cache;
 
     // AstRoot odkazuje na class Program (jediná class celého souboru?)
     genNode(astRoot, &codeGen);
@@ -183,6 +225,190 @@ void genNode(AstNode *node, CodeGenerator *codeGen)
     }
 }
 
+/**
+ * @brief Generates code of one function, getter or setter into current output.
+ * Labels and temporaries are numbered from zero in every function, so its code depends only
+ * on the function itself and bindings of symbols it uses.
+ * @param node Function node.
+ */
+static void genFunctionCode(AstNode *node, CodeGenerator *codeGen)
+{
+    codeGen->labelScope = node->symbol ? node->symbol->frameName : NULL;
+    codeGen->labelCounter = 0;
+    codeGen->tempVarCounter = 0;
+
+    genNode(node, codeGen);
+
+    codeGen->labelScope = NULL;
+    codeGen->labelCounter = 0;
+    codeGen->tempVarCounter = 0;
+}
+
+/**
+ * @brief Generates one function, getter or setter, or copies it from cache.
+ * @param node Function node.
+ */
+static void genFunction(AstNode *node, CodeGenerator *codeGen)
+{
+    if (!codeGen->cache)
+    {
+        genFunctionCode(node, codeGen);
+        return;
+    }
+
+    uint64_t key = genCacheFunctionKey(codeGen->cache, node);
+    if (!genCacheEmit(codeGen->cache, key, emitGetOutput()))
+    {
+        GenCapture capture;
+        genCaptureBegin(&capture);
+        genFunctionCode(node, codeGen);
+        genCaptureEnd(&capture);
+
+        fwrite(capture.data, 1, capture.length, emitGetOutput());
+        genCacheStore(codeGen->cache, key, capture.data, capture.length);
+        genCaptureDispose(&capture);
+    }
+}
+
+/* ==========================================================
+ *  PARALLEL FUNCTIONS
+ * ========================================================== */
+
+// Menej funkcií sa neoplatí rozdeľovať medzi vlákna
+#define GEN_PARALLEL_MIN_FUNCTIONS 64
+
+static long genParallelMin = GEN_PARALLEL_MIN_FUNCTIONS;
+
+void genSetParallelMin(long functions)
+{
+    genParallelMin = functions >= 0 ? functions : GEN_PARALLEL_MIN_FUNCTIONS;
+}
+
+/**
+ * @brief Function generated by worker into its own buffer
+ */
+typedef struct
+{
+    AstNode *node;         // AST_FUN_DEC, AST_FUN_GET or AST_FUN_SET
+    CodeGenerator gen;     // Private generator state, labels are scoped by function
+    GenCapture capture;    // Generated code (or code copied from cache)
+    uint64_t key;          // Cache key, valid when gen.cache is set
+    bool cached;           // Code was copied from cache, no task is needed
+    bool failed;           // Generation stopped on errorExit, error is in trap
+    ErrorTrap trap;        // Error raised while generating
+    const SourceMap *map;  // Source map of compiled file for diagnostics of task
+} GenFunctionTask;
+
+static bool genIsFunction(AstNode *item)
+{
+    return item->type == AST_FUN_DEC || item->type == AST_FUN_GET || item->type == AST_FUN_SET;
+}
+
+/**
+ * @brief Worker: generates function into memory, errors are only recorded
+ */
+static void genFunctionTask(void *arg)
+{
+    GenFunctionTask *task = arg;
+
+    sourceMapSetCurrent(task->map);
+    genCaptureBegin(&task->capture);
+    errorTrapSet(&task->trap);
+    if (setjmp(task->trap.jump) == 0)
+    {
+        genFunctionCode(task->node, &task->gen);
+    }
+    else
+    {
+        task->failed = true;
+    }
+    errorTrapSet(NULL);
+    genCaptureEnd(&task->capture);
+}
+
+/**
+ * @brief Generates all functions of class on thread pool
+ *
+ * Every function gets its own CodeGenerator and output buffer, buffers are written in source
+ * order, so output is the same as from serial generation. Cache is read and written only by
+ * calling thread. An error of a function is reported after code of functions before it has
+ * been written, like in serial run.
+ *
+ * @param nodes Items of class declaration.
+ * @param count Number of functions among items.
+ * @return false when parallel generation is not worth it (nothing was generated)
+ */
+static bool genFunctionsParallel(NodeVec *nodes, long count, CodeGenerator *codeGen)
+{
+    int threads = threadPoolDefaultSize();
+    if (threads < 2 || count < genParallelMin)
+    {
+        return false;
+    }
+
+    GenFunctionTask *tasks = calloc((size_t)count, sizeof(GenFunctionTask));
+    if (!tasks)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate code generation tasks", 0, NULL);
+    }
+
+    ThreadPool *pool = threadPoolCreate(threads);
+    long taskCount = 0;
+    for (long i = 0; i < nodes->count; i++)
+    {
+        if (!genIsFunction(nodes->items[i])) continue;
+
+        GenFunctionTask *task = &tasks[taskCount++];
+        task->node = nodes->items[i];
+        task->gen = *codeGen;
+        task->gen.cache = NULL;
+        task->map = sourceMapCurrent();
+
+        if (codeGen->cache)
+        {
+            // Zásah v cache sa skopíruje hneď, generujú sa len chýbajúce funkcie
+            task->key = genCacheFunctionKey(codeGen->cache, task->node);
+            genCaptureBegin(&task->capture);
+            task->cached = genCacheEmit(codeGen->cache, task->key, task->capture.stream);
+            genCaptureEnd(&task->capture);
+            if (task->cached) continue;
+            genCaptureDispose(&task->capture);
+        }
+        threadPoolSubmit(pool, genFunctionTask, task);
+        STATS_COUNT(STAT_GEN_TASKS, 1);
+    }
+    threadPoolWait(pool);
+    threadPoolDestroy(pool);
+
+    FILE *output = emitGetOutput();
+    for (long i = 0; i < taskCount; i++)
+    {
+        GenFunctionTask *task = &tasks[i];
+        if (task->failed)
+        {
+            // Sériovo by rozpracovaná funkcia skončila na výstupe (pri cache nie)
+            if (!codeGen->cache)
+            {
+                fwrite(task->capture.data, 1, task->capture.length, output);
+            }
+            ErrorTrap trap = task->trap;
+            for (long j = i; j < taskCount; j++) genCaptureDispose(&tasks[j].capture);
+            free(tasks);
+            errorExit(trap.code, trap.msg, trap.line, trap.token);
+        }
+
+        fwrite(task->capture.data, 1, task->capture.length, output);
+        if (codeGen->cache && !task->cached)
+        {
+            genCacheStore(codeGen->cache, task->key, task->capture.data, task->capture.length);
+        }
+        genCaptureDispose(&task->capture);
+    }
+
+    free(tasks);
+    return true;
+}
+
 /**
  * @brief Generates code for a class declaration node (AST_CLASS_DEC).
  * @param node Pointer to the AST node representing a class declaration.
@@ -195,18 +421,21 @@ void genClassDec(AstNode *node, CodeGenerator *codeGen)
     // 1. Generuj VŠECHNY funkce (včetně main)
     if (node->children)
     {
-        AstN *children = (AstN *)node->children;
-        if (children->childrenList)
+        NodeVec *nodes = &((AstN *)node->children)->nodes;
+        long count = 0;
+        for (long i = 0; i < nodes->count; i++)
         {
-            ListItem *item = children->childrenList->firstItem;
-            while (item)
+            if (genIsFunction(nodes->items[i])) count++;
+        }
+
+        if (!genFunctionsParallel(nodes, count, codeGen))
+        {
+            for (long i = 0; i < nodes->count; i++)
             {
-                if (item->item->type == AST_FUN_DEC || item->item->type == AST_FUN_GET ||
-                    item->item->type == AST_FUN_SET)
+                if (genIsFunction(nodes->items[i]))
                 {
-                    genNode(item->item, codeGen);
+                    genFunction(nodes->items[i], codeGen);
                 }
-                item = item->next;
             }
         }
     }
@@ -232,18 +461,14 @@ void genClassDec(AstNode *node, CodeGenerator *codeGen)
     // 4. Globální přiřazení
     if (node->children)
     {
-        AstN *children = (AstN *)node->children;
-        if (children->childrenList)
+        NodeVec *nodes = &((AstN *)node->children)->nodes;
+        for (long i = 0; i < nodes->count; i++)
         {
-            ListItem *item = children->childrenList->firstItem;
-            while (item)
+            AstNode *item = nodes->items[i];
+            if (item->type != AST_FUN_DEC && item->type != AST_FUN_GET &&
+                item->type != AST_FUN_SET && item->type != AST_VAR_DEC)
             {
-                if (item->item->type != AST_FUN_DEC && item->item->type != AST_FUN_GET &&
-                    item->item->type != AST_FUN_SET && item->item->type != AST_VAR_DEC)
-                {
-                    genNode(item->item, codeGen);
-                }
-                item = item->next;
+                genNode(item, codeGen);
             }
         }
     }
@@ -271,16 +496,17 @@ void genVarDec(AstNode *node, CodeGenerator *codeGen)
     // AST_VAR_DEC nikdy nebude mít děti, je to list
 
     if (node == NULL) return;
+    (void)codeGen;
 
-    if (node->token.type == GLOBAL_IDENTIFIER)
+    Symbol *sym = genBoundSymbol(node);
+    if (sym->storage == STORAGE_GLOBAL)
     {
-        emitLine("MOVE GF@%s nil@nil", node->token.value->stringVal);
+        emitLine("MOVE GF@%s nil@nil", sym->frameName);
     }
-
-    else if (node->token.type == IDENTIFIER)
+    else
     {
-        emitLine("DEFVAR LF@%s$%d", node->token.value->stringVal, codeGen->frameDepth);
-        emitLine("MOVE LF@%s$%d nil@nil", node->token.value->stringVal, codeGen->frameDepth);
+        emitLine("DEFVAR LF@%s", sym->frameName);
+        emitLine("MOVE LF@%s nil@nil", sym->frameName);
     }
 }
 
@@ -299,20 +525,15 @@ void genVarAssign(AstNode *node, CodeGenerator *codeGen)
     // Najprv vyhodnoť výraz (výsledok bude na zásobníku)
     genNode(right, codeGen);
 
-    char *name = left->token.value->stringVal;
-    Symbol *sym = symTableStackFindSymbol(codeGen->symStack, name);
+    Symbol *sym = genBoundSymbol(left);
 
-    if (sym && sym->kind == SYM_SET)
+    if (sym->storage == STORAGE_SETTER)
     {
-        emitLine("CALL %s_set", name);
-    }
-    else if (left->token.type == GLOBAL_IDENTIFIER)
-    {
-        emitLine("POPS GF@%s\n", name);
+        emitLine("CALL %s", sym->frameName);
     }
     else
     {
-        emitLine("POPS LF@%s$%d\n", name, codeGen->frameDepth);
+        emitLine("POPS %s@%s\n", genFramePrefix(sym), sym->frameName);
     }
 }
 
@@ -336,14 +557,7 @@ void genFunDec(AstNode *node, CodeGenerator *codeGen)
     {
         // PARAMS
         AstN *paramsChildren = (AstN *)nodeChildren->left->children;
-        SLList *paramList = paramsChildren->childrenList;
-        ListItem *currentItem = paramList->firstItem;
-
-        while (currentItem != NULL)
-        {
-            paramCount += 1;
-            currentItem = currentItem->next;
-        }
+        paramCount = (int)paramsChildren->nodes.count;
     }
 
     // Generujeme náveštie s počtom parametrov
@@ -501,26 +715,20 @@ void genType(AstNode *node)
 void genIdentifier(AstNode *node, CodeGenerator *codeGen)
 {
     if (node == NULL) return;
+    (void)codeGen;
 
-    char *name = node->token.value->stringVal;
-
-    // Zistíme, či je to Getter pomocou SymTable
-    Symbol *sym = symTableStackFindSymbol(codeGen->symStack, name);
+    // Úložisko identifikátora určil bindProgram, netreba hľadať v SymTable
+    Symbol *sym = genBoundSymbol(node);
 
-    if (sym && sym->kind == SYM_GET)
+    if (sym->storage == STORAGE_GETTER)
     {
-        // JE TO GETTER -> Voláme funkciu
-        // Predpokladám, že getter sa v IFJcode volá "meno_get" (podľa genFunGet)
-        emitLine("CALL %s_get", name);
+        // JE TO GETTER -> Voláme funkciu (label "meno_get" podľa genFunGet)
+        emitLine("CALL %s", sym->frameName);
         // Výsledok je na zásobníku (z returnu funkcie), takže nemusíme robiť PUSHS
     }
-    else if (node->token.type == GLOBAL_IDENTIFIER)
-    {
-        emitLine("PUSHS GF@%s", name);
-    }
     else
     {
-        emitLine("PUSHS LF@%s$%d", name, codeGen->frameDepth);
+        emitLine("PUSHS %s@%s", genFramePrefix(sym), sym->frameName);
     }
 }
 
@@ -594,15 +802,12 @@ void genFunCall(AstNode *node, CodeGenerator *codeGen)
     if (argsNode)
     {
         AstN *listNode = (AstN *)argsNode->children;
-        if (listNode && listNode->childrenList)
+        if (listNode)
         {
-            argCount = listNode->childrenList->count;
-
-            ListItem *item = listNode->childrenList->firstItem;
-            while (item)
+            argCount = (int)listNode->nodes.count;
+            for (long i = 0; i < listNode->nodes.count; i++)
             {
-                genNode(item->item, codeGen);
-                item = item->next;
+                genNode(listNode->nodes.items[i], codeGen);
             }
         }
     }
@@ -875,7 +1080,7 @@ void genIfj(AstNode *node, CodeGenerator *codeGen)
 
     // Collect params into array for easy indexing
     AstN *paramsN = paramsNode ? (AstN *)paramsNode->children : NULL;
-    SLList *plist = paramsN ? paramsN->childrenList : NULL;
+    NodeVec *plist = paramsN ? &paramsN->nodes : NULL;
 
     // Count params
     long paramCount = 0;
@@ -886,25 +1091,20 @@ void genIfj(AstNode *node, CodeGenerator *codeGen)
     if (paramCount > 0)
     {
         tmpNames = malloc(sizeof(char *) * paramCount);
-        ListItem *it = plist->firstItem;
         long idx = 0;
-        while (it != NULL && idx < paramCount)
+        while (idx < paramCount)
         {
-            AstNode *p = it->item;
+            AstNode *p = plist->items[idx];
             char *tmp = genTempVar(codeGen);
             // DEFVAR LF@tmp$depth
             emitLine("DEFVAR LF@%s$%d", tmp, codeGen->frameDepth);
 
-            // Move value into temporary:
-            if (p->type == AST_IDENTIFIER)
+            // Move value into temporary (getter musí projít voláním přes genNode):
+            if (p->type == AST_IDENTIFIER && genBoundSymbol(p)->storage != STORAGE_GETTER)
             {
                 // identifier might be GF or LF
-                if (p->token.type == GLOBAL_IDENTIFIER)
-                    emitLine("MOVE LF@%s$%d GF@%s", tmp, codeGen->frameDepth,
-                             p->token.value->stringVal);
-                else
-                    emitLine("MOVE LF@%s$%d LF@%s$%d", tmp, codeGen->frameDepth,
-                             p->token.value->stringVal, codeGen->frameDepth);
+                emitLine("MOVE LF@%s$%d %s@%s", tmp, codeGen->frameDepth,
+                         genFramePrefix(p->symbol), p->symbol->frameName);
             }
             else if (p->type == AST_LITERAL)
             {
@@ -950,7 +1150,6 @@ void genIfj(AstNode *node, CodeGenerator *codeGen)
             }
 
             tmpNames[idx++] = tmp;
-            it = it->next;
         }
     }
 
@@ -998,7 +1197,7 @@ void genIfj(AstNode *node, CodeGenerator *codeGen)
         // Accept int or float. If int -> return int (same), if float -> FLOAT2INT
         char *in = tmpNames[0];
         char *res = genTempVar(codeGen);
-        ememitLineit("DEFVAR LF@%s$%d", res, codeGen->frameDepth);
+        emitLine("DEFVAR LF@%s$%d", res, codeGen->frameDepth);
 
         // TYPE check: if int -> MOVE result; if float -> FLOAT2INT; else EXIT 25
         char *typeTmp = genTempVar(codeGen);
@@ -1390,20 +1589,15 @@ void genIfj(AstNode *node, CodeGenerator *codeGen)
     free(endLabel);
 }
 
-void genParamsBackwardsRecursive(ListItem *item, CodeGenerator *codeGen)
-{
-    if (item == NULL) return;
-
-    genParamsBackwardsRecursive(item->next, codeGen);
-
-    emitLine("DEFVAR LF@%s$%d", item->item->token.value->stringVal, codeGen->frameDepth);
-    emitLine("POPS LF@%s$%d", item->item->token.value->stringVal, codeGen->frameDepth);
-}
-
-void genParamsBackwards(SLList *list, CodeGenerator *codeGen)
+void genParamsBackwards(NodeVec *list)
 {
-    if (!list) return;
-    genParamsBackwardsRecursive(list->firstItem, codeGen);
+    // Argumenty leží na zásobníku, poslední parametr je navrchu
+    for (long i = list->count - 1; i >= 0; i--)
+    {
+        Symbol *sym = genBoundSymbol(list->items[i]);
+        emitLine("DEFVAR LF@%s", sym->frameName);
+        emitLine("POPS LF@%s", sym->frameName);
+    }
 }
 
 /**
@@ -1415,25 +1609,24 @@ void genParams(AstNode *node, CodeGenerator *codeGen)
     // Děti PARAMS jsou vždy IDENTIFIER nebo LITERAL -> listy (bez dat, rovnou token)
 
     AstN *nodeChildren = (AstN *)node->children;
-    SLList *nodeList = nodeChildren->childrenList;
-
-    ListItem *currentItem = nodeList->firstItem;
+    NodeVec *nodeList = &nodeChildren->nodes;
 
     // Definuji novou proměnnou (parametr funkce)
     // Popnu do ní proměnnou ze zásobníku
     if (codeGen->inFunction)
     {
-        genParamsBackwards(nodeList, codeGen);
+        genParamsBackwards(nodeList);
         emitLine("");
     }
     else
     {
-        while (currentItem != NULL)
+        for (long i = 0; i < nodeList->count; i++)
         {
-            switch (currentItem->item->token.type)
+            AstNode *item = nodeList->items[i];
+            switch (item->token.type)
             {
                 case IDENTIFIER:
-                    genIdentifier(currentItem->item, codeGen);
+                    genIdentifier(item, codeGen);
                     break;
 
                 case INT_LITERAL:
@@ -1442,14 +1635,12 @@ void genParams(AstNode *node, CodeGenerator *codeGen)
                 case MULTILINE_STRING_LITERAL:
                 case KW_VAL_TRUE:
                 case KW_VAL_FALSE:
-                    genLiteral(currentItem->item);
+                    genLiteral(item);
                     break;
 
                 default:
                     break;
             }
-
-            currentItem = currentItem->next;
         }
     }
 }
@@ -1649,13 +1840,110 @@ void genDynamicComparison(TokenType op, CodeGenerator *codeGen)
 }
 
 /**
- * @brief Generates code for an operator node (AST_OPERATOR).
- * @param node Pointer to the AST node representing an operator (+, -, *, /, <, >, etc.).
+ * @brief Generates arithmetic or relational operator whose operand types are known statically.
+ * Int operand is converted right after it is pushed when float arithmetic is needed, so no
+ * run-time type checks are emitted. Left operand is already on the data stack.
+ * @return true when code was generated, false when the operator needs dynamic code.
  */
-void genOperator(AstNode *node, CodeGenerator *codeGen)
+static bool genTypedOperator(AstNode *node, CodeGenerator *codeGen)
 {
-    if (node == NULL) return;
+    AstBin *data = (AstBin *)node->children;
+    if (data == NULL || data->left == NULL || data->right == NULL) return false;
+
+    TokenType op = node->token.type;
+    ExprType left = data->left->expressionType;
+    ExprType right = data->right->expressionType;
+
+    bool arithmetic = op == PLUS || op == MINUS || op == MULTIPLY || op == DIVIDE;
+    bool relational = op == IS_SMALLER || op == IS_BIGGER || op == IS_EQUAL ||
+                      op == IS_NOT_EQUAL || op == IS_SMALLER_OR_EQUAL || op == IS_BIGGER_OR_EQUAL;
+    if (!arithmetic && !relational) return false;
+
+    bool numeric = (left == TYPE_INT || left == TYPE_FLOAT) &&
+                   (right == TYPE_INT || right == TYPE_FLOAT);
+    bool concat = op == PLUS && left == TYPE_STRING && right == TYPE_STRING;
+    // Bez float operandu porovnává genDynamicComparison hodnoty přímo, nil se rovná jen nil
+    bool direct = relational && left && right &&
+                  !((left | right) & (TYPE_UNKNOWN | TYPE_FLOAT));
+    bool nullTest = (op == IS_EQUAL || op == IS_NOT_EQUAL) &&
+                    (left == TYPE_NULL || right == TYPE_NULL);
+    if (!numeric && !concat && !direct && !nullTest) return false;
+
+    bool toFloat = numeric && (op == DIVIDE || left == TYPE_FLOAT || right == TYPE_FLOAT);
+
+    if (toFloat && left == TYPE_INT) emitLine("INT2FLOATS");
+    genNode(data->right, codeGen);
+    if (toFloat && right == TYPE_INT) emitLine("INT2FLOATS");
+
+    if (concat)
+    {
+        emitLine("CREATEFRAME");
+        emitLine("PUSHFRAME");
+
+        char *b = genTempVar(codeGen);
+        char *a = genTempVar(codeGen);
+        emitLine("DEFVAR LF@%s$%d", b, codeGen->frameDepth);
+        emitLine("DEFVAR LF@%s$%d", a, codeGen->frameDepth);
+        emitLine("POPS LF@%s$%d", b, codeGen->frameDepth);
+        emitLine("POPS LF@%s$%d", a, codeGen->frameDepth);
+        emitLine("CONCAT LF@%s$%d LF@%s$%d LF@%s$%d", a, codeGen->frameDepth, a,
+                 codeGen->frameDepth, b, codeGen->frameDepth);
+        emitLine("PUSHS LF@%s$%d", a, codeGen->frameDepth);
+
+        emitLine("POPFRAME");
+        free(b);
+        free(a);
+        return true;
+    }
 
+    switch (op)
+    {
+        case PLUS:
+            emitLine("ADDS");
+            break;
+        case MINUS:
+            emitLine("SUBS");
+            break;
+        case MULTIPLY:
+            emitLine("MULS");
+            break;
+        case DIVIDE:
+            emitLine("DIVS");
+            break;
+        case IS_SMALLER:
+            emitLine("LTS");
+            break;
+        case IS_BIGGER:
+            emitLine("GTS");
+            break;
+        case IS_EQUAL:
+            emitLine("EQS");
+            break;
+        case IS_NOT_EQUAL:
+            emitLine("EQS");
+            emitLine("NOTS");
+            break;
+        case IS_SMALLER_OR_EQUAL:
+            emitLine("GTS");
+            emitLine("NOTS");
+            break;
+        case IS_BIGGER_OR_EQUAL:
+            emitLine("LTS");
+            emitLine("NOTS");
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+/**
+ * @brief Generates right operand and the operator itself, left operand is already on the data
+ * stack.
+ * @param node Pointer to the AST node representing an operator (+, -, *, /, <, >, etc.).
+ */
+static void genOperatorTail(AstNode *node, CodeGenerator *codeGen)
+{
     AstBin *data = (AstBin *)node->children;
 
     if (node->token.type == LOGICAL_AND)
@@ -1663,8 +1951,6 @@ void genOperator(AstNode *node, CodeGenerator *codeGen)
         char *labEnd = genUniqueLabel(codeGen, "and_end");
         char *labFalse = genUniqueLabel(codeGen, "and_false");
 
-        genNode(data->left, codeGen);
-
         char *tmp = genTempVar(codeGen);
         emit("DEFVAR LF@%s$%d\n", tmp, codeGen->frameDepth);
         emit("POPS LF@%s$%d\n", tmp, codeGen->frameDepth);
@@ -1689,8 +1975,6 @@ void genOperator(AstNode *node, CodeGenerator *codeGen)
         char *labEnd = genUniqueLabel(codeGen, "or_end");
         char *labTrue = genUniqueLabel(codeGen, "or_true");
 
-        genNode(data->left, codeGen);
-
         char *tmp = genTempVar(codeGen);
         emit("DEFVAR LF@%s$%d\n", tmp, codeGen->frameDepth);
         emit("POPS LF@%s$%d\n", tmp, codeGen->frameDepth);
@@ -1721,7 +2005,9 @@ void genOperator(AstNode *node, CodeGenerator *codeGen)
         return;
     }
 
-    genNode(data->left, codeGen);
+    // Typy z inferProgram, operandy známého typu nepotřebují kontroly za běhu
+    if (genTypedOperator(node, codeGen)) return;
+
     genNode(data->right, codeGen);
 
     switch (node->token.type)
@@ -1811,10 +2097,27 @@ void genOperator(AstNode *node, CodeGenerator *codeGen)
         }
 
         default:
-            errorExit(INTERNAL_ERROR, "Unknown operator in codegen", node->token.line, NULL);
+            errorExit(INTERNAL_ERROR, "Unknown operator in codegen", tokenLine(&node->token), NULL);
     }
 }
 
+/**
+ * @brief Generates code for an operator node (AST_OPERATOR).
+ * @param node Pointer to the AST node representing an operator (+, -, *, /, <, >, etc.).
+ */
+void genOperator(AstNode *node, CodeGenerator *codeGen)
+{
+    if (node == NULL) return;
+
+    // Levá větev řetězce "1 + 1 + ... + 1" je hluboká, operátory se generují cyklem zdola nahoru
+    NodeVec spine;
+    nodeVecInit(&spine);
+    astLeftSpine(node, &spine);
+    genNode(((AstBin *)spine.items[spine.count - 1]->children)->left, codeGen);
+    for (long i = spine.count - 1; i >= 0; i--) genOperatorTail(spine.items[i], codeGen);
+    nodeVecDispose(&spine);
+}
+
 void genNodeChildren(AstNode *node, CodeGenerator *codeGen)
 {
     if (!node) return;
@@ -1828,30 +2131,26 @@ void genNodeChildren(AstNode *node, CodeGenerator *codeGen)
             // Kontrola, zda má uzel vůbec nějaké děti (strukturu AstN)
             if (node->children == NULL) return;
 
-            AstN *nodeChildren = (AstN *)node->children;
-
-            // Kontrola, zda existuje seznam dětí
-            if (nodeChildren->childrenList == NULL) return;
-
-            SLList *nodeList = nodeChildren->childrenList;
+            NodeVec *nodeList = &((AstN *)node->children)->nodes;
 
-            ListItem *currentItem = nodeList->firstItem;
-
-            while (currentItem != NULL)
+            long i = 0;
+            while (i < nodeList->count)
             {
+                AstNode *currentItem = nodeList->items[i];
+
                 // LOOKAHEAD LOGIKA:
                 // Ak je aktuálny uzol IF a nasledujúci je ELSE, spracuj ich spolu.
-                if (currentItem->item->type == AST_IF_STMT)
+                if (currentItem->type == AST_IF_STMT)
                 {
-                    ListItem *nextItem = currentItem->next;
+                    AstNode *nextItem = i + 1 < nodeList->count ? nodeList->items[i + 1] : NULL;
 
                     // Musíme zistiť, či 'nextItem' je ELSE.
                     // Keďže parser vracia pre ELSE typ AST_IF_STMT, musíme sa pozrieť hlbšie.
                     // ELSE nemá podmienku (left == NULL).
                     bool isNextElse = false;
-                    if (nextItem && nextItem->item->type == AST_IF_STMT)
+                    if (nextItem && nextItem->type == AST_IF_STMT)
                     {
-                        AstBin *nextData = (AstBin *)nextItem->item->children;
+                        AstBin *nextData = (AstBin *)nextItem->children;
                         if (nextData != NULL && nextData->left == NULL)
                         {
                             isNextElse = true;
@@ -1861,16 +2160,16 @@ void genNodeChildren(AstNode *node, CodeGenerator *codeGen)
                     if (isNextElse)
                     {
                         // Máme IF nasledovaný ELSE -> generujeme plný IF-ELSE
-                        AstNode *ifNode = currentItem->item;
+                        AstNode *ifNode = currentItem;
                         AstNode *elseNode =
-                            nextItem->item;  // Toto je ten "fake" IF, ktorý je v skutočnosti ELSE
+                            nextItem;  // Toto je ten "fake" IF, ktorý je v skutočnosti ELSE
 
                         // Získanie dát
                         if (ifNode->children == NULL || elseNode->children == NULL)
                         {
                             // Fallback to standard processing
-                            genNode(currentItem->item, codeGen);
-                            currentItem = currentItem->next;
+                            genNode(currentItem, codeGen);
+                            i++;
                             continue;
                         }
 
@@ -1881,8 +2180,8 @@ void genNodeChildren(AstNode *node, CodeGenerator *codeGen)
                             ifData->right == NULL || elseData->right == NULL)
                         {
                             // Fallback to standard processing
-                            genNode(currentItem->item, codeGen);
-                            currentItem = currentItem->next;
+                            genNode(currentItem, codeGen);
+                            i++;
                             continue;
                         }
 
@@ -1923,14 +2222,14 @@ void genNodeChildren(AstNode *node, CodeGenerator *codeGen)
                         free(labelEnd);
 
                         // POSUN: Preskočíme ELSE uzol, lebo sme ho už spracovali
-                        currentItem = nextItem->next;
+                        i += 2;
                         continue;
                     }
                 }
 
                 // Štandardné spracovanie (samostatný IF, WHILE, iné príkazy)
-                genNode(currentItem->item, codeGen);
-                currentItem = currentItem->next;
+                genNode(currentItem, codeGen);
+                i++;
             }
         }
         break;
@@ -11,16 +11,19 @@
 #ifndef CODEGEN_H
 #define CODEGEN_H
 
+#include "gencache.h"
 #include "parser.h"
 #include "symtable.h"
 
 typedef struct
 {
     SymTableStack *symStack;
-    int labelCounter;    // Globální čítač pro unikátní LABELy
-    int tempVarCounter;  // Čítač pro dočasné proměnné
-    bool inFunction;     // Jestli právě generujeme funkci
-    int frameDepth;      // 0 = global, 1 = first PUSHFRAME, …
+    int labelCounter;        // Čítač pro unikátní LABELy v rámci labelScope
+    int tempVarCounter;      // Čítač pro dočasné proměnné
+    bool inFunction;         // Jestli právě generujeme funkci
+    int frameDepth;          // 0 = global, 1 = first PUSHFRAME, …
+    const char *labelScope;  // Návěští generované funkce, prefix jejích LABELů (NULL = global)
+    GenCache *cache;         // Cache vygenerovaných funkcí, NULL = generuje se vše
 } CodeGenerator;
 
 /**
@@ -29,12 +32,38 @@ typedef struct
  */
 void codeGeneratorInit(CodeGenerator *codeGen, SymTableStack *symStack);
 
+/**
+ * @brief Returns symbol of identifier or declaration resolved by bindProgram
+ * @param node Identifier, parameter or variable declaration node
+ * @return Bound symbol, exits with INTERNAL_ERROR when binding is missing
+ */
+Symbol *genBoundSymbol(AstNode *node);
+
+/**
+ * @brief Returns frame of bound variable ("GF" or "LF")
+ * @param sym Bound symbol with STORAGE_GLOBAL or STORAGE_LOCAL
+ */
+const char *genFramePrefix(Symbol *sym);
+
 /**
  * @brief Start generating output code.
  * @param astRoot Pointer to initialised AST node representing root node of AST.
  */
 void generate(AstNode *astRoot, SymTableStack *symStack);
 
+/**
+ * @brief Set minimal number of functions generated on thread pool (--gen-parallel-min=N).
+ * @param functions Minimal count, negative value restores the default.
+ */
+void genSetParallelMin(long functions);
+
+/**
+ * @brief Generate output code, unchanged functions are copied from cache.
+ * @param astRoot Pointer to initialised AST node representing root node of AST.
+ * @param cache Initialised cache or NULL.
+ */
+void generateCached(AstNode *astRoot, SymTableStack *symStack, GenCache *cache);
+
 /**
  * @brief Dispatches code generation for a given AST node.
  * @param node Pointer to the AST node to be processed.
@@ -172,7 +201,7 @@ void genParams(AstNode *node, CodeGenerator *codeGen);
 void genOperator(AstNode *node, CodeGenerator *codeGen);
 
 /**
- * Chooses the right structure (BinTree or SLList) for the AstNodeType.
+ * Chooses the right structure (BinTree or NodeVec) for the AstNodeType.
  * @brief Access and call code_gen on all children of AstNode.
  * @param astRoot Pointer to initialised AST node.
  * @param codeGen Pointer to initialised CodeGenerator struct.
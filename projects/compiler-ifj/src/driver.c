@@ -0,0 +1,251 @@
+/**
+ * @file driver.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Whole compilation pipeline from source to IFJcode25
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "driver.h"
+
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "binder.h"
+#include "codegen.h"
+#include "error.h"
+#include "infer.h"
+#include "outcache.h"
+#include "parser.h"
+#include "scanner.h"
+#include "semantic.h"
+#include "stats.h"
+#include "utils.h"
+
+#define COMPILE_READ_CHUNK 65536
+
+SymTableStack* compileSymStackCreate(void)
+{
+    SymTableStack* symStack = symTableStackCreate(INITIAL_CAPACITY_STACK);
+    if (!symStack)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to create symbol table", 0, NULL);
+    }
+    compileSymStackReset(symStack);
+    return symStack;
+}
+
+void compileSymStackReset(SymTableStack* symStack)
+{
+    symTableStackReset(symStack);
+    symTableStackPush(symStack);
+    loadIFJBuiltins(symStack);
+}
+
+void compileRun(CompileState* state, FILE* source, SymTableStack* symStack, const char* cacheDir)
+{
+    // Zdroje se zapisují do stavu hned po vytvoření, aby je šlo uvolnit i po zachycené chybě
+    memset(state, 0, sizeof(*state));
+    state->scanner = calloc(1, sizeof(Scanner));
+    if (!state->scanner)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate scanner", 0, NULL);
+    }
+
+    state->resolveLater = nodeVecCreate();
+    if (!state->resolveLater)
+    {
+        compileStateDispose(state);
+        errorExit(INTERNAL_ERROR, "Failed to create symbol table", 0, NULL);
+    }
+
+    Scanner* scanner = state->scanner;
+    uint64_t start = statsPhaseBegin();
+    initScanner(scanner, source);
+    statsPhaseEnd(PHASE_READ, start);
+
+    // Prológ import "ifj25" for Ifj
+    start = statsPhaseBegin();
+    int prologue = readPrologue(scanner);
+    statsPhaseEnd(PHASE_PROLOGUE, start);
+    if (prologue != 0)
+    {
+        compileStateDispose(state);
+        errorExit(SYNTAX_ERROR, "Invalid prologue", 0, NULL);
+    }
+
+    state->parser = parserInit(scanner, symStack, state->resolveLater);
+    if (!state->parser)
+    {
+        compileStateDispose(state);
+        errorExit(INTERNAL_ERROR, "Failed to init parser", 0, NULL);
+    }
+    Parser* parser = state->parser;
+    start = statsPhaseBegin();
+    parseProgram(parser);
+    statsPhaseEnd(PHASE_PARSE, start);
+
+    start = statsPhaseBegin();
+    symTableStackPush(symStack);
+    semanticResolveCheckLaterParallel(state->resolveLater, parser->symStack, parser->root);
+    statsPhaseEnd(PHASE_SEMANTIC, start);
+
+    start = statsPhaseBegin();
+    checkFunDec(symStack->scopes[0]);
+    statsPhaseEnd(PHASE_FUN_DEC, start);
+
+    if (parser->root)
+    {
+        // Kódovanie do IFJcode25
+        start = statsPhaseBegin();
+        bindProgram(parser->root, symStack);
+        statsPhaseEnd(PHASE_BIND, start);
+
+        start = statsPhaseBegin();
+        inferProgram(parser->root);
+        statsPhaseEnd(PHASE_INFER, start);
+
+        start = statsPhaseBegin();
+        if (cacheDir)
+        {
+            GenCache cache;
+            genCacheInit(&cache, cacheDir, scanner->buffer, scanner->length);
+            generateCached(parser->root, symStack, &cache);
+        }
+        else
+        {
+            generate(parser->root, symStack);
+        }
+        statsPhaseEnd(PHASE_GENERATE, start);
+    }
+
+    symTableStackPop(symStack);
+    compileStateDispose(state);
+}
+
+void compileStateDispose(CompileState* state)
+{
+    if (state->parser)
+    {
+        Parser* parser = state->parser;
+        if (parser->root) astDispose(parser->root);
+        if (parser->current.type != NONE) freeToken(&parser->current);
+        astStackDispose(&parser->expStack);
+        free(parser);
+        state->parser = NULL;
+    }
+    if (state->resolveLater)
+    {
+        nodeVecDestroy(state->resolveLater);
+        state->resolveLater = NULL;
+    }
+    if (state->scanner)
+    {
+        disposeScanner(state->scanner);
+        free(state->scanner);
+        state->scanner = NULL;
+    }
+}
+
+void compileProgram(FILE* source, SymTableStack* symStack, const char* cacheDir)
+{
+    CompileState state;
+    compileRun(&state, source, symStack, cacheDir);
+}
+
+/**
+ * @brief Reads whole stream, caller frees
+ */
+static char* compileReadAll(FILE* source, size_t* length)
+{
+    size_t capacity = COMPILE_READ_CHUNK;
+    char* data = malloc(capacity);
+    *length = 0;
+    while (data)
+    {
+        *length += fread(data + *length, 1, capacity - *length, source);
+        if (*length < capacity) return data;
+
+        capacity *= 2;
+        char* grown = realloc(data, capacity);
+        if (!grown) free(data);
+        data = grown;
+    }
+    errorExit(INTERNAL_ERROR, "Failed to read source", 0, NULL);
+    return NULL;
+}
+
+int compileProgramCached(FILE* source, const char* cacheDir)
+{
+    size_t length;
+    char* text = compileReadAll(source, &length);
+
+    OutCache cache;
+    outCacheInit(&cache, cacheDir, text, length, "compile");
+    int code;
+    if (outCacheReplay(&cache, stdout, stderr, &code))
+    {
+        free(text);
+        return code;
+    }
+
+    // Výstup i chybové hlášky se zachytí, aby šly uložit spolu s návratovým kódem
+    char* out = NULL;
+    char* err = NULL;
+    size_t outLength = 0;
+    size_t errLength = 0;
+    FILE* outStream = open_memstream(&out, &outLength);
+    FILE* errStream = open_memstream(&err, &errLength);
+    FILE* input = fmemopen(text, length, "r");
+    if (!outStream || !errStream || !input)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to open memory stream", 0, NULL);
+    }
+
+    SymTableStack* symStack = compileSymStackCreate();
+    CompileState state;
+    ErrorTrap trap;
+    memset(&trap, 0, sizeof(trap));
+    trap.log = errStream;
+
+    emitSetOutput(outStream);
+    errorTrapSet(&trap);
+    if (setjmp(trap.jump) == 0)
+    {
+        compileRun(&state, input, symStack, NULL);
+        code = 0;
+    }
+    else
+    {
+        code = trap.code;
+        compileStateDispose(&state);
+    }
+    errorTrapSet(NULL);
+    emitSetOutput(NULL);
+
+    fclose(input);
+    if (fclose(outStream) != 0 || fclose(errStream) != 0)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to capture compiler output", 0, NULL);
+    }
+
+    fwrite(out, 1, outLength, stdout);
+    fwrite(err, 1, errLength, stderr);
+    // Interní chyba může být jen chvilková (paměť, soubory), ta se neukládá
+    if (code != INTERNAL_ERROR)
+    {
+        outCacheStore(&cache, code, out, outLength, err, errLength);
+    }
+
+    freeSymTableStack(symStack);
+    free(out);
+    free(err);
+    free(text);
+    return code;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file driver.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Whole compilation pipeline from source to IFJcode25
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <stdio.h>
+
+#include "parser.h"
+#include "scanner.h"
+#include "symtable.h"
+
+/**
+ * @brief Resources of one compilation, owned until compileStateDispose
+ */
+typedef struct
+{
+    Scanner* scanner;       // Scanner with whole source buffer
+    NodeVec* resolveLater;  // Nodes waiting for semantic resolution
+    Parser* parser;         // Parser holding AST root
+} CompileState;
+
+/**
+ * @brief Creates symbol table stack with global scope holding IFJ builtins
+ *
+ * The stack does not depend on compiled source, so it can be prepared in advance (for example
+ * once in compiler daemon before it forks for requests).
+ *
+ * @return SymTableStack* never NULL, exits with INTERNAL_ERROR on failure
+ */
+SymTableStack* compileSymStackCreate(void);
+
+/**
+ * @brief Returns used stack to the state after compileSymStackCreate, memory is reused
+ *
+ * @param symStack stack from compileSymStackCreate
+ */
+void compileSymStackReset(SymTableStack* symStack);
+
+/**
+ * @brief Compiles program read from source, IFJcode25 is written to emit output
+ *
+ * Runs scanner, parser, semantic analysis, binding, type inference and code generation.
+ * Errors end the process through errorExit with their exit code.
+ *
+ * @param source source of program including prologue
+ * @param symStack stack from compileSymStackCreate, globals of program are added to it
+ * @param cacheDir directory of incremental cache, NULL = generate all functions
+ */
+void compileProgram(FILE* source, SymTableStack* symStack, const char* cacheDir);
+
+/**
+ * @brief Same as compileProgram, resources of compilation are kept in state
+ *
+ * When an error is caught by ErrorTrap, state still holds what was allocated before it and the
+ * caller frees it with compileStateDispose. After successful run state is already empty.
+ *
+ * @param state filled by compileRun, must outlive the setjmp of the caller's trap
+ * @param source source of program including prologue
+ * @param symStack stack from compileSymStackCreate, globals of program are added to it
+ * @param cacheDir directory of incremental cache, NULL = generate all functions
+ */
+void compileRun(CompileState* state, FILE* source, SymTableStack* symStack, const char* cacheDir);
+
+/**
+ * @brief Frees source buffer, AST and parser state left in state, state stays reusable
+ *
+ * @param state state from compileRun
+ */
+void compileStateDispose(CompileState* state);
+
+/**
+ * @brief Compiles program read from source through content-addressed cache in cacheDir
+ *
+ * Source is read whole and hashed first, a cached result is written to stdout and stderr
+ * without scanning or parsing. Otherwise the program is compiled with errors caught, its code,
+ * messages and exit code are stored and written out the same way.
+ *
+ * @param source source of program including prologue
+ * @param cacheDir directory of cache, created when missing
+ * @return int exit code of compilation
+ */
+int compileProgramCached(FILE* source, const char* cacheDir);
+
+#endif  // DRIVER_H
@@ -3,12 +3,29 @@
  * @brief Implementation of error handling functions
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "error.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+static pthread_key_t trapKey;
+static pthread_once_t trapKeyOnce = PTHREAD_ONCE_INIT;
+
+static void trapKeyCreate(void)
+{
+    pthread_key_create(&trapKey, NULL);
+}
+
+void errorTrapSet(ErrorTrap *trap)
+{
+    pthread_once(&trapKeyOnce, trapKeyCreate);
+    pthread_setspecific(trapKey, trap);
+}
+
 const char *tokenTypeToStr(TokenType type)
 {
     switch (type)
@@ -102,14 +119,27 @@ const char *tokenTypeToStr(TokenType type)
     }
 }
 
-void errorExit(ErrorCode code, const char *msg, long line, Token *token)
+/**
+ * @brief Writes error message in format of errorExit to out
+ */
+static void errorPrint(FILE *out, ErrorCode code, const char *msg, long line, Token *token)
 {
-    fprintf(stderr, "Error (code %d) at line %ld: %s\n", code, line, msg);
+    // S tokenem známe přesnou pozici, řádek i sloupec se dopočítají z jeho offsetu
+    SourceLocation location = token ? tokenLocation(token) : (SourceLocation){0, 0};
+    if (location.line > 0)
+    {
+        fprintf(out, "Error (code %d) at line %d, column %d: %s\n", code, location.line,
+                location.column, msg);
+    }
+    else
+    {
+        fprintf(out, "Error (code %d) at line %ld: %s\n", code, line, msg);
+    }
 
     if (token)
     {
         const char *valueStr = "NULL";
-        static char buffer[64];
+        char buffer[64];
 
         if (token->value)
         {
@@ -134,10 +164,47 @@ void errorExit(ErrorCode code, const char *msg, long line, Token *token)
             }
         }
 
-        fprintf(stderr, "\tToken Type: %s\n", tokenTypeToStr(token->type));
-        fprintf(stderr, "\tToken Value: %s\n", valueStr);
+        fprintf(out, "\tToken Type: %s\n", tokenTypeToStr(token->type));
+        fprintf(out, "\tToken Value: %s\n", valueStr);
     }
+}
 
+/**
+ * @brief Hands error over to trap of calling thread, returns when the thread has no trap
+ */
+static void errorTrapRaise(ErrorCode code, const char *msg, long line, Token *token)
+{
+    // Vlákno s pastí chybu jen zaznamená, vypíše ji až hlavní vlákno (nebo do logu pasti)
+    pthread_once(&trapKeyOnce, trapKeyCreate);
+    ErrorTrap *trap = pthread_getspecific(trapKey);
+    if (trap)
+    {
+        trap->code = code;
+        trap->msg = msg;
+        trap->line = line;
+        trap->token = token;
+        longjmp(trap->jump, 1);
+    }
+}
+
+/**
+ * @brief Where message of error goes, stderr without trap, log of trap (NULL = nowhere)
+ */
+static FILE *errorTrapLog(void)
+{
+    pthread_once(&trapKeyOnce, trapKeyCreate);
+    ErrorTrap *trap = pthread_getspecific(trapKey);
+    return trap ? trap->log : stderr;
+}
+
+void errorExit(ErrorCode code, const char *msg, long line, Token *token)
+{
+    FILE *log = errorTrapLog();
+    if (log)
+    {
+        errorPrint(log, code, msg, line, token);
+    }
+    errorTrapRaise(code, msg, line, token);
     exit(code);
 }
 
@@ -146,7 +213,7 @@ void syntaxError(Token *got, TokenType expected)
     const char *expectedStr = tokenTypeToStr(expected);
     const char *gotStr = tokenTypeToStr(got->type);
     const char *gotVal = "NULL";
-    static char buffer[64];
+    char buffer[64];
 
     if (got->value)
     {
@@ -171,8 +238,13 @@ void syntaxError(Token *got, TokenType expected)
         }
     }
 
-    fprintf(stderr, "Syntax error at line %d: expected %s but got %s \"%s\"\n", got->line,
-            expectedStr, gotStr, gotVal);
-
+    FILE *log = errorTrapLog();
+    if (log)
+    {
+        SourceLocation location = tokenLocation(got);
+        fprintf(log, "Syntax error at line %d, column %d: expected %s but got %s \"%s\"\n",
+                location.line, location.column, expectedStr, gotStr, gotVal);
+    }
+    errorTrapRaise(SYNTAX_ERROR, "Syntax error", 0, got);
     exit(SYNTAX_ERROR);
 }
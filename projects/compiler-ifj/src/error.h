@@ -10,6 +10,7 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <setjmp.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -38,4 +39,18 @@ void errorExit(ErrorCode code, const char *msg, long line, Token *token);
 // Print syntax error like "expected xxx but got yyy"
 void syntaxError(Token *got, TokenType expected);
 
+// Error caught by errorExit of a worker thread instead of exiting the process
+typedef struct
+{
+    jmp_buf jump;  // errorExit longjmps here with value 1
+    ErrorCode code;
+    const char *msg;
+    long line;
+    Token *token;
+    FILE *log;  // message is written here like to stderr, NULL = only recorded
+} ErrorTrap;
+
+// Catch errors of calling thread in trap, NULL restores exiting
+void errorTrapSet(ErrorTrap *trap);
+
 #endif
@@ -0,0 +1,210 @@
+/**
+ * @file gencache.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief On-disk cache of IFJcode25 generated for single functions
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "gencache.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "hash.h"
+#include "utils.h"
+
+#define GENCACHE_SUFFIX ".ifjc"
+
+void genCacheInit(GenCache *cache, const char *dir, const char *source, size_t length)
+{
+    cache->dir = dir;
+    cache->source = source;
+    cache->length = length;
+    cache->hits = 0;
+    cache->misses = 0;
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to create cache directory", 0, NULL);
+    }
+}
+
+/**
+ * @brief Add binding of symbol and inferred type of one node to hash
+ */
+static uint64_t hashNodeBindings(uint64_t hash, AstNode *node)
+{
+    // Typy z inferProgram závisí i na volajících, kód operátorů podle nich
+    hash = hashInt(hash, (uint64_t)node->expressionType);
+
+    if (node->symbol)
+    {
+        hash = hashInt(hash, (uint64_t)node->symbol->kind);
+        hash = hashInt(hash, (uint64_t)node->symbol->storage);
+        hash = hashInt(hash, (uint64_t)node->symbol->numOfParams);
+        hash = hashString(hash, node->symbol->frameName);
+    }
+    return hash;
+}
+
+/**
+ * @brief Add bindings of all symbols and inferred types of all nodes in subtree to hash
+ */
+static uint64_t hashBindings(uint64_t hash, AstNode *node)
+{
+    if (!node) return hash;
+
+    switch (node->type)
+    {
+        case AST_LITERAL:
+        case AST_TYPE:
+        case AST_IDENTIFIER:
+            return hashNodeBindings(hash, node);
+
+        case AST_CLASS_DEC:
+        case AST_BLOCK:
+        case AST_PARAMS:
+        {
+            hash = hashNodeBindings(hash, node);
+            NodeVec *nodes = &((AstN *)node->children)->nodes;
+            for (long i = 0; i < nodes->count; i++) hash = hashBindings(hash, nodes->items[i]);
+            return hash;
+        }
+
+        case AST_EXPRESSION:
+        {
+            // Stejné pořadí jako rekurze, levá větev řetězce operátorů se prochází cyklem
+            NodeVec spine;
+            nodeVecInit(&spine);
+            astLeftSpine(node, &spine);
+            for (long i = 0; i < spine.count; i++) hash = hashNodeBindings(hash, spine.items[i]);
+            hash = hashBindings(hash, ((AstBin *)spine.items[spine.count - 1]->children)->left);
+            for (long i = spine.count - 1; i >= 0; i--)
+                hash = hashBindings(hash, ((AstBin *)spine.items[i]->children)->right);
+            nodeVecDispose(&spine);
+            return hash;
+        }
+
+        default:
+        {
+            hash = hashNodeBindings(hash, node);
+            AstBin *children = node->children;
+            if (!children) return hash;
+            hash = hashBindings(hash, children->left);
+            return hashBindings(hash, children->right);
+        }
+    }
+}
+
+uint64_t genCacheFunctionKey(const GenCache *cache, AstNode *fun)
+{
+    uint64_t hash = hashInt(HASH_SEED, GENCACHE_VERSION);
+    hash = hashInt(hash, (uint64_t)fun->type);
+
+    // Rozsah funkce začíná jejím jménem a končí zavírací '}' těla
+    uint32_t start = fun->token.offset;
+    uint32_t end = fun->spanEnd;
+    if (end > start && end <= cache->length)
+    {
+        hash = hashBytes(hash, cache->source + start, end - start);
+    }
+
+    return hashBindings(hash, fun);
+}
+
+/**
+ * @brief Path of cached key, caller frees
+ */
+static char *genCachePath(const GenCache *cache, uint64_t key, const char *suffix)
+{
+    size_t size = strlen(cache->dir) + strlen(suffix) + 32;
+    char *path = malloc(size);
+    if (!path)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate cache path", 0, NULL);
+    }
+    snprintf(path, size, "%s/%016llx%s", cache->dir, (unsigned long long)key, suffix);
+    return path;
+}
+
+bool genCacheEmit(GenCache *cache, uint64_t key, FILE *out)
+{
+    char *path = genCachePath(cache, key, GENCACHE_SUFFIX);
+    FILE *file = fopen(path, "rb");
+    free(path);
+    if (!file) return false;
+
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        fwrite(buffer, 1, read, out);
+    }
+    fclose(file);
+
+    cache->hits++;
+    return true;
+}
+
+void genCacheStore(GenCache *cache, uint64_t key, const char *code, size_t length)
+{
+    cache->misses++;
+
+    // Zápis do dočasného souboru a přejmenování, souběžný překlad nikdy nečte půlku záznamu
+    char tempSuffix[32];
+    snprintf(tempSuffix, sizeof(tempSuffix), ".%ld.tmp", (long)getpid());
+    char *tempPath = genCachePath(cache, key, tempSuffix);
+    char *path = genCachePath(cache, key, GENCACHE_SUFFIX);
+
+    FILE *file = fopen(tempPath, "wb");
+    if (file)
+    {
+        bool written = fwrite(code, 1, length, file) == length;
+        if (fclose(file) == 0 && written)
+        {
+            if (rename(tempPath, path) != 0) remove(tempPath);
+        }
+        else
+        {
+            remove(tempPath);
+        }
+    }
+
+    free(tempPath);
+    free(path);
+}
+
+void genCaptureBegin(GenCapture *capture)
+{
+    capture->data = NULL;
+    capture->length = 0;
+    capture->stream = open_memstream(&capture->data, &capture->length);
+    if (!capture->stream)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to open memory stream", 0, NULL);
+    }
+    capture->previous = emitGetOutput();
+    emitSetOutput(capture->stream);
+}
+
+void genCaptureEnd(GenCapture *capture)
+{
+    emitSetOutput(capture->previous);
+    if (fclose(capture->stream) != 0)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to capture generated code", 0, NULL);
+    }
+    capture->stream = NULL;
+}
+
+void genCaptureDispose(GenCapture *capture)
+{
+    free(capture->data);
+    capture->data = NULL;
+    capture->length = 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file gencache.h
+ * @author Samuel Vajda (xvajdas00)
+ * @brief On-disk cache of IFJcode25 generated for single functions
+ *
+ * Key of a function is hash of its source text together with bindings of all symbols it
+ * refers to (kind, storage and operand name), so a function is regenerated when its text
+ * changes or when anything it calls or reads changes signature. Unchanged functions are
+ * copied from the cache instead of being generated again.
+ */
+
+#ifndef GENCACHE_H
+#define GENCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "parser.h"
+
+#define GENCACHE_VERSION 2  // bump whenever generated code of a function changes
+
+typedef struct
+{
+    const char *dir;     // Directory with cached functions, one file per key
+    const char *source;  // Whole source text, spans of functions point into it
+    size_t length;       // Length of source
+    int hits;            // Functions copied from cache
+    int misses;          // Functions generated again
+} GenCache;
+
+/**
+ * @brief Output of code generator redirected to memory
+ */
+typedef struct
+{
+    FILE *stream;    // Memory stream receiving emitted code
+    char *data;      // Captured code, valid after genCaptureEnd
+    size_t length;   // Length of data
+    FILE *previous;  // Output active before capture started
+} GenCapture;
+
+/**
+ * @brief Initialize cache in directory dir, the directory is created when missing
+ *
+ * @param cache cache to initialize
+ * @param dir cache directory
+ * @param source source text the AST was parsed from
+ * @param length length of source
+ */
+void genCacheInit(GenCache *cache, const char *dir, const char *source, size_t length);
+
+/**
+ * @brief Key of function, getter or setter node
+ *
+ * @param cache initialized cache
+ * @param fun AST_FUN_DEC, AST_FUN_GET or AST_FUN_SET node after inferProgram
+ * @return uint64_t key
+ */
+uint64_t genCacheFunctionKey(const GenCache *cache, AstNode *fun);
+
+/**
+ * @brief Copy cached code of key to out
+ *
+ * @param cache initialized cache
+ * @param key key from genCacheFunctionKey
+ * @param out output stream
+ * @return true on hit, false when key is not cached (nothing is written)
+ */
+bool genCacheEmit(GenCache *cache, uint64_t key, FILE *out);
+
+/**
+ * @brief Store generated code of key, failures only leave the key uncached
+ *
+ * @param cache initialized cache
+ * @param key key from genCacheFunctionKey
+ * @param code generated code
+ * @param length length of code
+ */
+void genCacheStore(GenCache *cache, uint64_t key, const char *code, size_t length);
+
+/**
+ * @brief Redirect emit functions to memory
+ *
+ * @param capture capture to start
+ */
+void genCaptureBegin(GenCapture *capture);
+
+/**
+ * @brief Stop capture and restore previous output, captured code is in capture->data
+ *
+ * @param capture started capture
+ */
+void genCaptureEnd(GenCapture *capture);
+
+/**
+ * @brief Free captured code
+ *
+ * @param capture finished capture
+ */
+void genCaptureDispose(GenCapture *capture);
+
+#endif  // GENCACHE_H
@@ -0,0 +1,134 @@
+/**
+ * @file hash.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief 64-bit FNV-1a and XXH64 hashes of byte ranges, used as keys of cached compiler outputs
+ */
+
+#include "hash.h"
+
+#include <string.h>
+
+#define HASH_PRIME 0x100000001b3ULL  // FNV-1a prime
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t length)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+#define XXH_PRIME1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME3 0x165667B19E3779F9ULL
+#define XXH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME5 0x27D4EB2F165667C5ULL
+
+static uint64_t xxhRotate(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Little-endian čtení, výsledek nezávisí na endianitě stroje (s -O2 jediná instrukce)
+static uint64_t xxhRead64(const unsigned char *p)
+{
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+           (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 |
+           (uint64_t)p[7] << 56;
+}
+
+static uint64_t xxhRead32(const unsigned char *p)
+{
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24;
+}
+
+static uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME2;
+    return xxhRotate(acc, 31) * XXH_PRIME1;
+}
+
+static uint64_t xxhMerge(uint64_t hash, uint64_t acc)
+{
+    hash ^= xxhRound(0, acc);
+    return hash * XXH_PRIME1 + XXH_PRIME4;
+}
+
+uint64_t hashBlock(uint64_t hash, const void *data, size_t length)
+{
+    const unsigned char *p = data;
+    const unsigned char *end = p + length;
+    uint64_t seed = hash;
+
+    if (length >= 32)
+    {
+        // Čtyři nezávislé akumulátory, procesor je počítá souběžně
+        uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+        uint64_t v2 = seed + XXH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME1;
+        do
+        {
+            v1 = xxhRound(v1, xxhRead64(p));
+            v2 = xxhRound(v2, xxhRead64(p + 8));
+            v3 = xxhRound(v3, xxhRead64(p + 16));
+            v4 = xxhRound(v4, xxhRead64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+
+        hash = xxhRotate(v1, 1) + xxhRotate(v2, 7) + xxhRotate(v3, 12) + xxhRotate(v4, 18);
+        hash = xxhMerge(hash, v1);
+        hash = xxhMerge(hash, v2);
+        hash = xxhMerge(hash, v3);
+        hash = xxhMerge(hash, v4);
+    }
+    else
+    {
+        hash = seed + XXH_PRIME5;
+    }
+    hash += (uint64_t)length;
+
+    for (; end - p >= 8; p += 8)
+    {
+        hash ^= xxhRound(0, xxhRead64(p));
+        hash = xxhRotate(hash, 27) * XXH_PRIME1 + XXH_PRIME4;
+    }
+    if (end - p >= 4)
+    {
+        hash ^= xxhRead32(p) * XXH_PRIME1;
+        hash = xxhRotate(hash, 23) * XXH_PRIME2 + XXH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++)
+    {
+        hash ^= *p * XXH_PRIME5;
+        hash = xxhRotate(hash, 11) * XXH_PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t hashString(uint64_t hash, const char *str)
+{
+    if (!str) str = "";
+    return hashBytes(hash, str, strlen(str) + 1);
+}
+
+uint64_t hashInt(uint64_t hash, uint64_t value)
+{
+    // Bajty po jednom, výsledek nezávisí na endianitě stroje
+    for (int i = 0; i < 8; i++)
+    {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file hash.h
+ * @author Samuel Vajda (xvajdas00)
+ * @brief 64-bit FNV-1a hash of byte ranges, used as key of cached compiler outputs
+ *
+ * hashBlock is XXH64, meant for long inputs such as whole sources where byte-at-a-time FNV-1a
+ * would be a measurable part of a cache hit.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HASH_SEED 0xcbf29ce484222325ULL  // FNV-1a offset basis
+
+/**
+ * @brief Continue hash with bytes of data
+ *
+ * @param hash hash so far (HASH_SEED for empty input)
+ * @param data bytes to add
+ * @param length number of bytes
+ * @return uint64_t new hash
+ */
+uint64_t hashBytes(uint64_t hash, const void *data, size_t length);
+
+/**
+ * @brief Continue hash with bytes of data using XXH64 seeded by hash so far
+ *
+ * Several times faster than hashBytes on long data, gives different values than hashBytes.
+ *
+ * @param hash hash so far (seed)
+ * @param data bytes to add
+ * @param length number of bytes
+ * @return uint64_t new hash
+ */
+uint64_t hashBlock(uint64_t hash, const void *data, size_t length);
+
+/**
+ * @brief Continue hash with string including its terminating zero, so that following
+ *        parts cannot be confused with the string
+ *
+ * @param hash hash so far
+ * @param str string or NULL (hashed as empty string)
+ * @return uint64_t new hash
+ */
+uint64_t hashString(uint64_t hash, const char *str);
+
+/**
+ * @brief Continue hash with integer value
+ *
+ * @param hash hash so far
+ * @param value value to add
+ * @return uint64_t new hash
+ */
+uint64_t hashInt(uint64_t hash, uint64_t value);
+
+#endif  // HASH_H
@@ -0,0 +1,1017 @@
+/**
+ * @file infer.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Interprocedural inference of parameter, return and operand types
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include "infer.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+
+#define INFER_MAX_VISITS 16       // cap of visits per function on average
+#define INFER_MAX_LOOP_PASSES 64  // cap of passes over body of one while loop
+#define INFER_TYPE_ANY \
+    (TYPE_UNKNOWN | TYPE_INT | TYPE_STRING | TYPE_FLOAT | TYPE_NULL | TYPE_BOOL)
+
+/**
+ * @brief Growable list of function indices
+ *
+ */
+typedef struct
+{
+    long* items;
+    long count;
+    long capacity;
+} InferList;
+
+/**
+ * @brief Function of program, node of call graph
+ *
+ */
+typedef struct
+{
+    AstNode* node;      // AST_FUN_DEC, AST_FUN_GET or AST_FUN_SET
+    Symbol* symbol;     // function symbol, expressionType is its return type
+    int slotCount;      // number of locals in function frame
+    InferList callees;  // functions called from body
+    InferList callers;  // functions calling this one
+    long index;         // Tarjan's discovery index, -1 = not visited
+    long lowLink;
+    bool onStack;
+    bool queued;
+} InferFunction;
+
+/**
+ * @brief Function reading or writing global variable
+ *
+ */
+typedef struct
+{
+    Symbol* symbol;  // global variable
+    long function;   // index of function
+} InferAccess;
+
+/**
+ * @brief Global variable of program, its type is the same in every function
+ *
+ */
+typedef struct
+{
+    Symbol* symbol;
+    ExprType type;  // union of types of all assignments, nil before the first one
+    long first;     // accesses of variable are accesses[first .. end - 1]
+    long end;
+} InferGlobal;
+
+/**
+ * @brief State of inference pass
+ *
+ */
+typedef struct
+{
+    InferFunction* functions;
+    long count;
+    InferFunction** bySymbol;  // functions sorted by symbol address
+    InferAccess* accesses;     // accesses of global variables sorted by symbol address
+    long accessCount;
+    long accessCapacity;
+    InferGlobal* globals;  // global variables sorted by symbol address
+    long globalCount;
+    long* queue;               // ring of function indices, every function at most once
+    long queueHead;
+    long queueCount;
+    long* stack;  // Tarjan's stack
+    long stackTop;
+    long nextIndex;
+    long* order;  // functions in SCC order, callees first
+    long orderCount;
+    int slotCount;  // slots of function being analysed
+    bool frozen;    // visit cap reached, types of functions and globals are final
+} Inferer;
+
+static void* inferAlloc(size_t size)
+{
+    void* memory = calloc(1, size ? size : 1);
+    if (!memory) errorExit(INTERNAL_ERROR, "Failed to allocate type inference", 0, NULL);
+    return memory;
+}
+
+static void inferListPush(InferList* list, long item)
+{
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->items = realloc(list->items, sizeof(long) * list->capacity);
+        if (!list->items) errorExit(INTERNAL_ERROR, "Failed to allocate type inference", 0, NULL);
+    }
+    list->items[list->count++] = item;
+}
+
+static int inferCompareSymbol(const void* a, const void* b)
+{
+    uintptr_t left = (uintptr_t)(*(InferFunction* const*)a)->symbol;
+    uintptr_t right = (uintptr_t)(*(InferFunction* const*)b)->symbol;
+    return (left > right) - (left < right);
+}
+
+/**
+ * @brief Function declared in program with given symbol, NULL for builtins and variables
+ */
+static InferFunction* inferFind(Inferer* inf, Symbol* symbol)
+{
+    if (!symbol) return NULL;
+
+    InferFunction key = {.symbol = symbol};
+    InferFunction* keyPtr = &key;
+    InferFunction** found =
+        bsearch(&keyPtr, inf->bySymbol, inf->count, sizeof(InferFunction*), inferCompareSymbol);
+    return found ? *found : NULL;
+}
+
+static int inferCompareAccess(const void* a, const void* b)
+{
+    uintptr_t left = (uintptr_t)((const InferAccess*)a)->symbol;
+    uintptr_t right = (uintptr_t)((const InferAccess*)b)->symbol;
+    return (left > right) - (left < right);
+}
+
+static int inferCompareGlobal(const void* a, const void* b)
+{
+    uintptr_t left = (uintptr_t)((const InferGlobal*)a)->symbol;
+    uintptr_t right = (uintptr_t)((const InferGlobal*)b)->symbol;
+    return (left > right) - (left < right);
+}
+
+/**
+ * @brief Global variable with given symbol, NULL for locals and functions
+ */
+static InferGlobal* inferFindGlobal(Inferer* inf, Symbol* symbol)
+{
+    if (!symbol || symbol->storage != STORAGE_GLOBAL || inf->globalCount == 0) return NULL;
+
+    InferGlobal key = {.symbol = symbol};
+    return bsearch(&key, inf->globals, inf->globalCount, sizeof(InferGlobal), inferCompareGlobal);
+}
+
+static void inferQueue(Inferer* inf, InferFunction* fun)
+{
+    if (fun->queued) return;
+    fun->queued = true;
+    inf->queue[(inf->queueHead + inf->queueCount) % inf->count] = fun - inf->functions;
+    inf->queueCount++;
+}
+
+/* --------------------------------------------------------- */
+/*  CALL GRAPH                                               */
+/* --------------------------------------------------------- */
+
+/**
+ * @brief Records that function reads or writes global variable
+ */
+static void inferAccessPush(Inferer* inf, Symbol* symbol, long function)
+{
+    // Opakovaný přístup téže funkce ke stejné proměnné stačí zapsat jednou
+    InferAccess* last = inf->accessCount ? &inf->accesses[inf->accessCount - 1] : NULL;
+    if (last && last->symbol == symbol && last->function == function) return;
+
+    if (inf->accessCount == inf->accessCapacity)
+    {
+        inf->accessCapacity = inf->accessCapacity ? inf->accessCapacity * 2 : 16;
+        inf->accesses = realloc(inf->accesses, sizeof(InferAccess) * inf->accessCapacity);
+        if (!inf->accesses) errorExit(INTERNAL_ERROR, "Failed to allocate type inference", 0, NULL);
+    }
+    inf->accesses[inf->accessCount++] = (InferAccess){symbol, function};
+}
+
+/**
+ * @brief Collects callees and number of frame slots of function body
+ */
+static void inferCollect(Inferer* inf, InferFunction* fun, AstNode* node)
+{
+    if (!node) return;
+
+    Symbol* symbol = node->symbol;
+    if (symbol && symbol->storage == STORAGE_LOCAL && symbol->slot >= fun->slotCount)
+        fun->slotCount = symbol->slot + 1;
+    if (symbol && symbol->storage == STORAGE_GLOBAL && node->type == AST_IDENTIFIER)
+        inferAccessPush(inf, symbol, fun - inf->functions);
+
+    // Volání, čtení getteru i zápis do setteru jsou hrany grafu volání
+    InferFunction* callee = node->type == AST_RETURN ? NULL : inferFind(inf, symbol);
+    if (callee)
+    {
+        long calleeIndex = callee - inf->functions;
+        long callerIndex = fun - inf->functions;
+        inferListPush(&fun->callees, calleeIndex);
+        inferListPush(&callee->callers, callerIndex);
+    }
+
+    switch (node->type)
+    {
+        case AST_LITERAL:
+        case AST_TYPE:
+        case AST_IDENTIFIER:
+        case AST_VAR_DEC:
+            return;
+
+        case AST_CLASS_DEC:
+        case AST_BLOCK:
+        case AST_PARAMS:
+        {
+            NodeVec* nodes = &((AstN*)node->children)->nodes;
+            for (long i = 0; i < nodes->count; i++) inferCollect(inf, fun, nodes->items[i]);
+            return;
+        }
+
+        case AST_EXPRESSION:
+        {
+            // Operátory nemají symbol, levá větev řetězce operátorů se prochází cyklem
+            NodeVec spine;
+            nodeVecInit(&spine);
+            astLeftSpine(node, &spine);
+            inferCollect(inf, fun, ((AstBin*)spine.items[spine.count - 1]->children)->left);
+            for (long i = spine.count - 1; i >= 0; i--)
+                inferCollect(inf, fun, ((AstBin*)spine.items[i]->children)->right);
+            nodeVecDispose(&spine);
+            return;
+        }
+
+        default:
+        {
+            AstBin* children = node->children;
+            if (!children) return;
+            inferCollect(inf, fun, children->left);
+            inferCollect(inf, fun, children->right);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Groups collected accesses by variable, every global starts as nil
+ */
+static void inferGlobalsBuild(Inferer* inf)
+{
+    qsort(inf->accesses, inf->accessCount, sizeof(InferAccess), inferCompareAccess);
+    inf->globals = inferAlloc(sizeof(InferGlobal) * inf->accessCount);
+    for (long i = 0; i < inf->accessCount; i++)
+    {
+        if (i == 0 || inf->accesses[i].symbol != inf->accesses[i - 1].symbol)
+        {
+            InferGlobal* global = &inf->globals[inf->globalCount++];
+            global->symbol = inf->accesses[i].symbol;
+            global->type = TYPE_NULL;
+            global->first = i;
+        }
+        inf->globals[inf->globalCount - 1].end = i + 1;
+    }
+}
+
+/**
+ * @brief Joins assigned type into global variable, functions accessing it are queued again
+ */
+static void inferSetGlobal(Inferer* inf, InferGlobal* global, ExprType type)
+{
+    if (inf->frozen || (global->type | type) == global->type) return;
+
+    global->type |= type;
+    for (long i = global->first; i < global->end; i++)
+        inferQueue(inf, &inf->functions[inf->accesses[i].function]);
+}
+
+/**
+ * @brief Tarjan's algorithm, SCCs are appended to order callees first
+ */
+static void inferStrongConnect(Inferer* inf, long v)
+{
+    InferFunction* fun = &inf->functions[v];
+    fun->index = fun->lowLink = inf->nextIndex++;
+    inf->stack[inf->stackTop++] = v;
+    fun->onStack = true;
+
+    for (long i = 0; i < fun->callees.count; i++)
+    {
+        long w = fun->callees.items[i];
+        InferFunction* callee = &inf->functions[w];
+        if (callee->index < 0)
+        {
+            inferStrongConnect(inf, w);
+            if (callee->lowLink < fun->lowLink) fun->lowLink = callee->lowLink;
+        }
+        else if (callee->onStack && callee->index < fun->lowLink)
+        {
+            fun->lowLink = callee->index;
+        }
+    }
+
+    if (fun->lowLink == fun->index)
+    {
+        long w;
+        do
+        {
+            w = inf->stack[--inf->stackTop];
+            inf->functions[w].onStack = false;
+            inf->order[inf->orderCount++] = w;
+        } while (w != v);
+    }
+}
+
+/* --------------------------------------------------------- */
+/*  TYPES OF EXPRESSIONS                                     */
+/* --------------------------------------------------------- */
+
+/**
+ * @brief Result types of binary operator as generated code computes them
+ *
+ * Operand type 0 means no value reaches the operator yet, so the result has none either.
+ */
+static ExprType inferBinaryType(TokenType op, ExprType left, ExprType right)
+{
+    if (!left || !right) return 0;
+
+    ExprType numbers = TYPE_INT | TYPE_FLOAT;
+    switch (op)
+    {
+        case PLUS:
+        case MINUS:
+        case MULTIPLY:
+        case DIVIDE:
+        {
+            if ((left | right) & TYPE_UNKNOWN) return TYPE_UNKNOWN;
+
+            ExprType result = 0;
+            if ((left & numbers) && (right & numbers))
+            {
+                // Celá čísla zůstávají celá, jinak se operandy převedou na float
+                if (op == DIVIDE)
+                    result |= TYPE_FLOAT;
+                else
+                {
+                    if ((left & TYPE_INT) && (right & TYPE_INT)) result |= TYPE_INT;
+                    if ((left & TYPE_FLOAT) || (right & TYPE_FLOAT)) result |= TYPE_FLOAT;
+                }
+            }
+            if (op == PLUS && (left & TYPE_STRING) && (right & TYPE_STRING)) result |= TYPE_STRING;
+            return result;
+        }
+
+        case LOGICAL_AND:
+        case LOGICAL_OR:
+            return TYPE_BOOL | right;  // výsledkem je false/true nebo hodnota pravého operandu
+
+        case IS_EQUAL:
+        case IS_NOT_EQUAL:
+        case IS_BIGGER:
+        case IS_BIGGER_OR_EQUAL:
+        case IS_SMALLER:
+        case IS_SMALLER_OR_EQUAL:
+        case KW_IS:
+            return TYPE_BOOL;
+
+        default:
+            return TYPE_UNKNOWN;
+    }
+}
+
+/**
+ * @brief Slot of local variable in state, -1 for globals, getters and setters
+ */
+static int inferSlot(Inferer* inf, Symbol* symbol)
+{
+    if (!symbol || symbol->storage != STORAGE_LOCAL) return -1;
+    return symbol->slot < inf->slotCount ? symbol->slot : -1;
+}
+
+/* --------------------------------------------------------- */
+/*  NARROWING                                                */
+/* --------------------------------------------------------- */
+
+static ExprType* inferCopy(Inferer* inf, const ExprType* state)
+{
+    ExprType* copy = inferAlloc(sizeof(ExprType) * inf->slotCount);
+    memcpy(copy, state, sizeof(ExprType) * inf->slotCount);
+    return copy;
+}
+
+/**
+ * @brief Types a value can have after passing test `is <type>`, TYPE_ANY for unknown test
+ */
+static ExprType inferTestedType(AstNode* typeNode)
+{
+    switch (typeNode->token.type)
+    {
+        case KW_TYPE_NUM:
+            return TYPE_INT | TYPE_FLOAT;
+        case KW_TYPE_STRING:
+            return TYPE_STRING;
+        case KW_TYPE_BOOL:
+            return TYPE_BOOL;
+        case KW_TYPE_NULL:
+        case KW_VAL_NULL:
+            return TYPE_NULL;
+        default:
+            return INFER_TYPE_ANY;
+    }
+}
+
+/**
+ * @brief Intersection of type set with allowed types, unknown type becomes the allowed ones
+ */
+static ExprType inferRestrict(ExprType type, ExprType allowed)
+{
+    if ((type & TYPE_UNKNOWN) && !(allowed & TYPE_UNKNOWN)) return allowed;
+    return type & allowed;
+}
+
+static bool inferIsNull(AstNode* node)
+{
+    return node->type == AST_LITERAL && node->token.type == KW_VAL_NULL;
+}
+
+/**
+ * @brief Restricts local variables in state to types for which condition holds
+ *
+ * Understands `x is Type`, `x == null`, `x != null` (null on either side) and their
+ * conjunctions with &&, other conditions leave state unchanged.
+ */
+static void inferNarrow(Inferer* inf, AstNode* cond, ExprType* state)
+{
+    if (!cond || (cond->type != AST_EXPRESSION && cond->type != AST_OPERATOR)) return;
+
+    AstBin* children = cond->children;
+    if (!children || !children->left || !children->right) return;
+
+    AstNode* target;
+    ExprType allowed;
+    switch (cond->token.type)
+    {
+        case LOGICAL_AND:
+        {
+            // Řetězec "a && b && c" je hluboký vlevo, prochází se cyklem zleva doprava
+            NodeVec chain;
+            nodeVecInit(&chain);
+            AstNode* left = cond;
+            while (astIsBinaryExpression(left) && left->token.type == LOGICAL_AND)
+            {
+                nodeVecPush(&chain, left);
+                left = ((AstBin*)left->children)->left;
+            }
+            inferNarrow(inf, left, state);
+            for (long i = chain.count - 1; i >= 0; i--)
+                inferNarrow(inf, ((AstBin*)chain.items[i]->children)->right, state);
+            nodeVecDispose(&chain);
+            return;
+        }
+
+        case KW_IS:
+            target = children->left;
+            allowed = inferTestedType(children->right);
+            break;
+
+        case IS_EQUAL:
+        case IS_NOT_EQUAL:
+            if (inferIsNull(children->right))
+                target = children->left;
+            else if (inferIsNull(children->left))
+                target = children->right;
+            else
+                return;
+            allowed = cond->token.type == IS_EQUAL ? TYPE_NULL : INFER_TYPE_ANY & ~TYPE_NULL;
+            break;
+
+        default:
+            return;
+    }
+
+    // Globální proměnné může mezi testem a použitím změnit volaná funkce
+    int slot = target->type == AST_IDENTIFIER ? inferSlot(inf, target->symbol) : -1;
+    if (slot >= 0) state[slot] = inferRestrict(state[slot], allowed);
+}
+
+static ExprType inferExpr(Inferer* inf, AstNode* node, ExprType* state);
+
+/**
+ * @brief Types arguments of call, joins them into parameters of callee
+ *
+ * @return ExprType return type of callee
+ */
+static ExprType inferCall(Inferer* inf, AstNode* node, ExprType* state)
+{
+    AstNode* argsNode = ((AstBin*)node->children)->right;
+    NodeVec* args = argsNode ? &((AstN*)argsNode->children)->nodes : NULL;
+    InferFunction* callee = inferFind(inf, node->symbol);
+
+    for (long i = 0; args && i < args->count; i++)
+    {
+        ExprType type = inferExpr(inf, args->items[i], state);
+        if (!callee || inf->frozen || i >= callee->symbol->numOfParams) continue;
+
+        ExprType* param = &callee->symbol->paramTypes[i];
+        if ((*param | type) != *param)
+        {
+            *param |= type;
+            inferQueue(inf, callee);
+        }
+    }
+
+    return node->symbol ? node->symbol->expressionType : TYPE_UNKNOWN;
+}
+
+static ExprType inferLiteral(AstNode* node)
+{
+    switch (node->token.type)
+    {
+        case INT_LITERAL:
+            return TYPE_INT;
+        case FLOAT_LITERAL:
+            return TYPE_FLOAT;
+        case STRING_LITERAL:
+        case MULTILINE_STRING_LITERAL:
+            return TYPE_STRING;
+        case KW_VAL_NULL:
+            return TYPE_NULL;
+        case KW_VAL_TRUE:
+        case KW_VAL_FALSE:
+            return TYPE_BOOL;
+        default:
+            return TYPE_UNKNOWN;
+    }
+}
+
+/**
+ * @brief Types binary operator and operators nested in its left operand
+ *
+ * @return ExprType type of node, types of the nested operators are stored into them
+ */
+static ExprType inferBinary(Inferer* inf, AstNode* node, ExprType* state)
+{
+    // Levá větev řetězce "a + b + c" je hluboká, prochází se cyklem zdola nahoru
+    NodeVec spine;
+    nodeVecInit(&spine);
+    astLeftSpine(node, &spine);
+
+    AstNode* leaf = ((AstBin*)spine.items[spine.count - 1]->children)->left;
+    ExprType type = inferExpr(inf, leaf, state);
+    ExprType* guarded = NULL;  // stav zúžený levým operandem &&, sdílí ho i && nad ním
+    for (long i = spine.count - 1; i >= 0; i--)
+    {
+        AstNode* op = spine.items[i];
+        AstBin* children = op->children;
+        ExprType right;
+        if (op->token.type == LOGICAL_AND)
+        {
+            // Pravý operand se vyhodnotí jen tehdy, když levý platí
+            if (!guarded)
+            {
+                guarded = inferCopy(inf, state);
+                inferNarrow(inf, children->left, guarded);
+            }
+            right = inferExpr(inf, children->right, guarded);
+
+            // Levý operand && nad ním je celé toto &&, stačí přidat pravý operand
+            if (i > 0 && spine.items[i - 1]->token.type == LOGICAL_AND)
+                inferNarrow(inf, children->right, guarded);
+            else
+            {
+                free(guarded);
+                guarded = NULL;
+            }
+        }
+        else
+        {
+            right = inferExpr(inf, children->right, state);
+        }
+        type = inferBinaryType(op->token.type, type, right);
+        op->expressionType = type;
+    }
+
+    nodeVecDispose(&spine);
+    return type;
+}
+
+/**
+ * @brief Computes type of expression in given state and stores it into node
+ */
+static ExprType inferExpr(Inferer* inf, AstNode* node, ExprType* state)
+{
+    if (!node) return 0;
+
+    ExprType type;
+    switch (node->type)
+    {
+        case AST_LITERAL:
+            type = inferLiteral(node);
+            break;
+
+        case AST_IDENTIFIER:
+        {
+            int slot = inferSlot(inf, node->symbol);
+            InferGlobal* global = inferFindGlobal(inf, node->symbol);
+            if (slot >= 0)
+                type = state[slot];
+            else if (global)
+                type = global->type;  // kterákoli funkce ji mohla změnit, typ je sjednocení
+            else if (node->symbol && node->symbol->kind == SYM_GET)
+                type = node->symbol->expressionType;
+            else
+                type = TYPE_UNKNOWN;
+            break;
+        }
+
+        case AST_TYPE:
+            return 0;
+
+        case AST_EXPRESSION:
+        case AST_OPERATOR:
+        {
+            AstBin* children = node->children;
+            if (!children || (!children->left && !children->right))
+                type = inferLiteral(node);
+            else if (node->token.type == LOGICAL_NOT)
+            {
+                inferExpr(inf, children->right, state);
+                type = TYPE_BOOL;
+            }
+            else
+                type = inferBinary(inf, node, state);
+            break;
+        }
+
+        case AST_FUN_CALL:
+            type = inferCall(inf, node, state);
+            break;
+
+        case AST_IFJ:
+        {
+            AstNode* call = ((AstBin*)node->children)->right;
+            type = inferExpr(inf, call, state);
+
+            // genIfj vrací z floor Int, deklarace vestavěné funkce uvádí Num kvůli sémantice
+            if (call->symbol && strcmp(call->symbol->name, "floor") == 0)
+            {
+                type = TYPE_INT;
+                call->expressionType = type;
+            }
+            break;
+        }
+
+        default:
+            type = TYPE_UNKNOWN;
+            break;
+    }
+
+    node->expressionType = type;
+    return type;
+}
+
+/* --------------------------------------------------------- */
+/*  STATEMENTS                                               */
+/* --------------------------------------------------------- */
+
+/**
+ * @brief dst |= src for every slot
+ * @return true when dst changed
+ */
+static bool inferJoin(Inferer* inf, ExprType* dst, const ExprType* src)
+{
+    bool changed = false;
+    for (int i = 0; i < inf->slotCount; i++)
+    {
+        if ((dst[i] | src[i]) != dst[i])
+        {
+            dst[i] |= src[i];
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+static bool inferStatements(Inferer* inf, NodeVec* list, ExprType* state, ExprType* ret);
+
+/**
+ * @brief Walks statement list of block in given state
+ * @return true when end of block is reachable
+ */
+static bool inferBlock(Inferer* inf, AstNode* block, ExprType* state, ExprType* ret)
+{
+    if (!block || block->type != AST_BLOCK) return true;
+    return inferStatements(inf, &((AstN*)block->children)->nodes, state, ret);
+}
+
+/**
+ * @brief Walks if statement together with following else-if and else statements
+ *
+ * Branches after the first one are entered with join of the state before the if and states
+ * after the previous branches, which is sound however the chain is executed.
+ *
+ * @param first index of AST_IF_STMT in list
+ * @return long index of the last statement of chain
+ */
+static long inferIfChain(Inferer* inf, NodeVec* list, long first, ExprType* state, ExprType* ret,
+                         bool* reachable)
+{
+    ExprType* out = inferCopy(inf, state);
+    bool hasElse = false;
+    bool anyReachable = false;
+
+    long i = first;
+    for (; i < list->count; i++)
+    {
+        AstNode* item = list->items[i];
+        if (i > first && item->type != AST_IF_ELSE_STMT && item->type != AST_ELSE_STMT) break;
+
+        AstBin* children = item->children;
+        ExprType* branch = inferCopy(inf, out);
+        if (item->type == AST_ELSE_STMT)
+            hasElse = true;
+        else
+            inferExpr(inf, children->left, branch);
+
+        // Zužuje se jen tělo if, které vygenerovaný kód vždy chrání testem podmínky
+        if (item->type == AST_IF_STMT) inferNarrow(inf, children->left, branch);
+
+        if (inferBlock(inf, children->right, branch, ret))
+        {
+            inferJoin(inf, out, branch);
+            anyReachable = true;
+        }
+        free(branch);
+
+        if (hasElse)
+        {
+            i++;
+            break;
+        }
+    }
+
+    memcpy(state, out, sizeof(ExprType) * inf->slotCount);
+    free(out);
+    *reachable = anyReachable || !hasElse;
+    return i - 1;
+}
+
+/**
+ * @brief Walks while loop until state at its condition stops changing
+ */
+static void inferWhile(Inferer* inf, AstNode* node, ExprType* state, ExprType* ret)
+{
+    AstBin* children = node->children;
+
+    for (int pass = 0; pass <= INFER_MAX_LOOP_PASSES; pass++)
+    {
+        if (pass == INFER_MAX_LOOP_PASSES)
+        {
+            // Nekonverguje, proměnné smyčky jsou libovolného typu
+            for (int i = 0; i < inf->slotCount; i++)
+                if (state[i]) state[i] = TYPE_UNKNOWN;
+        }
+
+        inferExpr(inf, children->left, state);
+        ExprType* body = inferCopy(inf, state);
+        inferNarrow(inf, children->left, body);
+        bool changed = inferBlock(inf, children->right, body, ret) && inferJoin(inf, state, body);
+        free(body);
+        if (!changed) break;
+    }
+}
+
+static bool inferStatements(Inferer* inf, NodeVec* list, ExprType* state, ExprType* ret)
+{
+    bool reachable = true;
+
+    for (long i = 0; i < list->count && reachable; i++)
+    {
+        AstNode* item = list->items[i];
+        AstBin* children = item->children;
+
+        switch (item->type)
+        {
+            case AST_VAR_DEC:
+            {
+                int slot = inferSlot(inf, item->symbol);
+                if (slot >= 0) state[slot] = TYPE_NULL;
+                break;
+            }
+
+            case AST_VAR_ASSIGN:
+            {
+                ExprType type = inferExpr(inf, children->right, state);
+                AstNode* target = children->left;
+                int slot = inferSlot(inf, target->symbol);
+                InferGlobal* global = inferFindGlobal(inf, target->symbol);
+                InferFunction* setter = inferFind(inf, target->symbol);
+
+                if (slot >= 0)
+                    state[slot] = type;
+                else if (global)
+                    inferSetGlobal(inf, global, type);
+                else if (setter && !inf->frozen && setter->symbol->numOfParams == 1)
+                {
+                    ExprType* param = &setter->symbol->paramTypes[0];
+                    if ((*param | type) != *param)
+                    {
+                        *param |= type;
+                        inferQueue(inf, setter);
+                    }
+                }
+                target->expressionType = type;
+                item->expressionType = type;
+                break;
+            }
+
+            case AST_RETURN:
+                *ret |= inferExpr(inf, children->right, state);
+                reachable = false;
+                break;
+
+            case AST_IF_STMT:
+                i = inferIfChain(inf, list, i, state, ret, &reachable);
+                break;
+
+            case AST_IF_ELSE_STMT:
+            case AST_ELSE_STMT:
+            {
+                // Větev bez předchozího if, prochází se jako podmíněný blok
+                ExprType* branch = inferCopy(inf, state);
+                if (item->type == AST_IF_ELSE_STMT) inferExpr(inf, children->left, branch);
+                if (inferBlock(inf, children->right, branch, ret)) inferJoin(inf, state, branch);
+                free(branch);
+                break;
+            }
+
+            case AST_WHILE:
+                inferWhile(inf, item, state, ret);
+                break;
+
+            case AST_BLOCK:
+                reachable = inferBlock(inf, item, state, ret);
+                break;
+
+            case AST_FUN_CALL:
+            case AST_IFJ:
+                inferExpr(inf, item, state);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return reachable;
+}
+
+/* --------------------------------------------------------- */
+/*  FUNCTIONS                                                */
+/* --------------------------------------------------------- */
+
+/**
+ * @brief Walks body of function with current parameter types and updates its return type
+ */
+static void inferFunction(Inferer* inf, InferFunction* fun)
+{
+    inf->slotCount = fun->slotCount;
+    ExprType* state = inferAlloc(sizeof(ExprType) * fun->slotCount);
+
+    AstBin* children = fun->node->children;
+    NodeVec* params = children->left ? &((AstN*)children->left->children)->nodes : NULL;
+    for (long i = 0; params && i < params->count && i < fun->symbol->numOfParams; i++)
+    {
+        int slot = inferSlot(inf, params->items[i]->symbol);
+        if (slot >= 0) state[slot] = fun->symbol->paramTypes[i];
+    }
+
+    // Funkce bez return na konci vrací nil
+    ExprType ret = 0;
+    if (inferBlock(inf, children->right, state, &ret)) ret |= TYPE_NULL;
+    free(state);
+
+    if (!inf->frozen && ret != fun->symbol->expressionType)
+    {
+        fun->symbol->expressionType = ret;
+        for (long i = 0; i < fun->callers.count; i++)
+            inferQueue(inf, &inf->functions[fun->callers.items[i]]);
+    }
+}
+
+void inferProgram(AstNode* root)
+{
+    if (!root || root->type != AST_CLASS_DEC) return;
+
+    NodeVec* items = &((AstN*)root->children)->nodes;
+    Inferer inf = {0};
+    inf.functions = inferAlloc(sizeof(InferFunction) * items->count);
+    for (long i = 0; i < items->count; i++)
+    {
+        AstNode* item = items->items[i];
+        if (item->symbol && (item->type == AST_FUN_DEC || item->type == AST_FUN_GET ||
+                             item->type == AST_FUN_SET))
+        {
+            InferFunction* fun = &inf.functions[inf.count++];
+            fun->node = item;
+            fun->symbol = item->symbol;
+            fun->index = -1;
+        }
+    }
+    if (inf.count == 0)
+    {
+        free(inf.functions);
+        return;
+    }
+
+    inf.bySymbol = inferAlloc(sizeof(InferFunction*) * inf.count);
+    for (long i = 0; i < inf.count; i++) inf.bySymbol[i] = &inf.functions[i];
+    qsort(inf.bySymbol, inf.count, sizeof(InferFunction*), inferCompareSymbol);
+
+    for (long i = 0; i < inf.count; i++)
+    {
+        inferCollect(&inf, &inf.functions[i], inf.functions[i].node->children
+                                                  ? ((AstBin*)inf.functions[i].node->children)->right
+                                                  : NULL);
+    }
+    inferGlobalsBuild(&inf);
+
+    // Typy se počítají od dna: parametry bez volajících jsou libovolné, ostatní od nuly
+    for (long i = 0; i < inf.count; i++)
+    {
+        Symbol* symbol = inf.functions[i].symbol;
+        ExprType initial = inf.functions[i].callers.count ? 0 : TYPE_UNKNOWN;
+        for (int p = 0; p < symbol->numOfParams; p++) symbol->paramTypes[p] = initial;
+        symbol->expressionType = 0;
+    }
+
+    inf.stack = inferAlloc(sizeof(long) * inf.count);
+    inf.order = inferAlloc(sizeof(long) * inf.count);
+    for (long i = 0; i < inf.count; i++)
+    {
+        if (inf.functions[i].index < 0) inferStrongConnect(&inf, i);
+    }
+
+    inf.queue = inferAlloc(sizeof(long) * inf.count);
+    for (long i = 0; i < inf.orderCount; i++) inferQueue(&inf, &inf.functions[inf.order[i]]);
+
+    long visits = 0;
+    while (inf.queueCount > 0 && visits < inf.count * INFER_MAX_VISITS)
+    {
+        InferFunction* fun = &inf.functions[inf.queue[inf.queueHead]];
+        inf.queueHead = (inf.queueHead + 1) % inf.count;
+        inf.queueCount--;
+        fun->queued = false;
+
+        inferFunction(&inf, fun);
+        visits++;
+    }
+
+    // Nedokonvergovalo, funkce se projdou ještě jednou s libovolnými typy
+    if (inf.queueCount > 0)
+    {
+        for (long i = 0; i < inf.count; i++)
+        {
+            Symbol* symbol = inf.functions[i].symbol;
+            for (int p = 0; p < symbol->numOfParams; p++) symbol->paramTypes[p] = TYPE_UNKNOWN;
+            symbol->expressionType = TYPE_UNKNOWN;
+        }
+        for (long i = 0; i < inf.globalCount; i++) inf.globals[i].type = TYPE_UNKNOWN;
+        inf.frozen = true;
+        for (long i = 0; i < inf.count; i++) inferFunction(&inf, &inf.functions[i]);
+    }
+
+    // Funkce, která se nikdy nevrátí nebo není volána, nemá známý typ
+    for (long i = 0; i < inf.count; i++)
+    {
+        Symbol* symbol = inf.functions[i].symbol;
+        if (!symbol->expressionType) symbol->expressionType = TYPE_UNKNOWN;
+        for (int p = 0; p < symbol->numOfParams; p++)
+            if (!symbol->paramTypes[p]) symbol->paramTypes[p] = TYPE_UNKNOWN;
+
+        AstBin* children = inf.functions[i].node->children;
+        NodeVec* params = children->left ? &((AstN*)children->left->children)->nodes : NULL;
+        for (long p = 0; params && p < params->count && p < symbol->numOfParams; p++)
+        {
+            if (params->items[p]->symbol)
+                params->items[p]->symbol->expressionType = symbol->paramTypes[p];
+        }
+
+        free(inf.functions[i].callees.items);
+        free(inf.functions[i].callers.items);
+    }
+
+    for (long i = 0; i < inf.globalCount; i++)
+        inf.globals[i].symbol->expressionType = inf.globals[i].type;
+
+    free(inf.functions);
+    free(inf.bySymbol);
+    free(inf.accesses);
+    free(inf.globals);
+    free(inf.stack);
+    free(inf.order);
+    free(inf.queue);
+}
@@ -0,0 +1,36 @@
+/**
+ * @file infer.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Interprocedural inference of parameter, return and operand types
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef INFER_H
+#define INFER_H
+
+#include "parser.h"
+#include "symtable.h"
+
+/**
+ * @brief Infers types of all functions of program over call graph
+ *
+ * Runs after bindProgram (local variables are tracked by their frame slot). Every function
+ * body is walked flow-sensitively, argument types of call sites are joined into paramTypes
+ * of callee and types of returns into expressionType of function symbol. Global variables
+ * have one type in the whole program, the union of all types assigned to them and nil.
+ * Functions are visited in order of strongly connected components of call graph (callees
+ * first) and revisited until types stop changing, a function is queued again when type of
+ * its callee, of its parameter or of a global variable it accesses widens. Bodies of if and
+ * while and right operands of && see local variables narrowed by `is` tests and null
+ * comparisons of their condition. Afterwards expressionType of every expression node inside
+ * functions is the set of types its value can have at run time.
+ *
+ * @param root - AST_CLASS_DEC root of program
+ */
+void inferProgram(AstNode* root);
+
+#endif  // INFER_H
@@ -10,15 +10,83 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "batch.h"
+#include "binder.h"
 #include "codegen.h"
+#include "driver.h"
 #include "error.h"
+#include "infer.h"
 #include "parser.h"
 #include "scanner.h"
 #include "semantic.h"
+#include "serve.h"
+#include "stats.h"
+#include "threadpool.h"
 #include "utils.h"
 
+/**
+ * @brief Removes statistics options (--time-passes, --mem-stats, --stats-json) from argv
+ *        and enables statistics, so they can be combined with any mode
+ *
+ * @return int argc without statistics options
+ */
+static int takeStatsOptions(int argc, char const* argv[])
+{
+    bool timePasses = false;
+    bool memStats = false;
+    bool json = false;
+    int kept = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--time-passes") == 0)
+            timePasses = true;
+        else if (strcmp(argv[i], "--mem-stats") == 0)
+            memStats = true;
+        else if (strcmp(argv[i], "--stats-json") == 0)
+            json = true;
+        else
+            argv[kept++] = argv[i];
+    }
+
+    if (timePasses || memStats || json)
+    {
+        // Samotné --stats-json vypíše všechno
+        statsEnable(timePasses || !memStats, memStats || !timePasses, json);
+    }
+    return kept;
+}
+
+/**
+ * @brief Removes options of parallel passes (--threads=N, --semantic-parallel-min=N,
+ *        --gen-parallel-min=N) from argv
+ *
+ * Parallel passes otherwise start only with more CPUs and large enough programs, the options
+ * let tests force them and compare the result with the serial one.
+ *
+ * @return int argc without parallel options
+ */
+static int takeParallelOptions(int argc, char const* argv[])
+{
+    int kept = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--threads=", 10) == 0)
+            threadPoolSetDefaultSize(atoi(argv[i] + 10));
+        else if (strncmp(argv[i], "--semantic-parallel-min=", 24) == 0)
+            semanticSetParallelMin(atol(argv[i] + 24));
+        else if (strncmp(argv[i], "--gen-parallel-min=", 19) == 0)
+            genSetParallelMin(atol(argv[i] + 19));
+        else
+            argv[kept++] = argv[i];
+    }
+    return kept;
+}
+
 int main(int argc, char const* argv[])
 {
+    argc = takeStatsOptions(argc, argv);
+    argc = takeParallelOptions(argc, argv);
+
     /* =============================================================
        LEX TEST MODE (for run_lex_tests.sh)
        ./compiler --test-scanner < input
@@ -56,86 +124,43 @@ int main(int argc, char const* argv[])
 
     /* =============================================================
        NORMAL USER MODE: ./compiler  (stdin)
+       ./compiler --incremental cacheDir < input
        ============================================================= */
-    if (argc == 1)
+    if (argc == 1 || (argc == 3 && strcmp(argv[1], "--incremental") == 0))
     {
-        Scanner* scanner = malloc(sizeof(Scanner));
-        if (!scanner)
-        {
-            errorExit(INTERNAL_ERROR, "Failed to allocate scanner", 0, NULL);
-        }
-
-        FILE* source = stdin;
-        SLList* resolveLater = listInit();
-        if (!resolveLater)
-        {
-            free(scanner);
-            errorExit(INTERNAL_ERROR, "Failed to create symbol table", 0, NULL);
-        }
-
-        SymTableStack* symStack = symTableStackCreate(INITIAL_CAPACITY_STACK);
-        if (!symStack)
-        {
-            free(scanner);
-            listDispose(resolveLater);
-            errorExit(INTERNAL_ERROR, "Failed to create symbol table", 0, NULL);
-        }
-        symTableStackPush(symStack);
-
-        initScanner(scanner, source);
-
-        // Prológ import "ifj25" for Ifj
-        if (readPrologue(scanner) != 0)
-        {
-            disposeScanner(scanner);
-            free(scanner);
-            freeSymTableStack(symStack);
-            errorExit(SYNTAX_ERROR, "Invalid prologue", 0, NULL);
-        }
+        // Nezměněné funkce se místo generování kopírují z cache
+        const char* cacheDir = argc == 3 ? argv[2] : NULL;
 
-        Parser* parser = parserInit(scanner, symStack, resolveLater);
-        if (!parser)
-        {
-            disposeScanner(scanner);
-            free(scanner);
-            freeSymTableStack(symStack);
-            errorExit(INTERNAL_ERROR, "Failed to init parser", 0, NULL);
-        }
-        loadIFJBuiltins(symStack);
-        parseProgram(parser);
-        AstNode* temp = astCreateNode(AST_BLOCK);
-        ((AstN*)temp->children)->childrenList = resolveLater;
-        symTableStackPush(symStack);
-        semanticResolveCheckLater(resolveLater, parser->symStack);
+        SymTableStack* symStack = compileSymStackCreate();
+        compileProgram(stdin, symStack, cacheDir);
+        freeSymTableStack(symStack);
 
-        checkFunDec(symStack->scopes[0]);
+        return 0;
+    }
 
-        if (parser->root)
-        {
-            // Kódovanie do IFJcode25
-            generate(parser->root, symStack);
-            astDispose(parser->root);
-            parser->root = NULL;  // Zabrániť dvojitému uvoľneniu
-        }
+    /* =============================================================
+       CACHED MODE: ./compiler --cache cacheDir < input
+       ============================================================= */
+    if (argc == 3 && strcmp(argv[1], "--cache") == 0)
+    {
+        // Stejný zdroj se stejným překladačem se už nepřekládá
+        return compileProgramCached(stdin, argv[2]);
+    }
 
-        if (resolveLater)
-        {
-            ListItem* current = resolveLater->firstItem;
-            while (current)
-            {
-                ListItem* next = current->next;
-                free(current);
-                current = next;
-            }
-            free(resolveLater);
-        }
-        symTableStackPop(symStack);
-        freeSymTableStack(symStack);
-        free(parser);
-        disposeScanner(scanner);
-        free(scanner);
+    /* =============================================================
+       DAEMON MODE: ./compiler --serve socketPath
+       ============================================================= */
+    if (argc == 3 && strcmp(argv[1], "--serve") == 0)
+    {
+        return serveRun(argv[2]);
+    }
 
-        return 0;
+    /* =============================================================
+       BATCH MODE: ./compiler --batch listFile|dir --out-dir dir
+       ============================================================= */
+    if (argc == 5 && strcmp(argv[1], "--batch") == 0 && strcmp(argv[3], "--out-dir") == 0)
+    {
+        return batchRun(argv[2], argv[4]);
     }
 
     /* =============================================================
@@ -183,7 +208,7 @@ int main(int argc, char const* argv[])
             {
                 if (getNextToken(scanner, token) != 0)
                 {
-                    int errorLine = scanner->line;
+                    int errorLine = scannerLine(scanner);
                     freeToken(token);
                     free(token);
                     disposeScanner(scanner);
@@ -230,7 +255,7 @@ int main(int argc, char const* argv[])
                 fclose(source);
                 errorExit(SYNTAX_ERROR, "Invalid prologue", 0, NULL);
             }
-            SLList* resolveLater = NULL;
+            NodeVec* resolveLater = NULL;
             Parser* parser = parserInit(scanner, symStack, resolveLater);
             if (!parser)
             {
@@ -252,6 +277,7 @@ int main(int argc, char const* argv[])
             }
 
             freeSymTableStack(symStack);
+            astStackDispose(&parser->expStack);
             free(parser);
             disposeScanner(scanner);
             free(scanner);
@@ -283,7 +309,7 @@ int main(int argc, char const* argv[])
                 errorExit(SYNTAX_ERROR, "Invalid prologue", 0, NULL);
             }
 
-            SLList* resolveLater = listInit();
+            NodeVec* resolveLater = nodeVecCreate();
 
             if (!resolveLater)
             {
@@ -297,7 +323,7 @@ int main(int argc, char const* argv[])
             Parser* parser = parserInit(scanner, symStack, resolveLater);
             if (!parser)
             {
-                listDispose(resolveLater);
+                nodeVecDestroy(resolveLater);
                 disposeScanner(scanner);
                 free(scanner);
                 freeSymTableStack(symStack);
@@ -311,30 +337,24 @@ int main(int argc, char const* argv[])
             // int prefix[128] = {0};
             parseProgram(parser);
 
-            semanticResolveCheckLater(resolveLater, parser->symStack);
+            semanticResolveCheckLaterParallel(resolveLater, parser->symStack, parser->root);
             checkFunDec(symStack->scopes[0]);
 
             if (parser->root)
             {
                 // printASTTree(parser->root, 0, 1, prefix);
+                bindProgram(parser->root, symStack);
+                inferProgram(parser->root);
                 generate(parser->root, symStack);
                 astDispose(parser->root);
                 parser->root = NULL;  // Zabrániť dvojitému uvoľneniu
             }
 
-            if (resolveLater)
-            {
-                ListItem* current = resolveLater->firstItem;
-                while (current)
-                {
-                    ListItem* next = current->next;
-                    free(current);  // Uvoľníme len ListItem, nie current->item (ten je už free)
-                    current = next;
-                }
-                free(resolveLater);
-            }
+            // Uzly patria AST stromu, uvoľní sa len pole
+            nodeVecDestroy(resolveLater);
 
             freeSymTableStack(symStack);
+            astStackDispose(&parser->expStack);
             free(parser);
             disposeScanner(scanner);
             free(scanner);
@@ -0,0 +1,244 @@
+/**
+ * @file outcache.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Content-addressed cache of whole compiler results (code, messages and exit code)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "outcache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "hash.h"
+
+#define OUTCACHE_SUFFIX ".ifjo"
+#define OUTCACHE_MAGIC "IFJO"
+
+/**
+ * @brief Header of entry, followed by generated code and error messages
+ */
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    int32_t code;
+    uint32_t reserved;
+    uint64_t outLength;
+    uint64_t errLength;
+} OutCacheHeader;
+
+typedef struct
+{
+    char *path;
+    off_t size;
+    struct timespec used;  // mtime, refreshed on every hit
+} OutCacheEntry;
+
+/**
+ * @brief Add identity of running compiler binary, rebuilt compiler gets new keys
+ */
+static uint64_t hashCompiler(uint64_t hash)
+{
+    hash = hashInt(hash, OUTCACHE_VERSION);
+
+    struct stat info;
+    if (stat("/proc/self/exe", &info) == 0)
+    {
+        hash = hashInt(hash, (uint64_t)info.st_ino);
+        hash = hashInt(hash, (uint64_t)info.st_size);
+        hash = hashInt(hash, (uint64_t)info.st_mtim.tv_sec);
+        hash = hashInt(hash, (uint64_t)info.st_mtim.tv_nsec);
+    }
+    return hash;
+}
+
+void outCacheInit(OutCache *cache, const char *dir, const char *source, size_t length,
+                  const char *options)
+{
+    cache->dir = dir;
+    cache->maxBytes = OUTCACHE_MAX_BYTES;
+
+    uint64_t hash = hashCompiler(HASH_SEED);
+    hash = hashString(hash, options);
+    cache->key = hashBlock(hash, source, length);
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to create cache directory", 0, NULL);
+    }
+}
+
+/**
+ * @brief Path of cached key, caller frees
+ */
+static char *outCachePath(const OutCache *cache, const char *suffix)
+{
+    size_t size = strlen(cache->dir) + strlen(suffix) + 32;
+    char *path = malloc(size);
+    if (!path)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate cache path", 0, NULL);
+    }
+    snprintf(path, size, "%s/%016llx%s", cache->dir, (unsigned long long)cache->key, suffix);
+    return path;
+}
+
+static bool outCacheCopy(FILE *from, FILE *to, uint64_t length)
+{
+    char buffer[4096];
+    while (length > 0)
+    {
+        size_t chunk = length < sizeof(buffer) ? (size_t)length : sizeof(buffer);
+        if (fread(buffer, 1, chunk, from) != chunk) return false;
+        fwrite(buffer, 1, chunk, to);
+        length -= chunk;
+    }
+    return true;
+}
+
+bool outCacheReplay(OutCache *cache, FILE *out, FILE *err, int *code)
+{
+    char *path = outCachePath(cache, OUTCACHE_SUFFIX);
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        free(path);
+        return false;
+    }
+
+    // Záznam se kontroluje celý předem, na výstup nesmí jít půlka výsledku
+    OutCacheHeader header;
+    struct stat info;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                 memcmp(header.magic, OUTCACHE_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == OUTCACHE_VERSION && fstat(fileno(file), &info) == 0 &&
+                 (uint64_t)info.st_size == sizeof(header) + header.outLength + header.errLength;
+    if (valid)
+    {
+        valid = outCacheCopy(file, out, header.outLength) &&
+                outCacheCopy(file, err, header.errLength);
+        *code = header.code;
+        utimensat(AT_FDCWD, path, NULL, 0);  // Čas použití pro LRU
+    }
+
+    fclose(file);
+    free(path);
+    return valid;
+}
+
+static int outCacheCompareUse(const void *a, const void *b)
+{
+    const struct timespec *x = &((const OutCacheEntry *)a)->used;
+    const struct timespec *y = &((const OutCacheEntry *)b)->used;
+    if (x->tv_sec != y->tv_sec) return x->tv_sec < y->tv_sec ? -1 : 1;
+    if (x->tv_nsec != y->tv_nsec) return x->tv_nsec < y->tv_nsec ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Remove least recently used entries until the cache fits into maxBytes
+ */
+static void outCacheEvict(OutCache *cache)
+{
+    DIR *dir = opendir(cache->dir);
+    if (!dir) return;
+
+    OutCacheEntry *entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    uint64_t total = 0;
+
+    struct dirent *item;
+    while ((item = readdir(dir)) != NULL)
+    {
+        size_t nameLength = strlen(item->d_name);
+        size_t suffixLength = strlen(OUTCACHE_SUFFIX);
+        if (nameLength <= suffixLength ||
+            strcmp(item->d_name + nameLength - suffixLength, OUTCACHE_SUFFIX) != 0)
+        {
+            continue;
+        }
+
+        if (count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            OutCacheEntry *grown = realloc(entries, sizeof(OutCacheEntry) * capacity);
+            if (!grown) break;  // Úklid se jen odloží na příští uložení
+            entries = grown;
+        }
+
+        size_t size = strlen(cache->dir) + nameLength + 2;
+        char *path = malloc(size);
+        if (!path) break;
+        snprintf(path, size, "%s/%s", cache->dir, item->d_name);
+
+        struct stat info;
+        if (stat(path, &info) != 0)
+        {
+            free(path);
+            continue;
+        }
+        entries[count].path = path;
+        entries[count].size = info.st_size;
+        entries[count].used = info.st_mtim;
+        total += (uint64_t)info.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    if (total > cache->maxBytes)
+    {
+        qsort(entries, count, sizeof(OutCacheEntry), outCacheCompareUse);
+        for (size_t i = 0; i < count && total > cache->maxBytes; i++)
+        {
+            // Souběžný překlad mohl záznam smazat dřív, velikost se odečte i tak
+            remove(entries[i].path);
+            total -= (uint64_t)entries[i].size;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) free(entries[i].path);
+    free(entries);
+}
+
+void outCacheStore(OutCache *cache, int code, const char *out, size_t outLength, const char *err,
+                   size_t errLength)
+{
+    OutCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, OUTCACHE_MAGIC, sizeof(header.magic));
+    header.version = OUTCACHE_VERSION;
+    header.code = code;
+    header.outLength = outLength;
+    header.errLength = errLength;
+
+    // Zápis do dočasného souboru a přejmenování, souběžný překlad nikdy nečte půlku záznamu
+    char tempSuffix[32];
+    snprintf(tempSuffix, sizeof(tempSuffix), ".%ld.tmp", (long)getpid());
+    char *tempPath = outCachePath(cache, tempSuffix);
+    char *path = outCachePath(cache, OUTCACHE_SUFFIX);
+
+    FILE *file = fopen(tempPath, "wb");
+    bool stored = false;
+    if (file)
+    {
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       fwrite(out, 1, outLength, file) == outLength &&
+                       fwrite(err, 1, errLength, file) == errLength;
+        stored = fclose(file) == 0 && written && rename(tempPath, path) == 0;
+        if (!stored) remove(tempPath);
+    }
+
+    free(tempPath);
+    free(path);
+
+    if (stored) outCacheEvict(cache);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file outcache.h
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Content-addressed cache of whole compiler results (code, messages and exit code)
+ *
+ * Key is XXH64 of source bytes together with identity of compiler binary and options, so a
+ * source compiled before is answered from the cache without scanning or parsing. Entries are
+ * written atomically (temporary file and rename) and the directory is kept under a size limit
+ * by removing least recently used entries.
+ */
+
+#ifndef OUTCACHE_H
+#define OUTCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define OUTCACHE_VERSION 1                     // bump whenever format of entry changes
+#define OUTCACHE_MAX_BYTES (64UL * 1024 * 1024)  // default size limit of cache directory
+
+typedef struct
+{
+    const char *dir;  // Directory with entries, one file per key
+    uint64_t key;     // Key of compiled source
+    size_t maxBytes;  // Entries beyond this total size are evicted, least recently used first
+} OutCache;
+
+/**
+ * @brief Initialize cache in directory dir for given source, the directory is created when
+ *        missing
+ *
+ * @param cache cache to initialize
+ * @param dir cache directory
+ * @param source whole source text
+ * @param length length of source
+ * @param options options of compilation that change its result
+ */
+void outCacheInit(OutCache *cache, const char *dir, const char *source, size_t length,
+                  const char *options);
+
+/**
+ * @brief Write cached result of source to out and err
+ *
+ * @param cache initialized cache
+ * @param out receives generated code
+ * @param err receives error messages
+ * @param code exit code of cached compilation
+ * @return true on hit, false when source is not cached (nothing is written)
+ */
+bool outCacheReplay(OutCache *cache, FILE *out, FILE *err, int *code);
+
+/**
+ * @brief Store result of compilation, failures only leave the source uncached
+ *
+ * @param cache initialized cache
+ * @param code exit code
+ * @param out generated code
+ * @param outLength length of out
+ * @param err error messages
+ * @param errLength length of err
+ */
+void outCacheStore(OutCache *cache, int code, const char *out, size_t outLength, const char *err,
+                   size_t errLength);
+
+#endif  // OUTCACHE_H
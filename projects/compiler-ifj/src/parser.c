@@ -18,6 +18,7 @@
 
 #include "error.h"
 #include "semantic.h"
+#include "stats.h"
 #include "utils.h"
 
 /* --------------------------------------------------------------- */
@@ -28,7 +29,7 @@ void tokenDeepCopy(Token* src, Token* dst)
     if (!src || !dst) return;
 
     dst->type = src->type;
-    dst->line = src->line;
+    dst->offset = src->offset;
 
     if (src->value)
     {
@@ -70,7 +71,7 @@ void tokenDeepCopy(Token* src, Token* dst)
  * @param scanner - pointer to Scanner state
  * @return Parser* - pointer to initialized Parser struct
  */
-Parser* parserInit(Scanner* scanner, SymTableStack* symStack, SLList* resolveLater)
+Parser* parserInit(Scanner* scanner, SymTableStack* symStack, NodeVec* resolveLater)
 {
     Parser* parser = malloc(sizeof(Parser));
 
@@ -79,9 +80,11 @@ Parser* parserInit(Scanner* scanner, SymTableStack* symStack, SLList* resolveLat
     parser->scanner = scanner;
     parser->symStack = symStack;
     parser->resolveLater = resolveLater;
-    parser->lookAhead.type = NONE;
+    parser->lookAhead = NULL;
     parser->current.type = NONE;
+    parser->current.value = NULL;
     parser->root = NULL;
+    astStackInit(&parser->expStack, ASTSTACK_INITIAL_CAPACITY);
 
     return parser;
 }
@@ -93,6 +96,7 @@ void parserDispose(Parser* parser)
         if (parser->scanner) disposeScanner(parser->scanner);
         if (parser->root) astDispose(parser->root);
         if (parser->symStack) freeSymTableStack(parser->symStack);
+        astStackDispose(&parser->expStack);
         free(parser);
     }
 }
@@ -104,21 +108,36 @@ void parserDispose(Parser* parser)
  */
 void parserAdvance(Parser* parser)
 {
+    // Token do current jen přesuneme ze scanneru, lookAhead ukazoval na právě odebraný
+    parser->lookAhead = NULL;
     if (parser->current.type != NONE) freeToken(&parser->current);
     if (getNextToken(parser->scanner, &parser->current) == 1)
     {
-        parserDispose(parser);
-        errorExit(LEXICAL_ERROR, "Invalid lexical type", 0, NULL);
+        // Parser, scanner i tabulka symbolů patří volajícímu, errorExit kompilaci ukončí
+        errorExit(LEXICAL_ERROR, "Invalid lexical type", tokenLine(&parser->current), NULL);
     }
+    STATS_COUNT(STAT_TOKENS, 1);
 }
 
-void parserLookAhead(Parser* parser)
+Token* parserPeek(Parser* parser, unsigned k)
 {
-    if (lookAhead(parser->scanner, &parser->lookAhead) == 1)
+    Token* token;
+    if (scannerPeek(parser->scanner, k, &token) == 1)
     {
-        parserDispose(parser);
-        errorExit(LEXICAL_ERROR, "Invalid lexical type", 0, NULL);
+        errorExit(LEXICAL_ERROR, "Invalid lexical type", scannerLine(parser->scanner), NULL);
     }
+    return token;
+}
+
+void parserLookAhead(Parser* parser)
+{
+    parser->lookAhead = parserPeek(parser, 0);
+}
+
+void parserTakeToken(Parser* parser, Token* dst)
+{
+    *dst = parser->current;
+    parser->current.value = NULL;
 }
 
 /**
@@ -134,8 +153,7 @@ void parserValidate(Parser* parser, TokenType type, char* errorMessage)
 {
     if (parser->current.type != type)
     {
-        parserDispose(parser);
-        errorExit(SYNTAX_ERROR, errorMessage, parser->current.line, &parser->current);
+        errorExit(SYNTAX_ERROR, errorMessage, tokenLine(&parser->current), &parser->current);
     }
 }
 
@@ -149,51 +167,61 @@ void parserValidateSequence(Parser* p, TokenType* t, char** msg, unsigned count)
 }
 
 /* -------------------------------------------------------------- */
-/* SLL Functions                                                  */
+/* NodeVec Functions                                              */
 /* -------------------------------------------------------------- */
 
-SLList* listInit(void)
+void nodeVecInit(NodeVec* vec)
 {
-    SLList* list = malloc(sizeof(SLList));
-    if (!list) return NULL;
-
-    list->count = 0;
-    list->firstItem = NULL;
-    list->lastItem = NULL;
-    return list;
+    vec->count = 0;
+    vec->capacity = NODEVEC_INLINE;
+    vec->items = vec->inlineItems;
 }
 
-bool listAppend(SLList* list, AstNode* node)
+void nodeVecPush(NodeVec* vec, AstNode* node)
 {
-    ListItem* item = malloc(sizeof(ListItem));
-    if (!item) return false;
-
-    item->item = node;
-    item->next = NULL;
-
-    if (list->lastItem)
-        list->lastItem->next = item;
-    else
-        list->firstItem = item;
+    if (vec->count == vec->capacity)
+    {
+        long capacity = vec->capacity * 2;
+        AstNode** items;
+        if (vec->items == vec->inlineItems)
+        {
+            // Prvé zväčšenie presúva položky z vloženého poľa na heap
+            items = malloc(sizeof(AstNode*) * capacity);
+            if (items) memcpy(items, vec->inlineItems, sizeof(AstNode*) * vec->count);
+        }
+        else
+        {
+            items = realloc(vec->items, sizeof(AstNode*) * capacity);
+        }
+        if (!items) errorExit(INTERNAL_ERROR, "Unable to grow NodeVec", 0, NULL);
+        vec->items = items;
+        vec->capacity = capacity;
+    }
+    vec->items[vec->count++] = node;
+}
 
-    list->lastItem = item;
-    list->count++;
-    return true;
+/**
+ * @brief Free storage of vector, nodes stay untouched (they belong to AST)
+ */
+void nodeVecDispose(NodeVec* vec)
+{
+    if (vec->items != vec->inlineItems) free(vec->items);
+    nodeVecInit(vec);
 }
 
-void listDispose(SLList* list)
+NodeVec* nodeVecCreate(void)
 {
-    ListItem* listItem = list->firstItem;
-    while (listItem)
-    {
-        astDispose(listItem->item);
-        ListItem* temp = listItem->next;
-        free(listItem);
-        listItem = temp;
-    }
+    NodeVec* vec = malloc(sizeof(NodeVec));
+    if (!vec) return NULL;
+    nodeVecInit(vec);
+    return vec;
+}
 
-    free(list);
-    list = NULL;
+void nodeVecDestroy(NodeVec* vec)
+{
+    if (!vec) return;
+    nodeVecDispose(vec);
+    free(vec);
 }
 
 /* -------------------------------------------------------------- */
@@ -205,8 +233,50 @@ AstNode* astInit(void)
     return NULL;
 }
 
+/**
+ * @brief True for expression with both operands, unary '!' has only the right one
+ */
+bool astIsBinaryExpression(const AstNode* node)
+{
+    return node && node->type == AST_EXPRESSION && node->children &&
+           ((AstBin*)node->children)->left;
+}
+
+/**
+ * @brief Collects left spine of binary expression
+ *
+ * "1 + 2 + 3" parses as ((1 + 2) + 3), so a long chain of operators is deep only on the left.
+ * Passes over expressions walk the spine in a loop and recurse only into right operands,
+ * recursion over the left side would overflow the C stack.
+ *
+ * @param node expression with AstBin children
+ * @param spine initialized vector, gets node and binary expressions below it on the left from
+ * top to bottom, left operand of the last one is not binary
+ */
+void astLeftSpine(AstNode* node, NodeVec* spine)
+{
+    nodeVecPush(spine, node);
+    for (AstNode* left = ((AstBin*)node->children)->left; astIsBinaryExpression(left);
+         left = ((AstBin*)left->children)->left)
+    {
+        nodeVecPush(spine, left);
+    }
+}
+
 void astDispose(AstNode* tree)
 {
+    // Levá větev dlouhého řetězce operátorů se uvolňuje cyklem
+    while (astIsBinaryExpression(tree))
+    {
+        AstBin* children = tree->children;
+        AstNode* left = children->left;
+        astDispose(children->right);
+        free(children);
+        freeToken(&tree->token);
+        free(tree);
+        tree = left;
+    }
+
     if (tree == NULL) return;
 
     switch (tree->type)
@@ -243,21 +313,11 @@ void astDispose(AstNode* tree)
             AstN* children = tree->children;
             if (!children) break;
 
-            // Uvoľníme uzly rekurzívne - NEPOUŽÍVAME listDispose, lebo ten uvoľňuje uzly,
-            // ktoré sú už súčasťou AST stromu a uvoľnia sa rekurzívne
-            SLList* list = children->childrenList;
-            if (list)
+            for (long i = 0; i < children->nodes.count; i++)
             {
-                ListItem* item = list->firstItem;
-                while (item)
-                {
-                    if (item->item) astDispose(item->item);
-                    ListItem* next = item->next;
-                    free(item);
-                    item = next;
-                }
-                free(list);
+                if (children->nodes.items[i]) astDispose(children->nodes.items[i]);
             }
+            nodeVecDispose(&children->nodes);
 
             free(children);
             break;
@@ -283,10 +343,15 @@ AstNode* astCreateNode(AstNodeType type)
 {
     AstNode* node = malloc(sizeof(AstNode));
     if (!node) errorExit(INTERNAL_ERROR, "Unable to allocate space for Node", 0, NULL);
+    STATS_COUNT(STAT_AST_NODES, 1);
     node->token.type = NONE;
+    node->token.offset = 0;  // Uzel bez tokenu hlásí chyby na začátku souboru
     node->token.value = NULL;
     node->type = type;
     node->expressionType = TYPE_UNKNOWN;
+    node->spanEnd = 0;
+    node->symbol = NULL;
+    node->scope = NULL;
     switch (type)
     {
         case AST_VAR_DEC:
@@ -316,13 +381,10 @@ AstNode* astCreateNode(AstNodeType type)
         case AST_BLOCK:
         case AST_PARAMS:
         {
-            SLList* list = listInit();
-            if (!list) errorExit(INTERNAL_ERROR, "Unable to allocate space for SLList", 0, NULL);
-
             AstN* children = malloc(sizeof(AstN));
             if (!children) errorExit(INTERNAL_ERROR, "Unable to allocate space for Node", 0, NULL);
             node->children = children;
-            children->childrenList = list;
+            nodeVecInit(&children->nodes);
             break;
         }
         case AST_TYPE:
@@ -367,30 +429,33 @@ void assignTypeFromToken(AstNode* node, Parser* parser)
                 symTableStackFindSymbol(parser->symStack, node->token.value->stringVal);
             if (!symbol)
             {
-                Symbol* getterSym =
-                    symbolCreate(node->token.value->stringVal, TYPE_UNKNOWN, SYM_GET, 1);
-                Symbol* getter = symTableStackFindSymbol(parser->symStack, getterSym->name);
+                Symbol* getter = symTableStackFindUnique(
+                    parser->symStack, node->token.value->stringVal, SYM_GET, 1);
                 if (getter)
                 {
                     // Getter existuje → ID reprezentuje přístup ke getteru
                     node->expressionType = getter->expressionType;
+                    node->symbol = getter;
                     return;
                 }
 
                 // 3) Nic → chyba
-                errorExit(SEM_UNDEF, "Undefined variable", node->token.line, &node->token);
+                errorExit(SEM_UNDEF, "Undefined variable", tokenLine(&node->token), &node->token);
             }
             node->expressionType = symbol->expressionType;
+            node->symbol = symbol;
             break;
         case GLOBAL_IDENTIFIER:
             Symbol* globalSymbol =
                 symTableStackFindSymbol(parser->symStack, node->token.value->stringVal);
             if (!globalSymbol)
             {
-                globalSymbol = symbolCreate(node->token.value->stringVal, TYPE_UNKNOWN, SYM_VAR, 0);
+                globalSymbol = symbolCreate(&parser->symStack->arena, node->token.value->stringVal,
+                                            TYPE_UNKNOWN, SYM_VAR, 0);
                 scopeAddSymbol(parser->symStack->scopes[0], globalSymbol);
             }
             node->expressionType = globalSymbol->expressionType;
+            node->symbol = globalSymbol;
             break;
         default:
             node->expressionType = TYPE_UNKNOWN;
@@ -401,7 +466,7 @@ void assignTypeFromToken(AstNode* node, Parser* parser)
 void assignTypeFromSymtable(AstNode* node, SymTableStack* symTable)
 {
     Symbol* symbol = symTableStackFindSymbol(symTable, node->token.value->stringVal);
-    if (!symbol) errorExit(SEM_UNDEF, "Undefined variable", node->token.line, &node->token);
+    if (!symbol) errorExit(SEM_UNDEF, "Undefined variable", tokenLine(&node->token), &node->token);
     node->expressionType = symbol->expressionType;
 }
 
@@ -413,15 +478,26 @@ void astStackInit(AstStack* stack, int capacity)
     }
     else
     {
-        stack->array = malloc(sizeof(char) * capacity);
-
-        if (stack->array != NULL)
+        stack->array = malloc(sizeof(AstNode*) * capacity);
+        if (stack->array == NULL)
         {
-            stack->topIndex = -1;
+            errorExit(INTERNAL_ERROR, "Unable to allocate AST_STACK", 0, NULL);
         }
+        stack->topIndex = -1;
+        stack->capacity = capacity;
     }
 }
 
+/**
+ * Vyprázdní zásobník bez uvolnění pole, kapacita zůstává pro další výraz.
+ *
+ * @param stack Ukazatel na inicializovanou strukturu zásobníku
+ */
+void astStackReset(AstStack* stack)
+{
+    stack->topIndex = -1;
+}
+
 /**
  * Vrací nenulovou hodnotu, je-li zásobník prázdný, jinak vrací hodnotu 0.
  * Funkci implementujte jako jediný příkaz.
@@ -450,7 +526,7 @@ bool astStackIsEmpty(AstStack* stack)
  */
 bool astStackIsFull(const AstStack* stack)
 {
-    return stack->topIndex == ASTSTACK_MAX - 1;
+    return stack->topIndex == stack->capacity - 1;
 }
 
 /**
@@ -505,7 +581,14 @@ AstNode* astStackPop(AstStack* stack)
 void astStackPush(AstStack* stack, AstNode* node)
 {
     if (astStackIsFull(stack))
-        errorExit(INTERNAL_ERROR, "Couldnt push to AST_STACK. Stack is FULL", 0, NULL);
+    {
+        // Zdvojnásobení drží amortizovaně konstantní cenu push i pro obří výrazy
+        int capacity = stack->capacity * 2;
+        AstNode** array = realloc(stack->array, sizeof(AstNode*) * capacity);
+        if (!array) errorExit(INTERNAL_ERROR, "Couldnt grow AST_STACK", 0, NULL);
+        stack->array = array;
+        stack->capacity = capacity;
+    }
     stack->topIndex++;
     stack->array[stack->topIndex] = node;
 }
@@ -524,6 +607,11 @@ AstNode* astStackNextOp(AstStack* stack)
     return NULL;  // no operator found
 }
 
+/**
+ * @brief Stands for '(' on the expression stack, parenthesis never becomes an AST node
+ */
+static AstNode parenMarker = {.type = AST_OPERATOR, .token = {.type = LPAR}};
+
 /**
  * Zruší a uvolní dynamicky alokované prostředky struktury.
  * Uvede zásobník do prázdného stavu.
@@ -532,9 +620,15 @@ AstNode* astStackNextOp(AstStack* stack)
  */
 void astStackDispose(AstStack* stack)
 {
+    // Uzly zůstávají na zásobníku jen po chybě ve výrazu, do stromu nepatří
+    for (int i = 0; i <= stack->topIndex; i++)
+    {
+        if (stack->array[i] != &parenMarker) astDispose(stack->array[i]);
+    }
     free(stack->array);
     stack->array = NULL;
     stack->topIndex = -1;
+    stack->capacity = 0;
 }
 
 /* -------------------------------------------------------------- */
@@ -546,7 +640,7 @@ void parseProgram(Parser* parser)
     parser->root = parseClassDec(parser);
 
     parserLookAhead(parser);
-    if (parser->lookAhead.type == EOL) parserAdvance(parser);
+    if (parser->lookAhead->type == EOL) parserAdvance(parser);
 
     parserAdvance(parser);
     parserValidate(parser, EOF_TOKEN, "Invalid syntax expected EOF");
@@ -561,17 +655,19 @@ AstNode* parseClassDec(Parser* parser)
     parserValidateSequence(parser, (TokenType[]){KW_CLASS, IDENTIFIER}, msg, 2);
 
     AstNode* classNode = astCreateNode(AST_CLASS_DEC);
-    tokenDeepCopy(&parser->current, &classNode->token);
+    parserTakeToken(parser, &classNode->token);
+
+    // Hotové funkce jsou dosažitelné z kořene, i když kompilaci přeruší chyba
+    parser->root = classNode;
 
     char* msg2[] = {"Invalid syntax, expected '{'", "new line"};
     parserValidateSequence(parser, (TokenType[]){LCURLY, EOL}, msg2, 2);
 
     parserLookAhead(parser);
-    while (parser->lookAhead.type == KW_STATIC)
+    while (parser->lookAhead->type == KW_STATIC)
     {
         AstNode* node = parseFunDec(parser);
-        if (!listAppend(((AstN*)classNode->children)->childrenList, node))
-            errorExit(INTERNAL_ERROR, "Unable to allocate space for Parser", 0, NULL);
+        nodeVecPush(&((AstN*)classNode->children)->nodes, node);
         parserLookAhead(parser);
     }
 
@@ -587,13 +683,14 @@ AstNode* parseBlock(Parser* parser, Symbol* funSym)
     parserValidateSequence(parser, (TokenType[]){LCURLY, EOL}, msg, 2);
 
     AstNode* node = astCreateNode(AST_BLOCK);
-    parseStList(parser, ((AstN*)node->children)->childrenList, funSym);
+    parseStList(parser, &((AstN*)node->children)->nodes, funSym);
 
     parserAdvance(parser);
     parserValidate(parser, RCURLY, "Invalid Syntax expected '}' after new line");
+    node->spanEnd = parser->current.offset + 1;
 
     parserLookAhead(parser);
-    if (parser->lookAhead.type != KW_ELSE && parser->lookAhead.type != EOF_TOKEN)
+    if (parser->lookAhead->type != KW_ELSE && parser->lookAhead->type != EOF_TOKEN)
     {
         parserAdvance(parser);
         parserValidate(parser, EOL, "Invalid Syntax expected new line after '}'");
@@ -602,14 +699,14 @@ AstNode* parseBlock(Parser* parser, Symbol* funSym)
     return node;
 }
 
-void parseStList(Parser* parser, SLList* list, Symbol* funSym)
+void parseStList(Parser* parser, NodeVec* list, Symbol* funSym)
 {
     AstNode* node;
 
     parserLookAhead(parser);
-    while (parser->lookAhead.type != RCURLY && parser->lookAhead.type != EOF_TOKEN)
+    while (parser->lookAhead->type != RCURLY && parser->lookAhead->type != EOF_TOKEN)
     {
-        switch (parser->lookAhead.type)
+        switch (parser->lookAhead->type)
         {
             case KW_IFJ:
                 node = parseIfj(parser);
@@ -618,7 +715,7 @@ void parseStList(Parser* parser, SLList* list, Symbol* funSym)
             case LCURLY:
                 symTableStackPush(parser->symStack);
                 node = parseBlock(parser, funSym);
-                symTableStackPop(parser->symStack);
+                node->scope = symTableStackFreeze(parser->symStack);
                 break;
 
             case KW_RETURN:
@@ -645,10 +742,10 @@ void parseStList(Parser* parser, SLList* list, Symbol* funSym)
 
             default:
                 errorExit(SYNTAX_ERROR, "Invalid syntax, expected statement start",
-                          parser->current.line, &parser->current);
+                          tokenLine(&parser->current), &parser->current);
                 break;
         }
-        listAppend(list, node);
+        nodeVecPush(list, node);
         parserLookAhead(parser);
     }
 }
@@ -662,35 +759,35 @@ AstNode* parseFunDec(Parser* parser)
     parserValidate(parser, IDENTIFIER, "Invalid syntax, expected function name");
 
     AstNode* funNode = astCreateNode(AST_FUN_DEC);
-    tokenDeepCopy(&parser->current, &funNode->token);
+    parserTakeToken(parser, &funNode->token);
     AstBin* children = funNode->children;
 
     parserLookAhead(parser);
 
-    if (parser->lookAhead.type == LPAR)  // ident(
+    if (parser->lookAhead->type == LPAR)  // ident(
     {
         children->left = parseParams(parser);
     }
-    else if (parser->lookAhead.type == ASSIGN)  // ident=(
+    else if (parser->lookAhead->type == ASSIGN)  // ident=(
 
     {
         funNode->type = AST_FUN_SET;
         parserAdvance(parser);  // consume '='
         children->left = parseParams(parser);
 
-        int paramCount = ((AstN*)children->left->children)->childrenList->count;
+        int paramCount = ((AstN*)children->left->children)->nodes.count;
         if (paramCount != 1)
-            errorExit(SYNTAX_ERROR, "Setter has invalid count of arguments", parser->current.line,
-                      &parser->current);
+            errorExit(SYNTAX_ERROR, "Setter has invalid count of arguments",
+                      tokenLine(&parser->current), &parser->current);
     }
-    else if (parser->lookAhead.type == LCURLY)
+    else if (parser->lookAhead->type == LCURLY)
     {
         funNode->type = AST_FUN_GET;
     }
     else
     {
         errorExit(SYNTAX_ERROR, "Invalid syntax, expected '(' or '=' or '{' after identifier",
-                  parser->current.line, &parser->current);
+                  tokenLine(&parser->current), &parser->current);
     }
 
     SymbolKind symType = SYM_FUNC;
@@ -699,18 +796,21 @@ AstNode* parseFunDec(Parser* parser)
 
     int paramsCount = 0;
     if ((AstNode*)children->left)
-        paramsCount = ((AstN*)children->left->children)->childrenList->count;
+        paramsCount = ((AstN*)children->left->children)->nodes.count;
 
-    Symbol* funSymbol =
-        symbolCreate(funNode->token.value->stringVal, TYPE_NULL, symType, paramsCount);
-
-    Symbol* foundSymbol = symTableStackFindSymbol(parser->symStack, funSymbol->name);
+    Symbol* funSymbol = NULL;
+    Symbol* foundSymbol = symTableStackFindUnique(parser->symStack, funNode->token.value->stringVal,
+                                                  symType, paramsCount);
     if (foundSymbol && foundSymbol->numOfParams == paramsCount && foundSymbol->declared)
     {
-        errorExit(SEM_REDEF, "Conflicting declaration of function", funNode->token.line,
+        errorExit(SEM_REDEF, "Conflicting declaration of function", tokenLine(&funNode->token),
                   &funNode->token);
     }
-    else if (foundSymbol && !foundSymbol->declared)
+
+    // Nový symbol vzniká jen pro dosud neznámou funkci
+    funSymbol = symbolCreate(&parser->symStack->arena, funNode->token.value->stringVal, TYPE_NULL,
+                             symType, paramsCount);
+    if (foundSymbol)
     {
         foundSymbol->declared = true;
     }
@@ -719,31 +819,34 @@ AstNode* parseFunDec(Parser* parser)
         scopeAddSymbol(parser->symStack->scopes[0], funSymbol);
         funSymbol->declared = true;
     }
+    funNode->symbol = foundSymbol ? foundSymbol : funSymbol;
 
     symTableStackPush(parser->symStack);
 
-    ListItem* listItem = NULL;
     AstNode* paramNode = children->left;
-    if (paramNode) listItem = ((AstN*)paramNode->children)->childrenList->firstItem;
+    NodeVec* params = paramNode ? &((AstN*)paramNode->children)->nodes : NULL;
     int top = parser->symStack->top;
 
-    while (listItem)
+    for (long i = 0; params && i < params->count; i++)
     {
-        Symbol* symbol =
-            symbolCreate(listItem->item->token.value->stringVal, TYPE_UNKNOWN, SYM_PARAM, 0);
+        AstNode* param = params->items[i];
+        Symbol* symbol = symbolCreate(&parser->symStack->arena, param->token.value->stringVal,
+                                      TYPE_UNKNOWN, SYM_PARAM, 0);
         Symbol* foundSymbol =
             scopeFindSymbol(parser->symStack->scopes[parser->symStack->top], symbol->name);
         if (foundSymbol)
             errorExit(SEM_REDEF, "Redefinition of parameter in function",
-                      listItem->item->token.line, &listItem->item->token);
-        listItem = listItem->next;
+                      tokenLine(&param->token), &param->token);
+        param->symbol = symbol;
         scopeAddSymbol(parser->symStack->scopes[top], symbol);
     }
 
     children->right = parseBlock(parser, funSymbol);
     funNode->expressionType = funSymbol->expressionType;
+    funNode->spanEnd = children->right->spanEnd;
 
-    symTableStackPop(parser->symStack);
+    // Scope parametrů a těla zůstává pro další průchody
+    funNode->scope = symTableStackFreeze(parser->symStack);
 
     return funNode;
 }
@@ -758,7 +861,7 @@ AstNode* parseParams(Parser* parser)
 
     parserLookAhead(parser);
 
-    if (parser->lookAhead.type == RPAR)
+    if (parser->lookAhead->type == RPAR)
     {
         parserAdvance(parser);
         parserValidate(parser, RPAR, "Invalid syntax, expected ')'");
@@ -771,26 +874,26 @@ AstNode* parseParams(Parser* parser)
         parserValidate(parser, IDENTIFIER, "Invalid parameter, expected identifier");
 
         AstNode* leaf = astCreateNode(AST_IDENTIFIER);
-        tokenDeepCopy(&parser->current, &leaf->token);
-        listAppend(children->childrenList, leaf);
+        parserTakeToken(parser, &leaf->token);
+        nodeVecPush(&children->nodes, leaf);
 
         parserLookAhead(parser);
 
-        if (parser->lookAhead.type == COMMA)
+        if (parser->lookAhead->type == COMMA)
         {
             parserAdvance(parser);
             parserLookAhead(parser);
             continue;
         }
-        if (parser->lookAhead.type == RPAR)
+        if (parser->lookAhead->type == RPAR)
         {
             parserAdvance(parser);
             parserValidate(parser, RPAR, "Invalid syntax, expected ')'");
             break;
         }
 
-        errorExit(SYNTAX_ERROR, "Missing comma or ')' in parameter list", parser->lookAhead.line,
-                  &parser->lookAhead);
+        errorExit(SYNTAX_ERROR, "Missing comma or ')' in parameter list",
+                  tokenLine(parser->lookAhead), parser->lookAhead);
     }
 
     return node;
@@ -802,7 +905,7 @@ AstNode* parseArguments(Parser* parser)
     AstNode* leaf = NULL;
     parserLookAhead(parser);
 
-    if (parser->lookAhead.type == RPAR)
+    if (parser->lookAhead->type == RPAR)
     {
         parserAdvance(parser);
         return node;
@@ -828,34 +931,34 @@ AstNode* parseArguments(Parser* parser)
                 break;
 
             default:
-                errorExit(SYNTAX_ERROR, "Invalid function argument", parser->current.line,
+                errorExit(SYNTAX_ERROR, "Invalid function argument", tokenLine(&parser->current),
                           &parser->current);
         }
 
         if (leaf)
         {
-            tokenDeepCopy(&parser->current, &leaf->token);
+            parserTakeToken(parser, &leaf->token);
             assignTypeFromToken(leaf, parser);
-            listAppend(children->childrenList, leaf);
+            nodeVecPush(&children->nodes, leaf);
         }
 
         parserLookAhead(parser);
 
-        if (parser->lookAhead.type == COMMA)
+        if (parser->lookAhead->type == COMMA)
         {
             parserAdvance(parser);  // consume ','
             parserLookAhead(parser);
             continue;
         }
-        else if (parser->lookAhead.type == RPAR)
+        else if (parser->lookAhead->type == RPAR)
         {
             parserAdvance(parser);  // consume ')'
             break;
         }
         else
         {
-            errorExit(SYNTAX_ERROR, "Missing comma or ')' in argument list", parser->lookAhead.line,
-                      &parser->lookAhead);
+            errorExit(SYNTAX_ERROR, "Missing comma or ')' in argument list",
+                      tokenLine(parser->lookAhead), parser->lookAhead);
         }
     }
 
@@ -866,41 +969,29 @@ AstNode* parseFunCall(Parser* parser)
 {
     parserValidate(parser, IDENTIFIER, "Invalid syntax, expected function identifier");
 
-    Token* funcIdentifierToken = malloc(sizeof(Token));
-
-    if (!funcIdentifierToken) errorExit(INTERNAL_ERROR, "Couldnt malloc token", 0, NULL);
-
-    tokenDeepCopy(&parser->current, funcIdentifierToken);
+    AstNode* node = astCreateNode(AST_FUN_CALL);
+    parserTakeToken(parser, &node->token);
 
     parserAdvance(parser);
     parserValidate(parser, LPAR, "Invalid syntax, expected '(' after identifier");
 
-    AstNode* node = astCreateNode(AST_FUN_CALL);
-    tokenDeepCopy(funcIdentifierToken, &node->token);
-    freeToken(funcIdentifierToken);
-    free(funcIdentifierToken);
     ((AstBin*)node->children)->right = parseArguments(parser);
     if (((AstBin*)node->children)->right)
     {
     }
     int argCount = 0;
 
-    Symbol* funCall = symbolCreate(node->token.value->stringVal, TYPE_UNKNOWN, SYM_FUNC, argCount);
-
-    Symbol* funDec = NULL;
-    if (funCall)
-    {
-        funDec = symTableStackFindSymbol(parser->symStack, funCall->name);
-    }
+    Symbol* funDec =
+        symTableStackFindUnique(parser->symStack, node->token.value->stringVal, SYM_FUNC, argCount);
 
+    node->symbol = funDec;
     if (!funDec)
-        listAppend(parser->resolveLater, node);
+        nodeVecPush(parser->resolveLater, node);
     else
         node->expressionType = funDec->expressionType;
 
     parserAdvance(parser);
     parserValidate(parser, EOL, "Invalid syntax, expected 'EOL' after identifier");
-    freeSymbol(funCall);
 
     return node;
 }
@@ -913,7 +1004,7 @@ AstNode* parseIfj(Parser* parser)
     parserValidate(parser, DOT, "Invalid syntax, expected '.' after 'Ifj'");
     parserLookAhead(parser);
 
-    if (parser->lookAhead.type == EOL) parserAdvance(parser);
+    if (parser->lookAhead->type == EOL) parserAdvance(parser);
 
     parserAdvance(parser);
     parserValidate(parser, IDENTIFIER, "Invalid syntax, expected function name after '.'");
@@ -935,12 +1026,14 @@ AstNode* parseVarDec(Parser* parser)
     int top = parser->symStack->top;
 
     AstNode* leaf = astCreateNode(AST_VAR_DEC);
-    tokenDeepCopy(&parser->current, &leaf->token);
+    parserTakeToken(parser, &leaf->token);
     Symbol* funSym = scopeFindSymbol(parser->symStack->scopes[top], leaf->token.value->stringVal);
-    if (funSym) errorExit(SEM_REDEF, "Redefining variable", leaf->token.line, &leaf->token);
+    if (funSym) errorExit(SEM_REDEF, "Redefining variable", tokenLine(&leaf->token), &leaf->token);
 
-    Symbol* symbol = symbolCreate(leaf->token.value->stringVal, TYPE_NULL, SYM_VAR, 0);
+    Symbol* symbol = symbolCreate(&parser->symStack->arena, leaf->token.value->stringVal,
+                                  TYPE_NULL, SYM_VAR, 0);
     scopeAddSymbol(parser->symStack->scopes[top], symbol);
+    leaf->symbol = symbol;
 
     parserAdvance(parser);
     parserValidate(parser, EOL, "Invalid syntax, expected EOL after ID");
@@ -953,7 +1046,7 @@ AstNode* parseVarAssign(Parser* parser)
     parserAdvance(parser);
 
     AstNode* leaf = astCreateNode(AST_IDENTIFIER);
-    tokenDeepCopy(&parser->current, &leaf->token);
+    parserTakeToken(parser, &leaf->token);
 
     parserAdvance(parser);
     parserValidate(parser, ASSIGN, "Invalid syntax, expected '=' after ID");
@@ -966,24 +1059,28 @@ AstNode* parseVarAssign(Parser* parser)
 
     if (!leafSymbol && leaf->token.type != GLOBAL_IDENTIFIER)
     {
-        Symbol* setterSym = symbolCreate(leaf->token.value->stringVal, TYPE_UNKNOWN, SYM_SET, 1);
-        Symbol* setter = symTableStackFindSymbol(parser->symStack, setterSym->name);
+        Symbol* setter =
+            symTableStackFindUnique(parser->symStack, leaf->token.value->stringVal, SYM_SET, 1);
 
         if (!setter && !leafSymbol)
         {
-            errorExit(SEM_UNDEF, "Undefined variable", leaf->token.line, &leaf->token);
+            errorExit(SEM_UNDEF, "Undefined variable", tokenLine(&leaf->token), &leaf->token);
         }
+        leaf->symbol = setter;
     }
 
     else if (!leafSymbol)
     {
-        leafSymbol = symbolCreate(leaf->token.value->stringVal, TYPE_UNKNOWN, SYM_VAR, 0);
+        leafSymbol = symbolCreate(&parser->symStack->arena, leaf->token.value->stringVal,
+                                  TYPE_UNKNOWN, SYM_VAR, 0);
         scopeAddSymbol(parser->symStack->scopes[0], leafSymbol);
     }
 
+    if (leafSymbol) leaf->symbol = leafSymbol;
+
     parserLookAhead(parser);
 
-    switch (parser->lookAhead.type)
+    switch (parser->lookAhead->type)
     {
         case KW_IFJ:
             children->right = parseIfj(parser);
@@ -992,7 +1089,7 @@ AstNode* parseVarAssign(Parser* parser)
         case IDENTIFIER:
             parserAdvance(parser);  // preapare token
             parserLookAhead(parser);
-            if (parser->lookAhead.type == LPAR)
+            if (parser->lookAhead->type == LPAR)
             {
                 children->right = parseFunCall(parser);
                 semanticExpression(children->right);
@@ -1014,7 +1111,9 @@ AstNode* parseVarAssign(Parser* parser)
     if (leafSymbol) leafSymbol->expressionType = leaf->expressionType;
     node->expressionType = children->right->expressionType;
 
-    if ((node->expressionType & TYPE_UNKNOWN) == 1) listAppend(parser->resolveLater, node);
+    // Proměnná bez známého typu se dopočítá i tehdy, když je typ pravé strany známý
+    if ((node->expressionType & TYPE_UNKNOWN) || leaf->expressionType == TYPE_UNKNOWN)
+        nodeVecPush(parser->resolveLater, node);
 
     return node;
 }
@@ -1028,35 +1127,41 @@ AstNode* parseReturn(Parser* parser, Symbol* funSym)
     AstBin* children = node->children;
     children->right = parseExp(parser);
     if (!children->right)
-        errorExit(SYNTAX_ERROR, "return is missing expression", node->token.line, &node->token);
+        errorExit(SYNTAX_ERROR, "return is missing expression", tokenLine(&node->token),
+                  &node->token);
     semanticExpression(children->right);
     if ((funSym->expressionType & TYPE_UNKNOWN) == 1)
         funSym->expressionType = children->right->expressionType;
     else
         funSym->expressionType = funSym->expressionType | children->right->expressionType;
 
+    // Typ funkce se dopočítá, až budou známy typy výrazu
+    node->symbol = funSym;
+    if ((children->right->expressionType & TYPE_UNKNOWN) && parser->resolveLater)
+        nodeVecPush(parser->resolveLater, node);
+
     return node;
 }
 
-void parseIfChain(Parser* p, SLList* list, Symbol* funSym)
+void parseIfChain(Parser* p, NodeVec* list, Symbol* funSym)
 {
     AstNode* node = parseIf(p, funSym);
-    listAppend(list, node);
+    nodeVecPush(list, node);
     parserLookAhead(p);
 
-    while (p->lookAhead.type == KW_ELSE)
+    while (p->lookAhead->type == KW_ELSE)
     {
         parserAdvance(p);  // consume ELSE
         parserLookAhead(p);
 
         AstNode* node;
 
-        if (p->lookAhead.type == KW_IF)
+        if (p->lookAhead->type == KW_IF)
             node = parseIfElse(p, funSym);
         else
             node = parseElse(p, funSym);
 
-        listAppend(list, node);
+        nodeVecPush(list, node);
 
         parserLookAhead(p);
     }
@@ -1080,7 +1185,7 @@ AstNode* parseIf(Parser* parser, Symbol* funSym)
 
     symTableStackPush(parser->symStack);
     children->right = parseBlock(parser, funSym);
-    symTableStackPop(parser->symStack);
+    children->right->scope = symTableStackFreeze(parser->symStack);
     return node;
 }
 
@@ -1099,7 +1204,7 @@ AstNode* parseIfElse(Parser* parser, Symbol* funSym)
 
     symTableStackPush(parser->symStack);
     children->right = parseBlock(parser, funSym);
-    symTableStackPop(parser->symStack);
+    children->right->scope = symTableStackFreeze(parser->symStack);
     return node;
 }
 
@@ -1110,7 +1215,7 @@ AstNode* parseElse(Parser* parser, Symbol* funSym)
 
     symTableStackPush(parser->symStack);
     children->right = parseBlock(parser, funSym);
-    symTableStackPop(parser->symStack);
+    children->right->scope = symTableStackFreeze(parser->symStack);
     return node;
 }
 
@@ -1125,101 +1230,89 @@ AstNode* parseWhile(Parser* parser, Symbol* funSym)
     AstBin* children = node->children;
     children->left = parseExp(parser);
     if (!children->left)
-        errorExit(SYNTAX_ERROR, "while is missing expression", node->token.line, &node->token);
+        errorExit(SYNTAX_ERROR, "while is missing expression", tokenLine(&node->token),
+                  &node->token);
     semanticExpression(children->left);
 
     parserValidate(parser, RPAR, "Invalid syntax, expected ')' after '(' or parameters");
 
     symTableStackPush(parser->symStack);
     children->right = parseBlock(parser, funSym);
-    symTableStackPop(parser->symStack);
+    children->right->scope = symTableStackFreeze(parser->symStack);
     return node;
 }
 
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
-//* ----------------------------------------------------- */
-//* ----------------------------------------------------- */
-//*  -1 = shift, 1 = reduce, 0 = error
-//*  rows = stack top, columns = current token
-//* ----------------------------------------------------- */
-//* ----------------------------------------------------- */
+//*  S = shift, B/N/P = reduce binary/not/parenthesis, _ = error
+//*  rows = operator nearest to stack top, columns = current token
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
 //* cmp - < > <= >= , MD - * / PM - +-  /
 
-const int PRECEDENCE_TABLE[NUM_PRECEDENCE][NUM_PRECEDENCE] = {
-    /*        id  is   T   (   )  MD  PM  cmp eq  &&  ||   !   $ */
-    /* id */ {+0, -1, +0, +0, -1, -1, -1, -1, -1, -1, -1, +0, +1},
-    /* is */ {+0, +0, -1, +0, -1, +0, +0, +0, +1, +1, +1, +0, +1},
-    /*TYPE*/ {+0, +0, +0, +0, -1, +0, +0, +0, -1, -1, -1, +0, +1},
-    /* (  */ {-1, -1, +0, -1, -1, -1, -1, -1, -1, -1, -1, -1, +1},
-    /* )  */ {+0, +1, +0, +0, -1, +1, +1, +1, +1, +1, +1, -1, +1},
-    /* MD */ {-1, -1, +0, -1, -1, +1, +1, +1, +1, +1, +1, -1, +1},
-    /* PM */ {-1, -1, +0, -1, -1, -1, +1, +1, +1, +1, +1, -1, +1},
-    /* cmp*/ {-1, -1, +0, -1, -1, -1, -1, +1, +1, +1, +1, -1, +1},
-    /* eq */ {-1, -1, +0, -1, -1, -1, -1, -1, +1, +1, +1, -1, +1},
-    /* && */ {-1, -1, +0, -1, -1, -1, -1, -1, -1, +1, +1, -1, +1},
-    /* || */ {-1, -1, +0, -1, -1, -1, -1, -1, -1, -1, +1, -1, +1},
-    /* NOT*/ {-1, -1, +0, -1, +1, +1, +1, +1, +1, +1, +1, +1, +1},
-    /* $  */ {-1, -1, -1, -1, +1, -1, -1, -1, -1, -1, -1, -1, +1}};
+const unsigned char PRECEDENCE_CLASS[NONE + 1] = {
+    [IDENTIFIER] = PREC_ID,
+    [GLOBAL_IDENTIFIER] = PREC_ID,
+    [INT_LITERAL] = PREC_ID,
+    [FLOAT_LITERAL] = PREC_ID,
+    [STRING_LITERAL] = PREC_ID,
+    [MULTILINE_STRING_LITERAL] = PREC_ID,
+    [KW_VAL_NULL] = PREC_ID,
+    [KW_TYPE_NUM] = PREC_TYPE,
+    [KW_TYPE_NULL] = PREC_TYPE,
+    [KW_TYPE_BOOL] = PREC_TYPE,
+    [KW_TYPE_STRING] = PREC_TYPE,
+    [IS_EQUAL] = PREC_EQ,
+    [IS_NOT_EQUAL] = PREC_EQ,
+    [IS_SMALLER] = PREC_CMP,
+    [IS_SMALLER_OR_EQUAL] = PREC_CMP,
+    [IS_BIGGER] = PREC_CMP,
+    [IS_BIGGER_OR_EQUAL] = PREC_CMP,
+    [PLUS] = PREC_PLUSMINUS,
+    [MINUS] = PREC_PLUSMINUS,
+    [MULTIPLY] = PREC_MULDIV,
+    [DIVIDE] = PREC_MULDIV,
+    [LPAR] = PREC_LPAREN,
+    [LOGICAL_AND] = PREC_AND,
+    [LOGICAL_OR] = PREC_OR,
+    [LOGICAL_NOT] = PREC_NOT,
+    [KW_IS] = PREC_IS,
+    [EOL] = PREC_END,  // nebo speciální end symbol
+    [RPAR] = PREC_END,
+};
+
+#define _ PREC_ERROR
+#define S PREC_SHIFT
+#define B PREC_REDUCE_BINARY
+#define N PREC_REDUCE_NOT
+#define P PREC_REDUCE_PAREN
+
+const unsigned char PRECEDENCE_TABLE[NUM_PRECEDENCE][NUM_PRECEDENCE] = {
+    /*        inv id  is  T   (   )   MD  PM  cmp eq  &&  ||  !   $ */
+    /*inv */ {_,  _,  _,  _,  _,  _,  _,  _,  _,  _,  _,  _,  _,  _},
+    /* id */ {_,  _,  S,  _,  _,  S,  S,  S,  S,  S,  S,  S,  _,  B},
+    /* is */ {_,  _,  _,  S,  _,  S,  _,  _,  _,  B,  B,  B,  _,  B},
+    /*TYPE*/ {_,  _,  _,  _,  _,  S,  _,  _,  _,  S,  S,  S,  _,  B},
+    /* (  */ {_,  S,  S,  _,  S,  S,  S,  S,  S,  S,  S,  S,  S,  P},
+    /* )  */ {_,  _,  B,  _,  _,  S,  B,  B,  B,  B,  B,  B,  S,  B},
+    /* MD */ {_,  S,  S,  _,  S,  S,  B,  B,  B,  B,  B,  B,  S,  B},
+    /* PM */ {_,  S,  S,  _,  S,  S,  S,  B,  B,  B,  B,  B,  S,  B},
+    /* cmp*/ {_,  S,  S,  _,  S,  S,  S,  S,  B,  B,  B,  B,  S,  B},
+    /* eq */ {_,  S,  S,  _,  S,  S,  S,  S,  S,  B,  B,  B,  S,  B},
+    /* && */ {_,  S,  S,  _,  S,  S,  S,  S,  S,  S,  B,  B,  S,  B},
+    /* || */ {_,  S,  S,  _,  S,  S,  S,  S,  S,  S,  S,  B,  S,  B},
+    /* NOT*/ {_,  S,  S,  _,  S,  N,  N,  N,  N,  N,  N,  N,  N,  N},
+    /* $  */ {_,  S,  S,  S,  S,  _,  S,  S,  S,  S,  S,  S,  S,  _}};
+
+#undef _
+#undef S
+#undef B
+#undef N
+#undef P
 
 PrecedenceSymbol getPrecedenceSymbol(TokenType tokenType)
 {
-    switch (tokenType)
-    {
-        case IDENTIFIER:
-        case GLOBAL_IDENTIFIER:
-        case INT_LITERAL:
-        case FLOAT_LITERAL:
-        case STRING_LITERAL:
-        case MULTILINE_STRING_LITERAL:
-        case KW_VAL_NULL:
-            return PREC_ID;
-
-        case KW_TYPE_NUM:
-        case KW_TYPE_NULL:
-        case KW_TYPE_BOOL:
-        case KW_TYPE_STRING:
-            return PREC_TYPE;
-
-        case IS_EQUAL:
-        case IS_NOT_EQUAL:
-            return PREC_EQ;  // ==, !=
-        case IS_SMALLER:
-        case IS_SMALLER_OR_EQUAL:
-        case IS_BIGGER:
-        case IS_BIGGER_OR_EQUAL:
-            return PREC_CMP;
-
-        case PLUS:
-        case MINUS:
-            return PREC_PLUSMINUS;
-
-        case MULTIPLY:
-        case DIVIDE:
-            return PREC_MULDIV;
-
-        case LPAR:
-            return PREC_LPAREN;
-        case LOGICAL_AND:
-            return PREC_AND;
-        case LOGICAL_OR:
-            return PREC_OR;
-
-        case LOGICAL_NOT:
-            return PREC_NOT;
-
-        case KW_IS:  // keyword `is`
-            return PREC_IS;
-
-        case EOL:  // nebo speciální end symbol
-        case RPAR:
-            return PREC_END;
-
-        default:
-            return NUM_PRECEDENCE;  // invalid / error
-    }
+    return (PrecedenceSymbol)PRECEDENCE_CLASS[tokenType];
 }
 
 AstNode* popCheck(AstStack* stack, const char* msg)
@@ -1239,7 +1332,7 @@ AstNode* reduceExpression(AstStack* stack)
 
     if (right->type == AST_OPERATOR || left->type == AST_OPERATOR)
         errorExit(SYNTAX_ERROR, "Invalid expression, can't use operator as operand",
-                  right->token.line, NULL);
+                  tokenLine(&right->token), NULL);
 
     op->type = AST_EXPRESSION;
     ((AstBin*)op->children)->left = left;
@@ -1251,6 +1344,12 @@ AstNode* reduceExpression(AstStack* stack)
 AstNode* reduceNot(AstStack* stack)
 {
     AstNode* right = popCheck(stack, "Reduce: Missing right operand");
+
+    // Zarážka '(' je také AST_OPERATOR, "(!)" tak skončí syntaktickou chybou
+    if (right->type == AST_OPERATOR)
+        errorExit(SYNTAX_ERROR, "Invalid expression, '!' is missing operand",
+                  tokenLine(&right->token), NULL);
+
     AstNode* op = popCheck(stack, "Reduce: Missing operator");
 
     op->type = AST_EXPRESSION;
@@ -1264,10 +1363,17 @@ AstNode* reducePar(AstStack* stack)
     AstNode* op = popCheck(stack, "Reduce: Missing operator");
     AstNode* left = popCheck(stack, "Reduce: Missing left operand");
 
-    astDispose(left);
+    if (left != &parenMarker) astDispose(left);
     return op;
 }
 
+/**
+ * @brief Create expression node for shifted token, token is moved into the node
+ *
+ * @param t token to take (its value is left NULL)
+ * @param parser parser used to resolve identifiers
+ * @return AstNode* new node
+ */
 AstNode* createNodeFromToken(Token* t, Parser* parser)
 {
     AstNode* node;
@@ -1297,16 +1403,16 @@ AstNode* createNodeFromToken(Token* t, Parser* parser)
             node = astCreateNode(AST_OPERATOR);
             break;
     }
-    tokenDeepCopy(t, &node->token);
+    node->token = *t;
+    t->value = NULL;
     assignTypeFromToken(node, parser);
     return node;
 }
 
 AstNode* parseExp(Parser* parser)
 {
-    AstStack stack;
-    astStackInit(&stack, ASTSTACK_MAX);
-    if (!stack.array) return NULL;
+    AstStack* stack = &parser->expStack;
+    astStackReset(stack);
     int parenCount = 0;
     while (true)
     {
@@ -1320,137 +1426,139 @@ AstNode* parseExp(Parser* parser)
         if (parser->current.type == KW_IS)
         {
             parserLookAhead(parser);
-            if (parser->lookAhead.type != KW_TYPE_NUM && parser->lookAhead.type != KW_TYPE_STRING &&
-                parser->lookAhead.type != KW_TYPE_NULL && parser->lookAhead.type != KW_TYPE_BOOL)
+            if (parser->lookAhead->type != KW_TYPE_NUM && parser->lookAhead->type != KW_TYPE_STRING &&
+                parser->lookAhead->type != KW_TYPE_NULL && parser->lookAhead->type != KW_TYPE_BOOL)
             {
                 errorExit(SYNTAX_ERROR, "Invalid syntax expected type after IS",
-                          parser->lookAhead.line, &parser->lookAhead);
+                          tokenLine(parser->lookAhead), parser->lookAhead);
             }
         }
 
-        AstNode* top = astStackIsEmpty(&stack) ? NULL : astStackNextOp(&stack);
-        int currentIdx = getPrecedenceSymbol(parser->current.type);
-        int stackIdx = top ? getPrecedenceSymbol(top->token.type) : PREC_END;
-        int action = PRECEDENCE_TABLE[stackIdx][currentIdx];
-
-        AstNode* node = createNodeFromToken(&parser->current, parser);
+        AstNode* top = astStackIsEmpty(stack) ? NULL : astStackNextOp(stack);
+        PrecedenceSymbol stackTop = top ? PRECEDENCE_CLASS[top->token.type] : PREC_END;
+        PrecedenceSymbol current = PRECEDENCE_CLASS[parser->current.type];
+        PrecedenceAction action = PRECEDENCE_TABLE[stackTop][current];
 
-        if (action == -1)
-        {
-            assignTypeFromToken(node, parser);
-            astStackPush(&stack, node);
-            parserAdvance(parser);
-        }
-        else if (action == 1)
+        switch (action)
         {
-            AstNode* reduced;
-            if (top->token.type == LPAR)
-            {
-                astDispose(node);
-                reduced = reducePar(&stack);
-                parserAdvance(parser);
-            }
-            else if (top->token.type == LOGICAL_NOT)
-            {
-                reduced = reduceNot(&stack);
+            case PREC_SHIFT:
+                // Uzel vzniká až při shiftu, redukce jen přeskládá existující uzly
+                if (parser->current.type == LPAR)
+                    astStackPush(stack, &parenMarker);
+                else
+                    astStackPush(stack, createNodeFromToken(&parser->current, parser));
                 parserAdvance(parser);
-            }
-            else
-            {
+                break;
+
+            case PREC_REDUCE_PAREN:
+                astStackPush(stack, reducePar(stack));
+                parserAdvance(parser);  // ')'
+                break;
+
+            case PREC_REDUCE_NOT:
+            case PREC_REDUCE_BINARY:
+                // Aktuální token zůstává, ')' se započítá znovu v dalším kroku
                 if (parser->current.type == RPAR) parenCount++;
-                reduced = reduceExpression(&stack);
-            }
+                astStackPush(stack, action == PREC_REDUCE_NOT ? reduceNot(stack)
+                                                              : reduceExpression(stack));
+                break;
 
-            if (!reduced) errorExit(SEM_TYPE, "Invalid expression", parser->lookAhead.line, NULL);
-            astStackPush(&stack, reduced);
-        }
-        else
-        {
-            errorExit(SYNTAX_ERROR, "Invalid token in expression", parser->lookAhead.line,
-                      &parser->current);
+            default:
+                errorExit(SYNTAX_ERROR, "Invalid token in expression", tokenLine(&parser->current),
+                          &parser->current);
         }
     }
-    while (stack.topIndex > 0)
+    while (stack->topIndex > 0)
     {
-        AstNode* reduced;
-        AstNode* top = astStackNextOp(&stack);
-        if (top->token.type == LPAR)
-            reduced = reducePar(&stack);
-        else if (top->token.type == LOGICAL_NOT)
-            reduced = reduceNot(&stack);
-        else
-            reduced = reduceExpression(&stack);
-
-        if (!reduced) errorExit(SEM_TYPE, "Invalid expression", parser->lookAhead.line, NULL);
-        astStackPush(&stack, reduced);
+        AstNode* top = astStackNextOp(stack);
+        PrecedenceSymbol stackTop = top ? PRECEDENCE_CLASS[top->token.type] : PREC_END;
+        switch (PRECEDENCE_TABLE[stackTop][PREC_END])
+        {
+            case PREC_REDUCE_PAREN:
+                astStackPush(stack, reducePar(stack));
+                break;
+            case PREC_REDUCE_NOT:
+                astStackPush(stack, reduceNot(stack));
+                break;
+            case PREC_REDUCE_BINARY:
+                astStackPush(stack, reduceExpression(stack));
+                break;
+            default:
+                errorExit(SYNTAX_ERROR, "Missing operator in expression",
+                          tokenLine(&parser->current), NULL);
+        }
     }
 
     AstNode* expression = NULL;
 
-    if (!astStackIsEmpty(&stack))
+    if (!astStackIsEmpty(stack))
     {
-        expression = astStackPop(&stack);
+        expression = astStackPop(stack);
+
+        // Samotný operátor, např. "!" před ')', se nezredukoval na výraz
+        if (expression->type == AST_OPERATOR)
+            errorExit(SYNTAX_ERROR, "Invalid expression, operator is missing operand",
+                      tokenLine(&expression->token), NULL);
     }
 
     if (parenCount != 0)
-        errorExit(SYNTAX_ERROR, "Mismatched parentheses in expression", parser->lookAhead.line,
+        errorExit(SYNTAX_ERROR, "Mismatched parentheses in expression", tokenLine(&parser->current),
                   NULL);
 
-    astStackDispose(&stack);
-
     return expression;
 }
 
 void loadIFJBuiltins(SymTableStack* stack)
 {
     Scope* global = stack->scopes[0];
+    Arena* arena = &stack->arena;
 
     // read_str
-    Symbol* s1 = symbolCreate("read_str", (TYPE_STRING | TYPE_NULL), SYM_FUNC, 0);
+    Symbol* s1 = symbolCreate(arena, "read_str", (TYPE_STRING | TYPE_NULL), SYM_FUNC, 0);
     s1->declared = true;
     scopeAddSymbol(global, s1);
 
     // read_num
-    Symbol* s2 = symbolCreate("read_num", (TYPE_FLOAT | TYPE_NULL), SYM_FUNC, 0);
+    Symbol* s2 = symbolCreate(arena, "read_num", (TYPE_FLOAT | TYPE_NULL), SYM_FUNC, 0);
     s2->declared = true;
     scopeAddSymbol(global, s2);
     // write
-    Symbol* s3 = symbolCreate("write", TYPE_NULL, SYM_FUNC, 1);
+    Symbol* s3 = symbolCreate(arena, "write", TYPE_NULL, SYM_FUNC, 1);
     s3->declared = true;
     scopeAddSymbol(global, s3);
 
     // floor
-    Symbol* s5 = symbolCreate("floor", TYPE_FLOAT, SYM_FUNC, 1);
+    Symbol* s5 = symbolCreate(arena, "floor", TYPE_FLOAT, SYM_FUNC, 1);
     s5->declared = true;
     scopeAddSymbol(global, s5);
 
     // str
-    Symbol* s6 = symbolCreate("str", TYPE_STRING, SYM_FUNC, 1);
+    Symbol* s6 = symbolCreate(arena, "str", TYPE_STRING, SYM_FUNC, 1);
     s6->declared = true;
     scopeAddSymbol(global, s6);
 
     // lenght
-    Symbol* s7 = symbolCreate("length", TYPE_INT, SYM_FUNC, 1);
+    Symbol* s7 = symbolCreate(arena, "length", TYPE_INT, SYM_FUNC, 1);
     s7->declared = true;
     scopeAddSymbol(global, s7);
 
     // substring
-    Symbol* s8 = symbolCreate("substring", (TYPE_STRING | TYPE_NULL), SYM_FUNC, 3);
+    Symbol* s8 = symbolCreate(arena, "substring", (TYPE_STRING | TYPE_NULL), SYM_FUNC, 3);
     s8->declared = true;
     scopeAddSymbol(global, s8);
 
     // strcmp
-    Symbol* s9 = symbolCreate("strcmp", TYPE_INT, SYM_FUNC, 2);
+    Symbol* s9 = symbolCreate(arena, "strcmp", TYPE_INT, SYM_FUNC, 2);
     s9->declared = true;
     scopeAddSymbol(global, s9);
 
     // ord
-    Symbol* s10 = symbolCreate("ord", TYPE_INT, SYM_FUNC, 2);
+    Symbol* s10 = symbolCreate(arena, "ord", TYPE_INT, SYM_FUNC, 2);
     s10->declared = true;
     scopeAddSymbol(global, s10);
 
     // substring
-    Symbol* s11 = symbolCreate("chr", TYPE_STRING, SYM_FUNC, 1);
+    Symbol* s11 = symbolCreate(arena, "chr", TYPE_STRING, SYM_FUNC, 1);
     s11->declared = true;
     scopeAddSymbol(global, s11);
 
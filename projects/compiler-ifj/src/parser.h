@@ -12,7 +12,7 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#define ASTSTACK_MAX 100
+#define ASTSTACK_INITIAL_CAPACITY 64  // expression stack doubles when full
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -26,35 +26,29 @@
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
 
-typedef struct ListItem ListItem;
 typedef struct AstNode AstNode;
 
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
-//* Single Linked List Structs                            */
+//* Node Vector Structs                                   */
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
 
-/**
- * @brief Item of list with pointer to AST node and next item of list
- *
- */
-typedef struct ListItem
-{
-    AstNode* item;
-    ListItem* next;
-} ListItem;
+#define NODEVEC_INLINE 4  // children stored without extra allocation
 
 /**
- * @brief List for saving nodes as AST children in certain node types
+ * @brief Contiguous array of AST nodes, first NODEVEC_INLINE items live inside the struct
  *
+ * While the vector is small, items points to inlineItems, so a NodeVec must never be copied
+ * by value. Bigger vectors move to heap array growing geometrically.
  */
 typedef struct
 {
     long count;
-    ListItem* firstItem;
-    ListItem* lastItem;
-} SLList;
+    long capacity;
+    AstNode** items;
+    AstNode* inlineItems[NODEVEC_INLINE];
+} NodeVec;
 
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
@@ -100,6 +94,9 @@ typedef struct AstNode
     Token token;       // Token
     void* children;    // Pointer to Children of AST Binary or with 3 or more
     ExprType expressionType;
+    uint32_t spanEnd;  // Offset after closing '}' of functions and blocks, 0 for other nodes
+    Symbol* symbol;  // Resolved declaration (identifiers, declarations, calls), NULL if none
+    Scope* scope;    // Frozen scope of function or block, NULL for other nodes
 } AstNode;
 
 /**
@@ -118,7 +115,7 @@ typedef struct
  */
 typedef struct
 {
-    SLList* childrenList;  // Body of Block
+    NodeVec nodes;  // Body of Block
 } AstN;
 
 //* ----------------------------------------------------- */
@@ -127,14 +124,26 @@ typedef struct
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
 
+/**
+ * @brief Stack of the precedence parser, grows geometrically when full
+ *
+ */
+typedef struct
+{
+    AstNode** array;  // pole ukazatelů na AST uzly
+    int topIndex;     // index vrcholu zásobníku
+    int capacity;     // aktuální kapacita
+} AstStack;
+
 typedef struct
 {
     Scanner* scanner;
     SymTableStack* symStack;
     Token current;
-    Token lookAhead;
+    Token* lookAhead;  // Borrowed from scanner ring, valid until next parserAdvance
     AstNode* root;
-    SLList* resolveLater;
+    NodeVec* resolveLater;
+    AstStack expStack;  // Reused by every parseExp, only reset between expressions
 } Parser;
 
 //* ----------------------------------------------------- */
@@ -143,15 +152,9 @@ typedef struct
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
 
-typedef struct
-{
-    AstNode** array;  // pole ukazatelů na AST uzly
-    int topIndex;     // index vrcholu zásobníku
-    int capacity;     // aktuální kapacita
-} AstStack;
-
 typedef enum
 {
+    PREC_INVALID,    // token cannot appear in expression
     PREC_ID,         // identifier / literal
     PREC_IS,         // is (typ checking / comparison)
     PREC_TYPE,       // TYPE token
@@ -168,8 +171,20 @@ typedef enum
     NUM_PRECEDENCE
 } PrecedenceSymbol;
 
-// Table actions: -1 = shift, 0 = error, 1 = reduce
-extern const int PRECEDENCE_TABLE[NUM_PRECEDENCE][NUM_PRECEDENCE];
+typedef enum
+{
+    PREC_ERROR,          // syntax error
+    PREC_SHIFT,          // push current token
+    PREC_REDUCE_BINARY,  // E op E -> E
+    PREC_REDUCE_NOT,     // ! E -> E
+    PREC_REDUCE_PAREN,   // ( E ) -> E, consumes ')'
+} PrecedenceAction;
+
+// TokenType -> PrecedenceSymbol, PREC_INVALID for tokens outside expressions
+extern const unsigned char PRECEDENCE_CLASS[NONE + 1];
+
+// [operator nearest to stack top][current token] -> PrecedenceAction
+extern const unsigned char PRECEDENCE_TABLE[NUM_PRECEDENCE][NUM_PRECEDENCE];
 
 PrecedenceSymbol getPrecedenceSymbol(TokenType tokenType);
 
@@ -185,7 +200,7 @@ PrecedenceSymbol getPrecedenceSymbol(TokenType tokenType);
  * @param parser is pointer to uninitialized struct Parser
  * @param scanner pointer to initialized struct Scanner
  */
-Parser* parserInit(Scanner* scanner, SymTableStack* symStack, SLList* resolveLater);
+Parser* parserInit(Scanner* scanner, SymTableStack* symStack, NodeVec* resolveLater);
 /**
  * @brief load of next token to parser
  *
@@ -193,6 +208,23 @@ Parser* parserInit(Scanner* scanner, SymTableStack* symStack, SLList* resolveLat
  */
 void parserAdvance(Parser* parser);
 
+/**
+ * @brief Peek k-th token after current without consuming it
+ *
+ * @param parser - pointer to initialized struct Parser
+ * @param k - lookahead distance (0 = next token), less than TOKEN_RING_SIZE
+ * @return Token* owned by scanner, valid until it is consumed by parserAdvance
+ */
+Token* parserPeek(Parser* parser, unsigned k);
+
+/**
+ * @brief Move current token (with its value) to dst, current keeps only type and line
+ *
+ * @param parser - pointer to initialized struct Parser
+ * @param dst - token taking ownership of value
+ */
+void parserTakeToken(Parser* parser, Token* dst);
+
 /**
  * @brief Validates if curent token has correct type
  *
@@ -202,12 +234,15 @@ void parserValidate(Parser* parser, TokenType type, char* errorMessage);
 
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
-//* SLL Functions                                         */
+//* NodeVec Functions                                     */
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
 
-SLList* listInit();
-void listDispose(SLList* list);
+void nodeVecInit(NodeVec* vec);
+void nodeVecPush(NodeVec* vec, AstNode* node);
+void nodeVecDispose(NodeVec* vec);
+NodeVec* nodeVecCreate(void);
+void nodeVecDestroy(NodeVec* vec);
 
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
@@ -218,6 +253,8 @@ void listDispose(SLList* list);
 AstNode* astInit(void);
 void astDispose(AstNode* tree);
 AstNode* astCreateNode(AstNodeType type);
+bool astIsBinaryExpression(const AstNode* node);
+void astLeftSpine(AstNode* node, NodeVec* spine);
 
 //* ----------------------------------------------------- */
 //* ----------------------------------------------------- */
@@ -227,6 +264,7 @@ AstNode* astCreateNode(AstNodeType type);
 
 void astStackInit(AstStack* stack, int capacity);
 void astStackDispose(AstStack* stack);
+void astStackReset(AstStack* stack);
 bool astStackIsEmpty(AstStack* stack);
 bool astStackIsFull(const AstStack* stack);
 AstNode* astStackTop(AstStack* stack);
@@ -240,7 +278,7 @@ void astStackPush(AstStack* stack, AstNode* node);
 //* ----------------------------------------------------- */
 
 void parseProgram(Parser* p);
-void parseStList(Parser* parser, SLList* list, Symbol* funSym);
+void parseStList(Parser* parser, NodeVec* list, Symbol* funSym);
 AstNode* parseBlock(Parser* parser, Symbol* funSym);
 AstNode* parseClassDec(Parser* p);
 AstNode* parseStatement(Parser* p);
@@ -259,7 +297,7 @@ AstNode* parseElse(Parser* p, Symbol* funSym);
 AstNode* parseExp(Parser* p);
 AstNode* parseWhile(Parser* p, Symbol* funSym);
 
-void parseIfChain(Parser* p, SLList* list, Symbol* funSym);
+void parseIfChain(Parser* p, NodeVec* list, Symbol* funSym);
 /* ----------------------------------------------------- */
 /* Precedence                                            */
 /* ----------------------------------------------------- */
@@ -270,7 +308,7 @@ AstNode* reduceExpression(AstStack* stack);
 /* RESOLVE LATER EXPRESSIONS AND STUFF                    */
 /* ------------------------------------------------------ */
 
-void parserResolveLater(SLList list);
+void parserResolveLater(NodeVec* list);
 void loadIFJBuiltins(SymTableStack* stack);
 
 #endif  // PARSER_H
\ No newline at end of file
@@ -0,0 +1,362 @@
+/**
+ * @file prelex.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Parallel lexing of large sources split at newlines outside strings and comments
+ */
+
+#include "prelex.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "threadpool.h"
+
+/**
+ * @brief Lexical context the classification pass is in
+ */
+typedef enum
+{
+    LEX_CODE,
+    LEX_STRING,
+    LEX_MULTILINE,
+    LEX_LINE_COMMENT,
+    LEX_BLOCK_COMMENT,
+} LexState;
+
+/**
+ * @brief One part of source lexed by one task
+ */
+typedef struct
+{
+    // Input
+    const Scanner *source;  // whole-file scanner (buffer and kernels)
+    size_t start;
+    size_t length;
+    bool first;
+    bool last;
+
+    // Output
+    Token *tokens;
+    size_t count;
+    size_t capacity;
+    bool error;         // last token is a lexical error
+    bool outOfMemory;
+    size_t errorPos;    // position of the lexical error in whole source
+} PrelexChunk;
+
+typedef struct
+{
+    PrelexChunk *chunks;
+    size_t count;
+    size_t capacity;
+    size_t chunkSize;
+    size_t chunkStart;
+} PrelexSplit;
+
+// ==================== CLASSIFICATION ====================
+
+static void splitAdd(PrelexSplit *split, const Scanner *source, size_t end)
+{
+    if (split->count == split->capacity)
+    {
+        split->capacity = split->capacity ? split->capacity * 2 : 16;
+        PrelexChunk *chunks = realloc(split->chunks, sizeof(PrelexChunk) * split->capacity);
+        if (!chunks) errorExit(INTERNAL_ERROR, "Unable to allocate lexer chunks", 0, NULL);
+        split->chunks = chunks;
+    }
+
+    PrelexChunk *chunk = &split->chunks[split->count++];
+    memset(chunk, 0, sizeof(PrelexChunk));
+    chunk->source = source;
+    chunk->start = split->chunkStart;
+    chunk->length = end - split->chunkStart;
+    chunk->first = split->count == 1;
+
+    split->chunkStart = end;
+}
+
+/**
+ * @brief Called after newline in plain code, ends chunk there when it is long enough
+ */
+static inline void splitAtNewline(PrelexSplit *split, const Scanner *source, size_t next)
+{
+    if (next - split->chunkStart >= split->chunkSize && next < source->length)
+    {
+        splitAdd(split, source, next);
+    }
+}
+
+/**
+ * @brief Byte at index, 0 past the end (like EOF, never matches a special character)
+ */
+static inline char byteAt(const Scanner *source, size_t index)
+{
+    return index < source->length ? source->buffer[index] : '\0';
+}
+
+/**
+ * @brief Quick pass tracking only string and comment state, finds safe split points
+ * @details Follows the scanner rules exactly up to the first lexical error, splits after
+ * that point are never used, because the chunk containing the error ends the stream.
+ */
+static void prelexClassify(const Scanner *source, PrelexSplit *split)
+{
+    const ScanKernels *kernels = source->kernels;
+    const char *buffer = source->buffer;
+    const char *end = buffer + source->length;
+    size_t length = source->length;
+
+    LexState state = LEX_CODE;
+    int depth = 0;
+    size_t i = 0;
+
+    while (i < length)
+    {
+        char c = buffer[i];
+        switch (state)
+        {
+            case LEX_CODE:
+                if (c == '\n')
+                {
+                    i++;
+                    splitAtNewline(split, source, i);
+                }
+                else if (c == '"')
+                {
+                    if (byteAt(source, i + 1) == '"' && byteAt(source, i + 2) == '"')
+                    {
+                        state = LEX_MULTILINE;
+                        i += 3;
+                    }
+                    else if (byteAt(source, i + 1) == '"')
+                    {
+                        i += 2;  // empty string
+                    }
+                    else
+                    {
+                        state = LEX_STRING;
+                        i++;
+                    }
+                }
+                else if (c == '/' && byteAt(source, i + 1) == '/')
+                {
+                    state = LEX_LINE_COMMENT;
+                    i += 2;
+                }
+                else if (c == '/' && byteAt(source, i + 1) == '*')
+                {
+                    state = LEX_BLOCK_COMMENT;
+                    depth = 1;
+                    i += 2;
+                }
+                else
+                {
+                    i++;
+                }
+                break;
+
+            case LEX_STRING:
+                i = (size_t)(kernels->findStringStop(buffer + i, end) - buffer);
+                if (i >= length) break;
+                c = buffer[i];
+                if (c == '"')
+                {
+                    state = LEX_CODE;
+                    i++;
+                }
+                else if (c == '\\')
+                {
+                    i += 2;
+                }
+                else
+                {
+                    // Řídicí znak je chyba scanneru, dál už na stavu nezáleží
+                    if (c == '\n')
+                    {
+                        state = LEX_CODE;
+                    }
+                    i++;
+                }
+                break;
+
+            case LEX_MULTILINE:
+                i = (size_t)(kernels->findMultilineStop(buffer + i, end) - buffer);
+                if (i >= length) break;
+                if (buffer[i] == '"' && byteAt(source, i + 1) == '"' &&
+                    byteAt(source, i + 2) == '"')
+                {
+                    state = LEX_CODE;
+                    i += 3;
+                }
+                else
+                {
+                    i++;
+                }
+                break;
+
+            case LEX_LINE_COMMENT:
+                i = (size_t)(kernels->findLineEnd(buffer + i, end) - buffer);
+                if (i >= length) break;
+                i++;
+                state = LEX_CODE;
+                splitAtNewline(split, source, i);
+                break;
+
+            case LEX_BLOCK_COMMENT:
+                i = (size_t)(kernels->findCommentStop(buffer + i, end) - buffer);
+                if (i >= length) break;
+                c = buffer[i];
+                if (c == '/' && byteAt(source, i + 1) == '*')
+                {
+                    depth++;
+                    i += 2;
+                }
+                else if (c == '*' && byteAt(source, i + 1) == '/')
+                {
+                    i += 2;
+                    if (--depth == 0) state = LEX_CODE;
+                }
+                else
+                {
+                    i++;
+                }
+                break;
+        }
+    }
+
+    splitAdd(split, source, length);
+    split->chunks[split->count - 1].last = true;
+}
+
+// ==================== CHUNK LEXING ====================
+
+static void prelexChunk(void *arg)
+{
+    PrelexChunk *chunk = arg;
+
+    // Scanner nad částí sdíleného bufferu, EOF je konec chunku
+    Scanner scanner;
+    memset(&scanner, 0, sizeof(Scanner));
+    scanner.buffer = chunk->source->buffer + chunk->start;
+    scanner.length = chunk->length;
+    scanner.kernels = chunk->source->kernels;
+    // Předchozí chunk vždy končí EOL, případné další EOL se musí sloučit
+    scanner.lastWasEOL = !chunk->first;
+
+    while (true)
+    {
+        if (chunk->count == chunk->capacity)
+        {
+            size_t capacity = chunk->capacity ? chunk->capacity * 2 : chunk->length / 4 + 16;
+            Token *tokens = realloc(chunk->tokens, sizeof(Token) * capacity);
+            if (!tokens)
+            {
+                chunk->outOfMemory = true;
+                break;
+            }
+            chunk->tokens = tokens;
+            chunk->capacity = capacity;
+        }
+
+        Token *token = &chunk->tokens[chunk->count];
+        int result = getNextToken(&scanner, token);
+        token->offset += (uint32_t)chunk->start;
+        if (result != 0)
+        {
+            chunk->error = true;
+            chunk->errorPos = chunk->start + scanner.pos;
+            chunk->count++;
+            break;
+        }
+        if (token->type == EOF_TOKEN && !chunk->last)
+        {
+            break;
+        }
+        chunk->count++;
+        if (token->type == EOF_TOKEN) break;
+    }
+}
+
+static void freeChunkTokens(PrelexChunk *chunk)
+{
+    for (size_t i = 0; i < chunk->count; i++)
+    {
+        freeToken(&chunk->tokens[i]);
+    }
+    free(chunk->tokens);
+    chunk->tokens = NULL;
+    chunk->count = 0;
+}
+
+// ==================== STITCHING ====================
+
+void prelexSource(Scanner *scanner, size_t chunkSize, int threads)
+{
+    PrelexSplit split = {NULL, 0, 0, chunkSize ? chunkSize : PRELEX_CHUNK_SIZE, 0};
+    prelexClassify(scanner, &split);
+
+    if (split.count < 2)
+    {
+        // Nenašlo se bezpečné místo pro rozdělení, lexuje se sekvenčně
+        free(split.chunks);
+        return;
+    }
+
+    ThreadPool *pool = threadPoolCreate(threads);
+    for (size_t i = 0; i < split.count; i++)
+    {
+        threadPoolSubmit(pool, prelexChunk, &split.chunks[i]);
+    }
+    threadPoolWait(pool);
+    threadPoolDestroy(pool);
+
+    // Chunky za první chybou se zahodí, sekvenční lexer by k nim nedošel
+    size_t used = 0;
+    size_t total = 0;
+    bool outOfMemory = false;
+    while (used < split.count)
+    {
+        PrelexChunk *chunk = &split.chunks[used++];
+        total += chunk->count;
+        outOfMemory = outOfMemory || chunk->outOfMemory;
+        if (chunk->error || chunk->outOfMemory) break;
+    }
+
+    Token *tokens = outOfMemory ? NULL : malloc(sizeof(Token) * (total ? total : 1));
+    if (!tokens)
+    {
+        for (size_t i = 0; i < split.count; i++) freeChunkTokens(&split.chunks[i]);
+        free(split.chunks);
+        errorExit(INTERNAL_ERROR, "Unable to allocate token array", 0, NULL);
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < split.count; i++)
+    {
+        PrelexChunk *chunk = &split.chunks[i];
+        if (i < used)
+        {
+            memcpy(tokens + count, chunk->tokens, sizeof(Token) * chunk->count);
+            count += chunk->count;
+            free(chunk->tokens);
+        }
+        else
+        {
+            freeChunkTokens(chunk);
+        }
+    }
+
+    PrelexChunk *lastUsed = &split.chunks[used - 1];
+    scanner->preTokens = tokens;
+    scanner->preCount = count;
+    scanner->preNext = 0;
+    scanner->preError = lastUsed->error;
+    scanner->preErrorPos = lastUsed->errorPos;
+
+    // Sekvenční scanner pokračuje až za koncem, vrací už jen EOF
+    scanner->pos = scanner->length;
+
+    free(split.chunks);
+}
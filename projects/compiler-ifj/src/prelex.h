@@ -0,0 +1,33 @@
+/**
+ * @file prelex.h
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Parallel lexing of large sources split at newlines outside strings and comments
+ *
+ * Source is split into chunks ending with a newline in plain code, every chunk is lexed
+ * by a thread pool worker and the token arrays are stitched into one array with offsets
+ * relative to the whole source. Scanner then hands out tokens from that array instead of lexing.
+ */
+
+#ifndef PRELEX_H
+#define PRELEX_H
+
+#include <stddef.h>
+
+#include "scanner.h"
+
+#define PRELEX_MIN_SIZE (4u << 20)     // smaller sources are lexed sequentially
+#define PRELEX_CHUNK_SIZE (512u << 10)  // minimal size of one chunk
+
+/**
+ * @brief Lex whole scanner buffer in parallel and store tokens in scanner->preTokens
+ *
+ * Stream is identical to the one getNextToken produces sequentially, including the position
+ * of the first lexical error (tokens after it are dropped).
+ *
+ * @param scanner initialized scanner at the start of its buffer
+ * @param chunkSize minimal size of one chunk in bytes
+ * @param threads number of worker threads
+ */
+void prelexSource(Scanner *scanner, size_t chunkSize, int threads);
+
+#endif  // PRELEX_H
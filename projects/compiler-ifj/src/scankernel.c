@@ -0,0 +1,240 @@
+/**
+ * @file scankernel.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Vectorized search kernels used by scanner to skip whitespace, comments and string bodies
+ */
+
+#include "scankernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define SCAN_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+// ==================== SCALAR KERNELS ====================
+
+static const char *scalarSkipSpaces(const char *pos, const char *end)
+{
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+static const char *scalarFindLineEnd(const char *pos, const char *end)
+{
+    while (pos < end && *pos != '\n')
+    {
+        pos++;
+    }
+    return pos;
+}
+
+static const char *scalarFindCommentStop(const char *pos, const char *end)
+{
+    while (pos < end && *pos != '\n' && *pos != '*' && *pos != '/')
+    {
+        pos++;
+    }
+    return pos;
+}
+
+static const char *scalarFindStringStop(const char *pos, const char *end)
+{
+    while (pos < end && *pos != '"' && *pos != '\\' && (unsigned char)*pos >= 0x20)
+    {
+        pos++;
+    }
+    return pos;
+}
+
+static const char *scalarFindMultilineStop(const char *pos, const char *end)
+{
+    while (pos < end && *pos != '"' && *pos != '\n')
+    {
+        pos++;
+    }
+    return pos;
+}
+
+static size_t scalarCountNewlines(const char *pos, const char *end)
+{
+    size_t count = 0;
+    for (; pos < end; pos++)
+    {
+        count += (*pos == '\n');
+    }
+    return count;
+}
+
+static const ScanKernels SCALAR_KERNELS = {
+    "scalar",
+    scalarSkipSpaces,
+    scalarFindLineEnd,
+    scalarFindCommentStop,
+    scalarFindStringStop,
+    scalarFindMultilineStop,
+    scalarCountNewlines,
+};
+
+#ifdef SCAN_KERNEL_X86
+
+/**
+ * @brief Return position of first set bit of mask, clamped to end
+ */
+static inline const char *maskHit(const char *pos, unsigned mask, const char *end)
+{
+    const char *hit = pos + __builtin_ctz(mask);
+    return hit < end ? hit : end;
+}
+
+// ==================== SSE2 KERNELS ====================
+
+// Tělo smyčky je pro všechny kernely stejné, liší se jen výpočtem masky zajímavých bajtů
+#define SSE2_KERNEL(fnName, maskExpr)                                                   \
+    static const char *fnName(const char *pos, const char *end)                         \
+    {                                                                                   \
+        for (; pos < end; pos += 16)                                                    \
+        {                                                                               \
+            __m128i v = _mm_loadu_si128((const __m128i *)pos);                          \
+            unsigned mask = (unsigned)(maskExpr);                                       \
+            if (mask) return maskHit(pos, mask, end);                                   \
+        }                                                                               \
+        return end;                                                                     \
+    }
+
+#define SSE2_EQ(c) _mm_cmpeq_epi8(v, _mm_set1_epi8(c))
+// Unsigned v < 0x20 <=> min(v, 0x1F) == v (SSE2 nemá unsigned porovnání)
+#define SSE2_CONTROL() _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v)
+
+SSE2_KERNEL(sse2SkipSpaces,
+            _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(SSE2_EQ(' '), SSE2_EQ('\t')),
+                                           SSE2_EQ('\r'))) ^ 0xFFFF)
+SSE2_KERNEL(sse2FindLineEnd, _mm_movemask_epi8(SSE2_EQ('\n')))
+SSE2_KERNEL(sse2FindCommentStop,
+            _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(SSE2_EQ('\n'), SSE2_EQ('*')),
+                                           SSE2_EQ('/'))))
+SSE2_KERNEL(sse2FindStringStop,
+            _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(SSE2_EQ('"'), SSE2_EQ('\\')),
+                                           SSE2_CONTROL())))
+SSE2_KERNEL(sse2FindMultilineStop,
+            _mm_movemask_epi8(_mm_or_si128(SSE2_EQ('"'), SSE2_EQ('\n'))))
+
+static size_t sse2CountNewlines(const char *pos, const char *end)
+{
+    size_t count = 0;
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; pos + 16 <= end; pos += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)pos);
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)));
+    }
+    return count + scalarCountNewlines(pos, end);
+}
+
+static const ScanKernels SSE2_KERNELS = {
+    "sse2",
+    sse2SkipSpaces,
+    sse2FindLineEnd,
+    sse2FindCommentStop,
+    sse2FindStringStop,
+    sse2FindMultilineStop,
+    sse2CountNewlines,
+};
+
+// ==================== AVX2 KERNELS ====================
+
+// Překládáme jen tyto funkce pro AVX2, volají se až po kontrole __builtin_cpu_supports
+#define AVX2_KERNEL(fnName, maskExpr)                                                   \
+    __attribute__((target("avx2"))) static const char *fnName(const char *pos,          \
+                                                              const char *end)          \
+    {                                                                                   \
+        for (; pos < end; pos += 32)                                                    \
+        {                                                                               \
+            __m256i v = _mm256_loadu_si256((const __m256i *)pos);                       \
+            unsigned mask = (unsigned)(maskExpr);                                       \
+            if (mask) return maskHit(pos, mask, end);                                   \
+        }                                                                               \
+        return end;                                                                     \
+    }
+
+#define AVX2_EQ(c) _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))
+#define AVX2_CONTROL() _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1F)), v)
+
+AVX2_KERNEL(avx2SkipSpaces,
+            ~(unsigned)_mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_or_si256(AVX2_EQ(' '), AVX2_EQ('\t')), AVX2_EQ('\r'))))
+AVX2_KERNEL(avx2FindLineEnd, _mm256_movemask_epi8(AVX2_EQ('\n')))
+AVX2_KERNEL(avx2FindCommentStop,
+            _mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_or_si256(AVX2_EQ('\n'), AVX2_EQ('*')), AVX2_EQ('/'))))
+AVX2_KERNEL(avx2FindStringStop,
+            _mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_or_si256(AVX2_EQ('"'), AVX2_EQ('\\')), AVX2_CONTROL())))
+AVX2_KERNEL(avx2FindMultilineStop,
+            _mm256_movemask_epi8(_mm256_or_si256(AVX2_EQ('"'), AVX2_EQ('\n'))))
+
+__attribute__((target("avx2"))) static size_t avx2CountNewlines(const char *pos,
+                                                                const char *end)
+{
+    size_t count = 0;
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; pos + 32 <= end; pos += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)pos);
+        count += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline)));
+    }
+    return count + scalarCountNewlines(pos, end);
+}
+
+static const ScanKernels AVX2_KERNELS = {
+    "avx2",
+    avx2SkipSpaces,
+    avx2FindLineEnd,
+    avx2FindCommentStop,
+    avx2FindStringStop,
+    avx2FindMultilineStop,
+    avx2CountNewlines,
+};
+
+#endif  // SCAN_KERNEL_X86
+
+// ==================== DISPATCH ====================
+
+const ScanKernels *scanKernelsForLevel(ScanKernelLevel level)
+{
+    switch (level)
+    {
+        case SCAN_KERNEL_SCALAR:
+            return &SCALAR_KERNELS;
+#ifdef SCAN_KERNEL_X86
+        case SCAN_KERNEL_SSE2:
+            return &SSE2_KERNELS;
+        case SCAN_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? &AVX2_KERNELS : NULL;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+const ScanKernels *scanKernelsGet(void)
+{
+    static const ScanKernels *selected = NULL;
+
+    if (!selected)
+    {
+        for (int level = SCAN_KERNEL_COUNT - 1; level >= SCAN_KERNEL_SCALAR; level--)
+        {
+            const ScanKernels *kernels = scanKernelsForLevel((ScanKernelLevel)level);
+            if (kernels)
+            {
+                selected = kernels;
+                break;
+            }
+        }
+    }
+    return selected;
+}
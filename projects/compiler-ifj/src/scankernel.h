@@ -0,0 +1,58 @@
+/**
+ * @file scankernel.h
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Vectorized search kernels used by scanner to skip whitespace, comments and string bodies
+ *
+ * Every kernel gets range [pos, end) of the input buffer and returns pointer to the first
+ * "interesting" byte, or end if there is none. SSE2/AVX2 variants read whole 16/32 byte
+ * blocks, so the buffer must have SCAN_KERNEL_PADDING readable bytes after end.
+ */
+
+#ifndef SCANKERNEL_H
+#define SCANKERNEL_H
+
+#include <stddef.h>
+
+#define SCAN_KERNEL_PADDING 32
+
+typedef enum
+{
+    SCAN_KERNEL_SCALAR,
+    SCAN_KERNEL_SSE2,
+    SCAN_KERNEL_AVX2,
+    SCAN_KERNEL_COUNT
+} ScanKernelLevel;
+
+typedef const char *(*ScanKernelFn)(const char *pos, const char *end);
+typedef size_t (*ScanCountFn)(const char *pos, const char *end);
+
+/**
+ * @brief Set of kernels of one instruction set level
+ */
+typedef struct
+{
+    const char *name;
+    ScanKernelFn skipSpaces;        // first byte other than ' ', '\t', '\r'
+    ScanKernelFn findLineEnd;       // first '\n'
+    ScanKernelFn findCommentStop;   // first '\n', '*' or '/'
+    ScanKernelFn findStringStop;    // first '"', '\\' or control char (< 0x20)
+    ScanKernelFn findMultilineStop; // first '"' or '\n'
+    ScanCountFn countNewlines;      // number of '\n' in range
+} ScanKernels;
+
+/**
+ * @brief Kernels of given level
+ *
+ * @param level requested instruction set level
+ * @return const ScanKernels* NULL when CPU (or build target) does not support the level
+ */
+const ScanKernels *scanKernelsForLevel(ScanKernelLevel level);
+
+/**
+ * @brief Best kernels supported by running CPU, selected once at first call
+ *
+ * @return const ScanKernels* never NULL, scalar kernels are always available
+ */
+const ScanKernels *scanKernelsGet(void);
+
+#endif  // SCANKERNEL_H
@@ -6,42 +6,215 @@
 
 #include "scanner.h"
 #include "error.h"
+#include "prelex.h"
+#include "threadpool.h"
 
-#include <ctype.h>
+#include <float.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+// ==================== CHARACTER CLASSES ====================
+
+// Vlastnosti znaku, jeden bajt na znak (nahrazuje isalpha/isalnum, které navíc závisí
+// na locale), číslice a hex číslice rozlišuje až NUMBER_CLASS
+#define CF_IDENT_START 0x01  // letter or '_'
+#define CF_IDENT_PART 0x02   // letter, digit or '_'
+
+#define CF_LETTER (CF_IDENT_START | CF_IDENT_PART)
+
+// Rozsahy v inicializátoru nejsou C99, písmena a číslice jsou proto vypsány po jednom
+static const unsigned char CHAR_FLAGS[256] = {
+    ['a'] = CF_LETTER,     ['b'] = CF_LETTER,     ['c'] = CF_LETTER,     ['d'] = CF_LETTER,
+    ['e'] = CF_LETTER,     ['f'] = CF_LETTER,     ['g'] = CF_LETTER,     ['h'] = CF_LETTER,
+    ['i'] = CF_LETTER,     ['j'] = CF_LETTER,     ['k'] = CF_LETTER,     ['l'] = CF_LETTER,
+    ['m'] = CF_LETTER,     ['n'] = CF_LETTER,     ['o'] = CF_LETTER,     ['p'] = CF_LETTER,
+    ['q'] = CF_LETTER,     ['r'] = CF_LETTER,     ['s'] = CF_LETTER,     ['t'] = CF_LETTER,
+    ['u'] = CF_LETTER,     ['v'] = CF_LETTER,     ['w'] = CF_LETTER,     ['x'] = CF_LETTER,
+    ['y'] = CF_LETTER,     ['z'] = CF_LETTER,
+    ['A'] = CF_LETTER,     ['B'] = CF_LETTER,     ['C'] = CF_LETTER,     ['D'] = CF_LETTER,
+    ['E'] = CF_LETTER,     ['F'] = CF_LETTER,     ['G'] = CF_LETTER,     ['H'] = CF_LETTER,
+    ['I'] = CF_LETTER,     ['J'] = CF_LETTER,     ['K'] = CF_LETTER,     ['L'] = CF_LETTER,
+    ['M'] = CF_LETTER,     ['N'] = CF_LETTER,     ['O'] = CF_LETTER,     ['P'] = CF_LETTER,
+    ['Q'] = CF_LETTER,     ['R'] = CF_LETTER,     ['S'] = CF_LETTER,     ['T'] = CF_LETTER,
+    ['U'] = CF_LETTER,     ['V'] = CF_LETTER,     ['W'] = CF_LETTER,     ['X'] = CF_LETTER,
+    ['Y'] = CF_LETTER,     ['Z'] = CF_LETTER,
+    ['0'] = CF_IDENT_PART, ['1'] = CF_IDENT_PART, ['2'] = CF_IDENT_PART, ['3'] = CF_IDENT_PART,
+    ['4'] = CF_IDENT_PART, ['5'] = CF_IDENT_PART, ['6'] = CF_IDENT_PART, ['7'] = CF_IDENT_PART,
+    ['8'] = CF_IDENT_PART, ['9'] = CF_IDENT_PART,
+    ['_'] = CF_LETTER,
+};
+
+/**
+ * @brief Kind of character deciding which transition getRawToken takes
+ */
+typedef enum
+{
+    CHAR_INVALID,          // not allowed outside strings/comments
+    CHAR_SPACE,            // space, tab, carriage return
+    CHAR_NEWLINE,          // '\n'
+    CHAR_SLASH,            // division or start of comment
+    CHAR_SINGLE,           // token of one character, type in CHAR_TOKEN
+    CHAR_EQ_OPERATOR,      // CHAR_TOKEN, or CHAR_TOKEN_EQ when followed by '='
+    CHAR_DOUBLE_OPERATOR,  // valid only doubled ("&&", "||")
+    CHAR_QUOTE,            // string literal
+    CHAR_IDENT,            // identifier or keyword
+    CHAR_DIGIT,            // numeric literal
+} CharKind;
+
+static const unsigned char CHAR_KIND[256] = {
+    [' '] = CHAR_SPACE,
+    ['\t'] = CHAR_SPACE,
+    ['\r'] = CHAR_SPACE,
+    ['\n'] = CHAR_NEWLINE,
+    ['/'] = CHAR_SLASH,
+    ['('] = CHAR_SINGLE,
+    [')'] = CHAR_SINGLE,
+    ['{'] = CHAR_SINGLE,
+    ['}'] = CHAR_SINGLE,
+    [','] = CHAR_SINGLE,
+    ['.'] = CHAR_SINGLE,
+    ['+'] = CHAR_SINGLE,
+    ['-'] = CHAR_SINGLE,
+    ['*'] = CHAR_SINGLE,
+    ['?'] = CHAR_SINGLE,
+    [':'] = CHAR_SINGLE,
+    ['='] = CHAR_EQ_OPERATOR,
+    ['<'] = CHAR_EQ_OPERATOR,
+    ['>'] = CHAR_EQ_OPERATOR,
+    ['!'] = CHAR_EQ_OPERATOR,
+    ['&'] = CHAR_DOUBLE_OPERATOR,
+    ['|'] = CHAR_DOUBLE_OPERATOR,
+    ['"'] = CHAR_QUOTE,
+    ['_'] = CHAR_IDENT,
+    ['a'] = CHAR_IDENT, ['b'] = CHAR_IDENT, ['c'] = CHAR_IDENT, ['d'] = CHAR_IDENT,
+    ['e'] = CHAR_IDENT, ['f'] = CHAR_IDENT, ['g'] = CHAR_IDENT, ['h'] = CHAR_IDENT,
+    ['i'] = CHAR_IDENT, ['j'] = CHAR_IDENT, ['k'] = CHAR_IDENT, ['l'] = CHAR_IDENT,
+    ['m'] = CHAR_IDENT, ['n'] = CHAR_IDENT, ['o'] = CHAR_IDENT, ['p'] = CHAR_IDENT,
+    ['q'] = CHAR_IDENT, ['r'] = CHAR_IDENT, ['s'] = CHAR_IDENT, ['t'] = CHAR_IDENT,
+    ['u'] = CHAR_IDENT, ['v'] = CHAR_IDENT, ['w'] = CHAR_IDENT, ['x'] = CHAR_IDENT,
+    ['y'] = CHAR_IDENT, ['z'] = CHAR_IDENT,
+    ['A'] = CHAR_IDENT, ['B'] = CHAR_IDENT, ['C'] = CHAR_IDENT, ['D'] = CHAR_IDENT,
+    ['E'] = CHAR_IDENT, ['F'] = CHAR_IDENT, ['G'] = CHAR_IDENT, ['H'] = CHAR_IDENT,
+    ['I'] = CHAR_IDENT, ['J'] = CHAR_IDENT, ['K'] = CHAR_IDENT, ['L'] = CHAR_IDENT,
+    ['M'] = CHAR_IDENT, ['N'] = CHAR_IDENT, ['O'] = CHAR_IDENT, ['P'] = CHAR_IDENT,
+    ['Q'] = CHAR_IDENT, ['R'] = CHAR_IDENT, ['S'] = CHAR_IDENT, ['T'] = CHAR_IDENT,
+    ['U'] = CHAR_IDENT, ['V'] = CHAR_IDENT, ['W'] = CHAR_IDENT, ['X'] = CHAR_IDENT,
+    ['Y'] = CHAR_IDENT, ['Z'] = CHAR_IDENT,
+    ['0'] = CHAR_DIGIT, ['1'] = CHAR_DIGIT, ['2'] = CHAR_DIGIT, ['3'] = CHAR_DIGIT,
+    ['4'] = CHAR_DIGIT, ['5'] = CHAR_DIGIT, ['6'] = CHAR_DIGIT, ['7'] = CHAR_DIGIT,
+    ['8'] = CHAR_DIGIT, ['9'] = CHAR_DIGIT,
+};
+
+// Token of operator character on its own
+static const unsigned char CHAR_TOKEN[256] = {
+    ['('] = LPAR,
+    [')'] = RPAR,
+    ['{'] = LCURLY,
+    ['}'] = RCURLY,
+    [','] = COMMA,
+    ['.'] = DOT,
+    ['+'] = PLUS,
+    ['-'] = MINUS,
+    ['*'] = MULTIPLY,
+    ['?'] = TERNARY_QUESTION,
+    [':'] = TERNARY_COLON,
+    ['='] = ASSIGN,
+    ['<'] = IS_SMALLER,
+    ['>'] = IS_BIGGER,
+    ['!'] = LOGICAL_NOT,
+    ['&'] = LOGICAL_AND,
+    ['|'] = LOGICAL_OR,
+};
+
+// Token of operator character followed by '='
+static const unsigned char CHAR_TOKEN_EQ[256] = {
+    ['='] = IS_EQUAL,
+    ['<'] = IS_SMALLER_OR_EQUAL,
+    ['>'] = IS_BIGGER_OR_EQUAL,
+    ['!'] = IS_NOT_EQUAL,
+};
+
 // ==================== HELPER FUNCTIONS ====================
 
 /**
- * @brief Check if character is whitespace (excluding newline)
- * @param character Character to check
- * @return true if whitespace (space or tab), false otherwise
+ * @brief Check if character read by scanGet has given CHAR_FLAGS property
+ * @param character Character to check (may be EOF)
+ * @param flag One of CF_* flags
+ * @return true if character has the property, false otherwise
+ */
+static inline bool charHas(int character, unsigned char flag)
+{
+    return character != EOF && (CHAR_FLAGS[(unsigned char)character] & flag);
+}
+
+/**
+ * @brief Read next byte of source
+ * @param scanner Scanner state
+ * @return The byte as unsigned char, or EOF at the end of source
  */
-static bool isWhiteSpace(int character)
+static inline int scanGet(Scanner *scanner)
 {
-    return character == ' ' || character == '\t';
+    if (scanner->pos >= scanner->length) return EOF;
+    return (unsigned char)scanner->buffer[scanner->pos++];
 }
 
 /**
- * @brief Check if character can start an identifier
- * @param character Character to check
- * @return true if letter or underscore, false otherwise
+ * @brief Return byte read by scanGet back to source (EOF is ignored like by ungetc)
+ * @param scanner Scanner state
+ * @param character Character returned by the last scanGet
  */
-static bool isIdentifierStart(int character)
+static inline void scanUnget(Scanner *scanner, int character)
 {
-    return isalpha(character) || character == '_';
+    if (character != EOF) scanner->pos--;
 }
 
 /**
- * @brief Check if character can be part of identifier
- * @param character Character to check
- * @return true if alphanumeric or underscore, false otherwise
+ * @brief Run kernel from current position and move position to the byte it stopped at
+ * @param scanner Scanner state
+ * @param kernel Kernel searching for next interesting byte
+ * @param run Set to start of skipped bytes (may be NULL)
+ * @return Number of skipped bytes
  */
-static bool isIdentifierPart(int character)
+static inline size_t scanSkip(Scanner *scanner, ScanKernelFn kernel, const char **run)
 {
-    return isalnum(character) || character == '_';
+    const char *start = scanner->buffer + scanner->pos;
+    const char *stop = kernel(start, scanner->buffer + scanner->length);
+    if (run) *run = start;
+    scanner->pos += (size_t)(stop - start);
+    return (size_t)(stop - start);
+}
+
+/**
+ * @brief Append run of bytes to growing string buffer
+ * @param buffer String buffer
+ * @param buffCapacity Current buffer capacity
+ * @param strLen Current string length
+ * @param run Bytes to append
+ * @param runLen Number of bytes
+ * @return 0 on success, 1 on allocation error
+ */
+static int appendRun(char **buffer, size_t *buffCapacity, size_t *strLen, const char *run,
+                     size_t runLen)
+{
+    if (*strLen + runLen >= *buffCapacity)
+    {
+        size_t newCapacity = *buffCapacity;
+        while (*strLen + runLen >= newCapacity)
+        {
+            newCapacity *= 2;
+        }
+        char *newBuff = (char *)realloc(*buffer, newCapacity);
+        if (!newBuff) return 1;
+        *buffer = newBuff;
+        *buffCapacity = newCapacity;
+    }
+
+    memcpy(*buffer + *strLen, run, runLen);
+    *strLen += runLen;
+    return 0;
 }
 
 /**
@@ -75,21 +248,105 @@ static int hexToInt(int hexChar)
 
 // ==================== SCANNER INIT/DISPOSE ====================
 
+/**
+ * @brief Read whole stream into memory, kernels need contiguous buffer with padding
+ * @param scanner Scanner state, fills buffer and length
+ * @param source Input stream
+ */
+static void readSource(Scanner *scanner, FILE *source)
+{
+    size_t capacity = 1 << 16;
+    size_t length = 0;
+    char *buffer = (char *)malloc(capacity + SCAN_KERNEL_PADDING);
+    if (!buffer)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate source buffer", 0, NULL);
+    }
+
+    size_t got;
+    while ((got = fread(buffer + length, 1, capacity - length, source)) > 0)
+    {
+        length += got;
+        if (length == capacity)
+        {
+            capacity *= 2;
+            char *newBuff = (char *)realloc(buffer, capacity + SCAN_KERNEL_PADDING);
+            if (!newBuff)
+            {
+                free(buffer);
+                errorExit(INTERNAL_ERROR, "Failed to allocate source buffer", 0, NULL);
+            }
+            buffer = newBuff;
+        }
+    }
+
+    if (length > SOURCE_MAX_SIZE)
+    {
+        free(buffer);
+        errorExit(INTERNAL_ERROR, "Source file too large", 0, NULL);
+    }
+
+    memset(buffer + length, 0, SCAN_KERNEL_PADDING);
+    scanner->buffer = buffer;
+    scanner->length = length;
+}
+
 void initScanner(Scanner *scanner, FILE *source)
 {
     scanner->source = source;
-    scanner->line = 1;
+    readSource(scanner, source);
+    scanner->pos = 0;
+    scanner->kernels = scanKernelsGet();
+    scanner->preTokens = NULL;
+    scanner->preCount = 0;
+    scanner->preNext = 0;
+    scanner->preError = false;
+    scanner->preErrorPos = 0;
+    sourceMapBuild(&scanner->map, scanner->buffer, scanner->length, scanner->kernels);
+    sourceMapSetCurrent(&scanner->map);
     scanner->prologueRead = false;
-    scanner->isLookingAhead = false;
+    scanner->ringHead = 0;
+    scanner->ringCount = 0;
     scanner->lastWasEOL = false;
-    memset(&scanner->lookAheadToken, 0, sizeof(Token));
+    memset(scanner->ring, 0, sizeof(scanner->ring));
+
+    // Velké zdroje se lexují paralelně dopředu, tokeny se pak jen vydávají z pole
+    if (scanner->length >= PRELEX_MIN_SIZE)
+    {
+        int threads = threadPoolDefaultSize();
+        if (threads > 1)
+        {
+            size_t chunkSize = scanner->length / ((size_t)threads * 4);
+            prelexSource(scanner, chunkSize > PRELEX_CHUNK_SIZE ? chunkSize : PRELEX_CHUNK_SIZE,
+                         threads);
+        }
+    }
 }
 
 void disposeScanner(Scanner *scanner)
 {
-    if (scanner->isLookingAhead)
+    sourceMapDispose(&scanner->map);
+
+    for (size_t i = scanner->preNext; i < scanner->preCount; i++)
     {
-        freeToken(&scanner->lookAheadToken);
+        freeToken(&scanner->preTokens[i]);
+    }
+    free(scanner->preTokens);
+    scanner->preTokens = NULL;
+    scanner->preCount = 0;
+    scanner->preNext = 0;
+
+    free(scanner->buffer);
+    scanner->buffer = NULL;
+    scanner->length = 0;
+    scanner->pos = 0;
+
+    // Tokeny přečtené dopředu stále patří scanneru
+    while (scanner->ringCount > 0)
+    {
+        freeToken(&scanner->ring[scanner->ringHead]);
+        scanner->ringHead = (scanner->ringHead + 1) & (TOKEN_RING_SIZE - 1);
+        scanner->ringCount--;
     }
 }
 
@@ -106,40 +363,106 @@ void freeToken(Token *token)
     }
 }
 
+int scannerLine(const Scanner *scanner)
+{
+    if (!scanner->map.lineStarts) return 0;
+    // Řádek posledního přečteného znaku, chybný lexém může skončit až za '\n'
+    size_t last = scanner->pos > 0 ? scanner->pos - 1 : 0;
+    return sourceMapLocate(&scanner->map, (uint32_t)last).line;
+}
+
+SourceLocation tokenLocation(const Token *token)
+{
+    const SourceMap *map = sourceMapCurrent();
+    if (!map)
+    {
+        SourceLocation unknown = {0, 0};
+        return unknown;
+    }
+    return sourceMapLocate(map, token->offset);
+}
+
+int tokenLine(const Token *token)
+{
+    return tokenLocation(token).line;
+}
+
 // ==================== KEYWORD IDENTIFICATION ====================
 
+// Keywords use perfect hash: slot = (length + first char + 2 * last char) mod 64.
+// Slots are computed by the compiler, first and last char of each keyword are written out
+// because a string literal character is not an integer constant expression. Two keywords in
+// one slot are rejected by -Woverride-init (-Wextra -Werror), wrong chars by keyword_bench.
+#define KEYWORD_TABLE_SIZE 64
+#define KEYWORD_MIN_LEN 2
+#define KEYWORD_MAX_LEN 6
+#define KEYWORD_HASH(len, first, last) \
+    (((len) + (unsigned char)(first) + 2 * (unsigned char)(last)) & (KEYWORD_TABLE_SIZE - 1))
+
+typedef struct
+{
+    const char *keyword;
+    size_t length;
+    TokenType type;
+} KeywordEntry;
+
+#define KEYWORD_ENTRY(str, first, last, tokenType) \
+    [KEYWORD_HASH(sizeof(str) - 1, first, last)] = {str, sizeof(str) - 1, tokenType}
+
+static const KeywordEntry KEYWORD_TABLE[KEYWORD_TABLE_SIZE] = {
+    KEYWORD_ENTRY("class", 'c', 's', KW_CLASS),
+    KEYWORD_ENTRY("if", 'i', 'f', KW_IF),
+    KEYWORD_ENTRY("else", 'e', 'e', KW_ELSE),
+    KEYWORD_ENTRY("is", 'i', 's', KW_IS),
+    KEYWORD_ENTRY("null", 'n', 'l', KW_VAL_NULL),
+    KEYWORD_ENTRY("return", 'r', 'n', KW_RETURN),
+    KEYWORD_ENTRY("var", 'v', 'r', KW_VAR),
+    KEYWORD_ENTRY("while", 'w', 'e', KW_WHILE),
+    KEYWORD_ENTRY("Ifj", 'I', 'j', KW_IFJ),
+    KEYWORD_ENTRY("static", 's', 'c', KW_STATIC),
+    KEYWORD_ENTRY("import", 'i', 't', KW_IMPORT),
+    KEYWORD_ENTRY("for", 'f', 'r', KW_FOR),
+    KEYWORD_ENTRY("Num", 'N', 'm', KW_TYPE_NUM),
+    KEYWORD_ENTRY("String", 'S', 'g', KW_TYPE_STRING),
+    KEYWORD_ENTRY("Null", 'N', 'l', KW_TYPE_NULL),
+    KEYWORD_ENTRY("Bool", 'B', 'l', KW_TYPE_BOOL),
+    KEYWORD_ENTRY("true", 't', 'e', KW_VAL_TRUE),
+    KEYWORD_ENTRY("false", 'f', 'e', KW_VAL_FALSE),
+};
+
 /**
- * @brief Checks if a given string matches a reserved keyword
- * @param string The identifier string to check
+ * @brief Checks if identifier of known length is a reserved keyword
+ * @param string The identifier characters (need not be zero terminated)
+ * @param length Number of characters
  * @return The corresponding keyword TokenType, or IDENTIFIER if no match found
  */
-TokenType identifyKeyword(const char *string)
+static TokenType identifyKeywordLen(const char *string, size_t length)
 {
-    static const struct
+    if (length < KEYWORD_MIN_LEN || length > KEYWORD_MAX_LEN)
     {
-        const char *keyword;
-        TokenType type;
-    } KEYWORDS[] = {{"class", KW_CLASS},    {"if", KW_IF},
-                    {"else", KW_ELSE},      {"is", KW_IS},
-                    {"null", KW_VAL_NULL},  {"return", KW_RETURN},
-                    {"var", KW_VAR},        {"while", KW_WHILE},
-                    {"Ifj", KW_IFJ},        {"static", KW_STATIC},
-                    {"import", KW_IMPORT},  {"for", KW_FOR},
-                    {"Num", KW_TYPE_NUM},   {"String", KW_TYPE_STRING},
-                    {"Null", KW_TYPE_NULL}, {"Bool", KW_TYPE_BOOL},
-                    {"true", KW_VAL_TRUE},  {"false", KW_VAL_FALSE},
-                    {NULL, IDENTIFIER}};
-
-    for (int i = 0; KEYWORDS[i].keyword != NULL; i++)
+        return IDENTIFIER;
+    }
+
+    // Jediný kandidát, stačí jedno porovnání
+    const KeywordEntry *entry =
+        &KEYWORD_TABLE[KEYWORD_HASH(length, string[0], string[length - 1])];
+    if (entry->length == length && memcmp(entry->keyword, string, length) == 0)
     {
-        if (strcmp(string, KEYWORDS[i].keyword) == 0)
-        {
-            return KEYWORDS[i].type;
-        }
+        return entry->type;
     }
     return IDENTIFIER;
 }
 
+/**
+ * @brief Checks if a given string matches a reserved keyword
+ * @param string The identifier string to check
+ * @return The corresponding keyword TokenType, or IDENTIFIER if no match found
+ */
+TokenType identifyKeyword(const char *string)
+{
+    return identifyKeywordLen(string, strlen(string));
+}
+
 // ==================== STRING PROCESSING ====================
 
 /**
@@ -152,7 +475,7 @@ TokenType identifyKeyword(const char *string)
  */
 static int processEscape(Scanner *scanner, char **buffer, size_t *buffCapacity, size_t *strLen)
 {
-    int character = fgetc(scanner->source);
+    int character = scanGet(scanner);
     unsigned char escaped = 0;
 
     switch (character)
@@ -178,8 +501,8 @@ static int processEscape(Scanner *scanner, char **buffer, size_t *buffCapacity,
         case 'x':
         {
             // Hex escape sequence \xdd
-            int hex1 = fgetc(scanner->source);
-            int hex2 = fgetc(scanner->source);
+            int hex1 = scanGet(scanner);
+            int hex2 = scanGet(scanner);
 
             int value1 = hexToInt(hex1);
             int value2 = hexToInt(hex2);
@@ -227,8 +550,22 @@ static int readString(Scanner *scanner, Token *token)
     if (!buffer) return 1;
 
     int character;
-    while ((character = fgetc(scanner->source)) != EOF)
+    while (true)
     {
+        // Běžné znaky kopírujeme po celých úsecích až k '"', '\\' nebo řídicímu znaku
+        const char *run;
+        size_t runLen = scanSkip(scanner, scanner->kernels->findStringStop, &run);
+        if (runLen && appendRun(&buffer, &buffCapacity, &strLen, run, runLen) != 0)
+        {
+            free(buffer);
+            return 1;
+        }
+
+        if ((character = scanGet(scanner)) == EOF)
+        {
+            break;
+        }
+
         if (character == '"')
         {
             // End of string
@@ -310,15 +647,29 @@ static int readMultilineString(Scanner *scanner, Token *token)
     bool firstLine = true;
     int character;
 
-    while ((character = fgetc(scanner->source)) != EOF)
+    while (true)
     {
+        // Úseky bez '"' a '\n' kopírujeme najednou
+        const char *run;
+        size_t runLen = scanSkip(scanner, scanner->kernels->findMultilineStop, &run);
+        if (runLen && appendRun(&buffer, &buffCapacity, &strLen, run, runLen) != 0)
+        {
+            free(buffer);
+            return 1;
+        }
+
+        if ((character = scanGet(scanner)) == EOF)
+        {
+            break;
+        }
+
         if (character == '"')
         {
             // Check for closing """
-            int next1 = fgetc(scanner->source);
+            int next1 = scanGet(scanner);
             if (next1 == '"')
             {
-                int next2 = fgetc(scanner->source);
+                int next2 = scanGet(scanner);
                 if (next2 == '"')
                 {
                     // Found closing """
@@ -349,7 +700,7 @@ static int readMultilineString(Scanner *scanner, Token *token)
                     }
                     buffer[strLen++] = '"';
                     buffer[strLen++] = (char)next1;
-                    ungetc(next2, scanner->source);
+                    scanUnget(scanner, next2);
                 }
             }
             else
@@ -366,14 +717,13 @@ static int readMultilineString(Scanner *scanner, Token *token)
                     buffer = newBuff;
                 }
                 buffer[strLen++] = '"';
-                ungetc(next1, scanner->source);
+                scanUnget(scanner, next1);
             }
         }
         else
         {
             if (character == '\n')
             {
-                scanner->line++;
                 if (firstLine)
                 {
                     firstLine = false;
@@ -402,158 +752,278 @@ static int readMultilineString(Scanner *scanner, Token *token)
 
 // =================== NUMBER PROCESSING ===================
 
+// Clinger fast path: mantissa up to 2^53 and 10^e up to 10^22 are exact doubles, so one
+// multiplication/division gives correctly rounded result, same as strtod
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define FAST_FLOAT_ENABLED 1
+#else
+#define FAST_FLOAT_ENABLED 0
+#endif
+#define FAST_FLOAT_MAX_MANTISSA (1ULL << 53)
+#define FAST_FLOAT_MAX_EXPONENT 22
+#define NUMBER_MAX_EXPONENT 100000  // larger exponents are left for strtod anyway
+
+static const double POWERS_OF_TEN[FAST_FLOAT_MAX_EXPONENT + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
 /**
- * @brief Read numeric literal (int or float)
- * @param scanner Scanner state
- * @param token Token to fill
- * @param firstChar First character already read
- * @return 0 on success, 1 on error
+ * @brief Part of numeric literal the next digit belongs to
  */
-static int readNumber(Scanner *scanner, Token *token, int firstChar)
+typedef enum
 {
-    size_t buffCapacity = 32;
-    size_t strLen = 0;
-    char *buffer = (char *)malloc(buffCapacity);
-    if (!buffer) return 1;
+    NUM_INTEGER,   // digits before '.' (or hex digits)
+    NUM_FRACTION,  // digits after '.'
+    NUM_EXPONENT,  // digits after 'e'
+    NUM_IGNORED,   // digits of another exponent ("1e5e3"), strtod never used them
+} NumberPart;
 
-    buffer[strLen++] = (char)firstChar;
-    bool isFloat = false;
-    bool isHex = false;
+/**
+ * @brief Accumulated value of numeric literal while it is being read
+ */
+typedef struct
+{
+    long long intVal;       // value as integer, saturated to LLONG_MAX like strtoll
+    uint64_t mantissa;      // all significant decimal digits (if exact)
+    bool exact;             // false when mantissa overflowed
+    int fractionDigits;     // digits of mantissa after '.'
+    int exponent;           // absolute value of exponent
+    bool negativeExponent;
+} NumberValue;
+
+/**
+ * @brief State of numeric literal automaton, NUMBER_TRANSITION gives the next one
+ */
+typedef enum
+{
+    NS_DONE,       // literal ended before current character (default transition)
+    NS_ERROR,      // lexical error
+    NS_ZERO,       // leading '0', may start hex literal
+    NS_INT,        // integer digits
+    NS_DOT,        // '.' after integer, float only if digit follows, else '.' is returned
+    NS_FRACTION,   // digits after '.'
+    NS_EXP_SIGN,   // after 'e', sign or digit expected
+    NS_EXP_FIRST,  // after sign of exponent, digit expected
+    NS_EXP,        // exponent digits
+    NS_IGN_SIGN,   // same as NS_EXP_* for another exponent ("1e5e3"), strtod never used it
+    NS_IGN_FIRST,
+    NS_IGN,
+    NS_HEX_START,  // after "0x", hex digit expected
+    NS_HEX,        // hex digits
+    NS_COUNT
+} NumberState;
 
-    // Check for hex literal (0x)
-    if (firstChar == '0')
+/**
+ * @brief Class of character inside numeric literal
+ */
+typedef enum
+{
+    NC_OTHER,  // ends literal (also EOF)
+    NC_DIGIT,  // 0-9
+    NC_HEX,    // a-f and A-F except e/E
+    NC_E,      // e/E, exponent or hex digit
+    NC_X,      // x/X after leading '0'
+    NC_DOT,
+    NC_SIGN,   // '+' or '-'
+    NC_COUNT
+} NumberClass;
+
+static const unsigned char NUMBER_CLASS[256] = {
+    ['0'] = NC_DIGIT, ['1'] = NC_DIGIT, ['2'] = NC_DIGIT, ['3'] = NC_DIGIT,
+    ['4'] = NC_DIGIT, ['5'] = NC_DIGIT, ['6'] = NC_DIGIT, ['7'] = NC_DIGIT,
+    ['8'] = NC_DIGIT, ['9'] = NC_DIGIT,
+    ['a'] = NC_HEX,   ['b'] = NC_HEX,   ['c'] = NC_HEX,   ['d'] = NC_HEX,
+    ['f'] = NC_HEX,
+    ['A'] = NC_HEX,   ['B'] = NC_HEX,   ['C'] = NC_HEX,   ['D'] = NC_HEX,
+    ['F'] = NC_HEX,
+    ['e'] = NC_E,
+    ['E'] = NC_E,
+    ['x'] = NC_X,
+    ['X'] = NC_X,
+    ['.'] = NC_DOT,
+    ['+'] = NC_SIGN,  ['-'] = NC_SIGN,
+};
+
+// Chybějící přechody jsou NS_DONE, literál skončí a znak se vrátí
+static const unsigned char NUMBER_TRANSITION[NS_COUNT][NC_COUNT] = {
+    [NS_ZERO] = {[NC_DIGIT] = NS_INT, [NC_X] = NS_HEX_START, [NC_DOT] = NS_DOT,
+                 [NC_E] = NS_EXP_SIGN},
+    [NS_INT] = {[NC_DIGIT] = NS_INT, [NC_DOT] = NS_DOT, [NC_E] = NS_EXP_SIGN},
+    [NS_DOT] = {[NC_DIGIT] = NS_FRACTION},
+    [NS_FRACTION] = {[NC_DIGIT] = NS_FRACTION, [NC_E] = NS_EXP_SIGN},
+    [NS_EXP_SIGN] = {[NC_OTHER] = NS_ERROR, [NC_DIGIT] = NS_EXP, [NC_HEX] = NS_ERROR,
+                     [NC_E] = NS_ERROR, [NC_X] = NS_ERROR, [NC_DOT] = NS_ERROR,
+                     [NC_SIGN] = NS_EXP_FIRST},
+    [NS_EXP_FIRST] = {[NC_OTHER] = NS_ERROR, [NC_DIGIT] = NS_EXP, [NC_HEX] = NS_ERROR,
+                      [NC_E] = NS_ERROR, [NC_X] = NS_ERROR, [NC_DOT] = NS_ERROR,
+                      [NC_SIGN] = NS_ERROR},
+    [NS_EXP] = {[NC_DIGIT] = NS_EXP, [NC_E] = NS_IGN_SIGN},
+    [NS_IGN_SIGN] = {[NC_OTHER] = NS_ERROR, [NC_DIGIT] = NS_IGN, [NC_HEX] = NS_ERROR,
+                     [NC_E] = NS_ERROR, [NC_X] = NS_ERROR, [NC_DOT] = NS_ERROR,
+                     [NC_SIGN] = NS_IGN_FIRST},
+    [NS_IGN_FIRST] = {[NC_OTHER] = NS_ERROR, [NC_DIGIT] = NS_IGN, [NC_HEX] = NS_ERROR,
+                      [NC_E] = NS_ERROR, [NC_X] = NS_ERROR, [NC_DOT] = NS_ERROR,
+                      [NC_SIGN] = NS_ERROR},
+    [NS_IGN] = {[NC_DIGIT] = NS_IGN, [NC_E] = NS_IGN_SIGN},
+    [NS_HEX_START] = {[NC_OTHER] = NS_ERROR, [NC_DIGIT] = NS_HEX, [NC_HEX] = NS_HEX,
+                      [NC_E] = NS_HEX, [NC_X] = NS_ERROR, [NC_DOT] = NS_ERROR,
+                      [NC_SIGN] = NS_ERROR},
+    [NS_HEX] = {[NC_DIGIT] = NS_HEX, [NC_HEX] = NS_HEX, [NC_E] = NS_HEX},
+};
+
+/**
+ * @brief Add one digit to integer value with saturation
+ * @param value Accumulated value
+ * @param digit Digit value
+ * @param base 10 or 16
+ */
+static inline void numberAddIntDigit(NumberValue *value, int digit, int base)
+{
+    if (value->intVal > (LLONG_MAX - digit) / base)
     {
-        int next = fgetc(scanner->source);
-        if (next == 'x' || next == 'X')
-        {
-            isHex = true;
-            if (strLen >= buffCapacity - 1)
-            {
-                buffCapacity *= 2;
-                char *newBuff = (char *)realloc(buffer, buffCapacity);
-                if (!newBuff)
-                {
-                    free(buffer);
-                    return 1;
-                }
-                buffer = newBuff;
-            }
-            buffer[strLen++] = (char)next;
-        }
-        else
-        {
-            ungetc(next, scanner->source);
-        }
+        value->intVal = LLONG_MAX;
     }
+    else
+    {
+        value->intVal = value->intVal * base + digit;
+    }
+}
 
-    int character;
-    while ((character = fgetc(scanner->source)) != EOF)
+/**
+ * @brief Add one decimal digit to the part of literal it belongs to
+ * @param value Accumulated value
+ * @param part Part of the literal
+ * @param digit Digit value
+ */
+static inline void numberAddDigit(NumberValue *value, NumberPart part, int digit)
+{
+    switch (part)
     {
-        if (isHex)
-        {
-            if (!isxdigit(character))
+        case NUM_INTEGER:
+        case NUM_FRACTION:
+            if (part == NUM_INTEGER)
             {
-                ungetc(character, scanner->source);
-                break;
+                numberAddIntDigit(value, digit, 10);
             }
-        }
-        else if (isdigit(character))
-        {
-            // Continue
-        }
-        else if (character == '.')
-        {
-            if (isFloat)
+            if (value->mantissa <= (UINT64_MAX - 9) / 10)
             {
-                ungetc(character, scanner->source);
-                break;
+                value->mantissa = value->mantissa * 10 + (uint64_t)digit;
+                if (part == NUM_FRACTION) value->fractionDigits++;
             }
-
-            int nextChar = fgetc(scanner->source);
-            if (!isdigit(nextChar))
+            else
             {
-                ungetc(nextChar, scanner->source);
-                ungetc(character, scanner->source);
-                break;
+                value->exact = false;
+            }
+            break;
+        case NUM_EXPONENT:
+            if (value->exponent < NUMBER_MAX_EXPONENT)
+            {
+                value->exponent = value->exponent * 10 + digit;
             }
-            ungetc(nextChar, scanner->source);
+            break;
+        case NUM_IGNORED:
+            break;
+    }
+}
 
-            isFloat = true;
-        }
-        else if (character == 'e' || character == 'E')
-        {
-            isFloat = true;
-    buffer[strLen++] = character;
+/**
+ * @brief Convert accumulated float literal to double, identical to strtod
+ * @param value Accumulated value
+ * @param text Start of literal in source buffer (for strtod fallback)
+ * @return Value of the literal
+ */
+static double numberToDouble(const NumberValue *value, const char *text)
+{
+    int exponent = (value->negativeExponent ? -value->exponent : value->exponent) -
+                   value->fractionDigits;
 
-    int sign = fgetc(scanner->source);
-    if (sign == '+' || sign == '-')
-    {
-        buffer[strLen++] = sign;
-    }
-    else
+    if (FAST_FLOAT_ENABLED && value->exact && value->mantissa <= FAST_FLOAT_MAX_MANTISSA &&
+        exponent >= -FAST_FLOAT_MAX_EXPONENT && exponent <= FAST_FLOAT_MAX_EXPONENT)
     {
-        ungetc(sign, scanner->source);
+        double mantissa = (double)value->mantissa;
+        return exponent < 0 ? mantissa / POWERS_OF_TEN[-exponent]
+                            : mantissa * POWERS_OF_TEN[exponent];
     }
 
-    int next = fgetc(scanner->source);
-    if (!isdigit(next))
-    {
-        free(buffer);
-        return 1;   // INVALID EXPONENT → lexical error
-    }
+    // Těžké případy (dlouhá mantisa, velký exponent) řeší strtod přímo nad bufferem,
+    // za literálem vždy následuje znak, který strtod do čísla nezahrne
+    return strtod(text, NULL);
+}
 
-    buffer[strLen++] = next;
-    continue;
-        }
-        else
-        {
-            ungetc(character, scanner->source);
-            break;
-        }
+/**
+ * @brief Read numeric literal (int or float)
+ * @details Automaton NUMBER_TRANSITION decides where literal ends, value is accumulated
+ *          by the state entered. Nothing is allocated except TokenValue.
+ * @param scanner Scanner state
+ * @param token Token to fill
+ * @param firstChar First character already read
+ * @return 0 on success, 1 on error
+ */
+static int readNumber(Scanner *scanner, Token *token, int firstChar)
+{
+    const char *text = scanner->buffer + scanner->pos - 1;
+    NumberValue value = {0, 0, true, 0, 0, false};
+    NumberState state = firstChar == '0' ? NS_ZERO : NS_INT;
+    numberAddDigit(&value, NUM_INTEGER, firstChar - '0');
 
-        if (strLen >= buffCapacity - 1)
+    int character;
+    NumberState next;
+    do
+    {
+        character = scanGet(scanner);
+        next = NUMBER_TRANSITION[state][character == EOF ? NC_OTHER : NUMBER_CLASS[character]];
+        switch (next)
         {
-            buffCapacity *= 2;
-            char *newBuff = (char *)realloc(buffer, buffCapacity);
-            if (!newBuff)
-            {
-                free(buffer);
-                return 1;
-            }
-            buffer = newBuff;
+            case NS_ERROR:
+                return 1;  // exponent or hex literal without digits
+            case NS_INT:
+                numberAddDigit(&value, NUM_INTEGER, character - '0');
+                break;
+            case NS_FRACTION:
+                numberAddDigit(&value, NUM_FRACTION, character - '0');
+                break;
+            case NS_EXP_FIRST:
+                value.negativeExponent = (character == '-');
+                break;
+            case NS_EXP:
+                numberAddDigit(&value, NUM_EXPONENT, character - '0');
+                break;
+            case NS_HEX:
+                numberAddIntDigit(&value, hexToInt(character), 16);
+                break;
+            case NS_DONE:
+                scanUnget(scanner, character);
+                break;
+            default:
+                break;  // stavy bez hodnoty (tečka, 'e', znaménko, "0x")
         }
-        buffer[strLen++] = (char)character;
-    }
+        if (next != NS_DONE) state = next;
+    } while (next != NS_DONE);
 
-    // Check for hex numbers without numbers (0x...)
-    if (isHex && strLen <= 2)
+    // Tečka bez číslice za ní patří dalšímu tokenu
+    if (state == NS_DOT)
     {
-        free(buffer);
-        return 1;
+        scanUnget(scanner, '.');
     }
 
-
-    buffer[strLen] = '\0';
-
     token->value = allocTokenValue();
     if (!token->value)
     {
-        free(buffer);
         return 1;
     }
 
-    if (isFloat)
+    if (state == NS_FRACTION || state == NS_EXP || state == NS_IGN)
     {
         token->type = FLOAT_LITERAL;
-        token->value->floatVal = strtod(buffer, NULL);
+        token->value->floatVal = numberToDouble(&value, text);
     }
     else
     {
         token->type = INT_LITERAL;
-        token->value->intVal = strtoll(buffer, NULL, isHex ? 16 : 10);
+        token->value->intVal = value.intVal;
     }
 
-    free(buffer);
     return 0;
 }
 
@@ -565,15 +1035,8 @@ static int readNumber(Scanner *scanner, Token *token, int firstChar)
  */
 static void skipLineComment(Scanner *scanner)
 {
-    int character;
-    while ((character = fgetc(scanner->source)) != EOF && character != '\n')
-    {
-        // Skip until newline
-    }
-    if (character == '\n')
-    {
-        scanner->line++;
-    }
+    scanSkip(scanner, scanner->kernels->findLineEnd, NULL);
+    scanGet(scanner);  // '\n' patří ke komentáři
 }
 
 /**
@@ -586,34 +1049,37 @@ static int skipBlockComment(Scanner *scanner)
     int depth = 1;
     int character;
 
-    while (depth > 0 && (character = fgetc(scanner->source)) != EOF)
+    while (depth > 0)
     {
-        if (character == '\n')
+        // Přeskočíme vše až po '\n', '*' nebo '/'
+        scanSkip(scanner, scanner->kernels->findCommentStop, NULL);
+        if ((character = scanGet(scanner)) == EOF)
         {
-            scanner->line++;
+            break;
         }
-        else if (character == '/')
+
+        if (character == '/')
         {
-            int next = fgetc(scanner->source);
+            int next = scanGet(scanner);
             if (next == '*')
             {
                 depth++;
             }
             else
             {
-                ungetc(next, scanner->source);
+                scanUnget(scanner, next);
             }
         }
         else if (character == '*')
         {
-            int next = fgetc(scanner->source);
+            int next = scanGet(scanner);
             if (next == '/')
             {
                 depth--;
             }
             else
             {
-                ungetc(next, scanner->source);
+                scanUnget(scanner, next);
             }
         }
     }
@@ -621,13 +1087,80 @@ static int skipBlockComment(Scanner *scanner)
     return (depth == 0) ? 0 : 1;
 }
 
+// ==================== IDENTIFIER PROCESSING ====================
+
+/**
+ * @brief Read identifier, global identifier (__xxx) or keyword
+ * @param scanner Scanner state
+ * @param token Token to fill
+ * @param firstChar First character already read
+ * @return 0 on success, 1 on error
+ */
+static int readIdentifier(Scanner *scanner, Token *token, int firstChar)
+{
+    size_t buffCapacity = 32;
+    size_t strLen = 0;
+    char *buffer = (char *)malloc(buffCapacity);
+    if (!buffer) return 1;
+
+    buffer[strLen++] = (char)firstChar;
+
+    // Check for global identifier (__xxx)
+    bool isGlobal = false;
+    if (firstChar == '_')
+    {
+        int next = scanGet(scanner);
+        if (next == '_')
+        {
+            isGlobal = true;
+            buffer[strLen++] = (char)next;
+        }
+        else
+        {
+            scanUnget(scanner, next);
+        }
+    }
+
+    // Read rest of identifier
+    int character;
+    while (charHas(character = scanGet(scanner), CF_IDENT_PART))
+    {
+        if (strLen >= buffCapacity - 1)
+        {
+            buffCapacity *= 2;
+            char *newBuff = (char *)realloc(buffer, buffCapacity);
+            if (!newBuff)
+            {
+                free(buffer);
+                return 1;
+            }
+            buffer = newBuff;
+        }
+        buffer[strLen++] = (char)character;
+    }
+    scanUnget(scanner, character);
+
+    buffer[strLen] = '\0';
+
+    token->type = isGlobal ? GLOBAL_IDENTIFIER : identifyKeywordLen(buffer, strLen);
+
+    token->value = allocTokenValue();
+    if (!token->value)
+    {
+        free(buffer);
+        return 1;
+    }
+    token->value->stringVal = buffer;
+    return 0;
+}
+
 // ==================== MAIN INTERNAL TOKEN GETTER ===================
 
 /**
  * @brief Low-level function to extract the next raw token from source
- * @details Skips whitespace and comments. Identifies single-char tokens,
- * operators, and delegates complex tokens (strings, numbers, IDs) 
- * to helper functions.
+ * @details Skips whitespace and comments. Transition is chosen by CHAR_KIND of the
+ * first character, operators are resolved by CHAR_TOKEN / CHAR_TOKEN_EQ tables and
+ * complex tokens (strings, numbers, IDs) are delegated to helper functions.
  * @param scanner Scanner state
  * @param token Pointer to where the token data will be stored
  * @return 0 on success, 1 on lexical error
@@ -635,14 +1168,14 @@ static int skipBlockComment(Scanner *scanner)
 int getRawToken(Scanner *scanner, Token *token)
 {
     memset(token, 0, sizeof(Token));
-    token->line = scanner->line;
 
     int character;
 
     // Skip whitespace and comments
     while (true)
     {
-        character = fgetc(scanner->source);
+        character = scanGet(scanner);
+        token->offset = (uint32_t)(scanner->pos - (character != EOF));
 
         if (character == EOF)
         {
@@ -650,31 +1183,30 @@ int getRawToken(Scanner *scanner, Token *token)
             return 0;
         }
 
-        // Skip whitespace (not newline)
-        if (isWhiteSpace(character))
+        CharKind kind = CHAR_KIND[character];
+
+        // Skip whitespace (not newline), odsazení přeskočí kernel najednou
+        if (kind == CHAR_SPACE)
         {
+            scanSkip(scanner, scanner->kernels->skipSpaces, NULL);
             continue;
         }
-        if (character == '\r') continue;
 
         // Handle newline
-        if (character == '\n')
+        if (kind == CHAR_NEWLINE)
         {
             token->type = EOL;
-            token->line = scanner->line;
-            scanner->line++;
             return 0;
         }
 
         // Handle comments
-        if (character == '/')
+        if (kind == CHAR_SLASH)
         {
-            int next = fgetc(scanner->source);
+            int next = scanGet(scanner);
             if (next == '/')
             {
                 skipLineComment(scanner);
                 token->type = EOL;
-                token->line = scanner->line;
                 return 0;
             }
             else if (next == '*')
@@ -688,7 +1220,7 @@ int getRawToken(Scanner *scanner, Token *token)
             }
             else
             {
-                ungetc(next, scanner->source);
+                scanUnget(scanner, next);
                 token->type = DIVIDE;
                 return 0;
             }
@@ -698,146 +1230,54 @@ int getRawToken(Scanner *scanner, Token *token)
     }
 
     // Process tokens
-    switch (character)
+    switch ((CharKind)CHAR_KIND[character])
     {
-        case '(':
-            token->type = LPAR;
-            return 0;
-        case ')':
-            token->type = RPAR;
-            return 0;
-        case '{':
-            token->type = LCURLY;
-            return 0;
-        case '}':
-            token->type = RCURLY;
-            return 0;
-        case ',':
-            token->type = COMMA;
-            return 0;
-        case '.':
-            token->type = DOT;
-            return 0;
-        case '+':
-            token->type = PLUS;
-            return 0;
-        case '-':
-            token->type = MINUS;
-            return 0;
-        case '*':
-            token->type = MULTIPLY;
-            return 0;
-        case '?':
-            token->type = TERNARY_QUESTION;
-            return 0;
-        case ':':
-            token->type = TERNARY_COLON;
-            return 0;
-        case '=':
-        {
-            int next = fgetc(scanner->source);
-            if (next == '=')
-            {
-                token->type = IS_EQUAL;
-            }
-            else
-            {
-                ungetc(next, scanner->source);
-                token->type = ASSIGN;
-            }
+        case CHAR_SINGLE:
+            token->type = CHAR_TOKEN[character];
             return 0;
-        }
 
-        case '<':
+        case CHAR_EQ_OPERATOR:
         {
-            int next = fgetc(scanner->source);
+            int next = scanGet(scanner);
             if (next == '=')
             {
-                token->type = IS_SMALLER_OR_EQUAL;
+                token->type = CHAR_TOKEN_EQ[character];
             }
             else
             {
-                ungetc(next, scanner->source);
-                token->type = IS_SMALLER;
+                scanUnget(scanner, next);
+                token->type = CHAR_TOKEN[character];
             }
             return 0;
         }
 
-        case '>':
+        case CHAR_DOUBLE_OPERATOR:
         {
-            int next = fgetc(scanner->source);
-            if (next == '=')
-            {
-                token->type = IS_BIGGER_OR_EQUAL;
-            }
-            else
+            // Only "&&" and "||" exist, single '&' or '|' is an error
+            int next = scanGet(scanner);
+            if (next == character)
             {
-                ungetc(next, scanner->source);
-                token->type = IS_BIGGER;
-            }
-            return 0;
-        }
-
-        case '!':
-        {
-            int next = fgetc(scanner->source);
-            if (next == '=')
-            {
-                token->type = IS_NOT_EQUAL;
-                return 0;
-            }
-            else
-            {
-                ungetc(next, scanner->source);
-                token->type = LOGICAL_NOT;
+                token->type = CHAR_TOKEN[character];
                 return 0;
             }
+            token->type = TOKEN_ERROR;
+            return 1;
         }
 
-        case '&':
-        {
-            int next = fgetc(scanner->source);
-            if (next == '&')
-            {
-                token->type = LOGICAL_AND;
-                return 0;
-            }
-            else
-            {
-                token->type = TOKEN_ERROR;
-                return 1;
-            }
-        }
-
-        case '|':
-        {
-            int next = fgetc(scanner->source);
-            if (next == '|')
-            {
-                token->type = LOGICAL_OR;
-                return 0;
-            }
-            else
-            {
-                token->type = TOKEN_ERROR;
-                return 1;
-            }
-        }
-
-        case '"':
+        case CHAR_QUOTE:
         {
             // Check for multiline string
-            int next1 = fgetc(scanner->source);
+            int next1 = scanGet(scanner);
             if (next1 == '"')
             {
-                int next2 = fgetc(scanner->source);
+                int next2 = scanGet(scanner);
                 if (next2 == '"')
                 {
                     return readMultilineString(scanner, token);
                 }
                 else
                 {
-                    ungetc(next2, scanner->source);
+                    scanUnget(scanner, next2);
                     // Empty string
                     token->type = STRING_LITERAL;
                     token->value = allocTokenValue();
@@ -851,179 +1291,121 @@ int getRawToken(Scanner *scanner, Token *token)
             }
             else
             {
-                ungetc(next1, scanner->source);
+                scanUnget(scanner, next1);
                 return readString(scanner, token);
             }
         }
 
-        default:
-        {
+        case CHAR_IDENT:
             // Identifiers and KEYWORDS
-            if (isIdentifierStart(character))
-            {
-                size_t buffCapacity = 32;
-                size_t strLen = 0;
-                char *buffer = (char *)malloc(buffCapacity);
-                if (!buffer) return 1;
-
-                buffer[strLen++] = (char)character;
+            return readIdentifier(scanner, token, character);
 
-                // Check for global identifier (__xxx)
-                bool isGlobal = false;
-                if (character == '_')
-                {
-                    int next = fgetc(scanner->source);
-                    if (next == '_')
-                    {
-                        isGlobal = true;
-                        if (strLen >= buffCapacity - 1)
-                        {
-                            buffCapacity *= 2;
-                            char *newBuff = (char *)realloc(buffer, buffCapacity);
-                            if (!newBuff)
-                            {
-                                free(buffer);
-                                return 1;
-                            }
-                            buffer = newBuff;
-                        }
-                        buffer[strLen++] = (char)next;
-                    }
-                    else
-                    {
-                        ungetc(next, scanner->source);
-                    }
-                }
-
-                // Read rest of identifier
-                while ((character = fgetc(scanner->source)) != EOF && isIdentifierPart(character))
-                {
-                    if (strLen >= buffCapacity - 1)
-                    {
-                        buffCapacity *= 2;
-                        char *newBuff = (char *)realloc(buffer, buffCapacity);
-                        if (!newBuff)
-                        {
-                            free(buffer);
-                            return 1;
-                        }
-                        buffer = newBuff;
-                    }
-                    buffer[strLen++] = (char)character;
-                }
-                ungetc(character, scanner->source);
-
-                buffer[strLen] = '\0';
-
-                if (isGlobal)
-                {
-                    token->type = GLOBAL_IDENTIFIER;
-                }
-                else
-                {
-                    token->type = identifyKeyword(buffer);
-                }
-
-                token->value = allocTokenValue();
-                if (!token->value)
-                {
-                    free(buffer);
-                    return 1;
-                }
-                token->value->stringVal = buffer;
-                return 0;
-            }
-
-            // Numbers
-            if (isdigit(character))
-            {
-                return readNumber(scanner, token, character);
-            }
+        case CHAR_DIGIT:
+            return readNumber(scanner, token, character);
 
+        default:
             // Unknown character
             token->type = TOKEN_ERROR;
             return 1;
-        }
     }
 }
 
 // ==================== PUBLIC TOKEN GETTER ===================
 
 /**
- * @brief Main public API to get the next valid token
- * @details Checks the lookahead buffer first. If empty, calls getRawToken.
- * Also handles filtering of redundant EOL tokens (merges multiple newlines).
+ * @brief Get next raw token with redundant EOL tokens filtered out (merges multiple newlines)
  * @param scanner Scanner state
  * @param token Pointer to where the token data will be stored
  * @return 0 on success, 1 on lexical error
  */
-int getNextToken(Scanner *scanner, Token *token)
+static int getFilteredToken(Scanner *scanner, Token *token)
 {
-    if (scanner->isLookingAhead)
+    // Tokeny z paralelního lexování jsou už filtrované, jen se přesunou
+    if (scanner->preNext < scanner->preCount)
     {
-        *token = scanner->lookAheadToken;
-        scanner->isLookingAhead = false;
-        memset(&scanner->lookAheadToken, 0, sizeof(Token));
+        Token *pre = &scanner->preTokens[scanner->preNext++];
+        *token = *pre;
+        pre->value = NULL;
 
-        if (token->type == EOL)
-        {
-            scanner->lastWasEOL = true;
-        }
-        else
+        if (scanner->preError && scanner->preNext == scanner->preCount)
         {
-            scanner->lastWasEOL = false;
+            scanner->pos = scanner->preErrorPos;
+            return 1;
         }
         return 0;
     }
 
-    int result = getRawToken(scanner, token);
-    if (result != 0)
+    while (true)
     {
-        return result;
-    }
+        int result = getRawToken(scanner, token);
+        if (result != 0)
+        {
+            return result;
+        }
 
-    // Filter multiple consecutive EOLs
-    if (token->type == EOL)
-    {
-        if (scanner->lastWasEOL)
+        // Filter multiple consecutive EOLs
+        if (token->type == EOL && scanner->lastWasEOL)
         {
-            // Skip this EOL and get next token
-            return getNextToken(scanner, token);
+            continue;
         }
-        scanner->lastWasEOL = true;
+
+        scanner->lastWasEOL = (token->type == EOL);
+        return 0;
     }
-    else
+}
+
+/**
+ * @brief Main public API to get (consume) the next valid token
+ * @details Takes the oldest token from the lookahead ring, or reads a new one when the
+ * ring is empty. Ownership of token value moves to the caller, nothing is copied.
+ * @param scanner Scanner state
+ * @param token Pointer to where the token data will be stored
+ * @return 0 on success, 1 on lexical error
+ */
+int getNextToken(Scanner *scanner, Token *token)
+{
+    if (scanner->ringCount > 0)
     {
-        scanner->lastWasEOL = false;
+        Token *head = &scanner->ring[scanner->ringHead];
+        *token = *head;
+        head->value = NULL;
+        scanner->ringHead = (scanner->ringHead + 1) & (TOKEN_RING_SIZE - 1);
+        scanner->ringCount--;
+        return 0;
     }
 
-    return 0;
+    return getFilteredToken(scanner, token);
 }
 
 /**
- * @brief Peeks at the next token without consuming it from the parser's perspective
- * @details Stores the token in the scanner's lookahead buffer. Subsequent calls
- * to getNextToken will return this stored token.
+ * @brief Peeks at the k-th next token (0 = the one getNextToken returns) without consuming it
+ * @details Missing tokens are read into the lookahead ring. Returned token stays owned by
+ * the scanner and is valid until it is consumed by getNextToken.
  * @param scanner Scanner state
- * @param token Pointer where the lookahead token data will be copied
+ * @param k Lookahead distance, less than TOKEN_RING_SIZE
+ * @param token Set to the token in ring
  * @return 0 on success, 1 on lexical error
  */
-int lookAhead(Scanner *scanner, Token *token)
+int scannerPeek(Scanner *scanner, unsigned k, Token **token)
 {
-    if (scanner->isLookingAhead)
+    if (k >= TOKEN_RING_SIZE)
     {
-        *token = scanner->lookAheadToken;
-        return 0;
+        errorExit(INTERNAL_ERROR, "Scanner lookahead too deep", scannerLine(scanner), NULL);
     }
 
-    int result = getNextToken(scanner, &scanner->lookAheadToken);
-    if (result != 0)
+    while (scanner->ringCount <= k)
     {
-        return result;
+        Token *slot =
+            &scanner->ring[(scanner->ringHead + scanner->ringCount) & (TOKEN_RING_SIZE - 1)];
+        if (getFilteredToken(scanner, slot) != 0)
+        {
+            freeToken(slot);
+            return 1;
+        }
+        scanner->ringCount++;
     }
 
-    scanner->isLookingAhead = true;
-    *token = scanner->lookAheadToken;
+    *token = &scanner->ring[(scanner->ringHead + k) & (TOKEN_RING_SIZE - 1)];
     return 0;
 }
 
@@ -1043,7 +1425,7 @@ int readPrologue(Scanner *scanner)
         // it is a LEXICAL ERROR (Exit Code 1)
         if (getNextToken(scanner, &token) != 0)
         {
-            errorExit(LEXICAL_ERROR, "Lexical error before prologue", scanner->line, NULL);
+            errorExit(LEXICAL_ERROR, "Lexical error before prologue", scannerLine(scanner), NULL);
         }
     } while (token.type == EOL);
 
@@ -1051,55 +1433,55 @@ int readPrologue(Scanner *scanner)
     // If token is valid (e.g. '+') but not 'import', it is a SYNTAX ERROR (Exit Code 2)
     if (token.type != KW_IMPORT)
     {
-        errorExit(SYNTAX_ERROR, "Prologue must start with 'import'", scanner->line, &token);
+        errorExit(SYNTAX_ERROR, "Prologue must start with 'import'", tokenLine(&token), &token);
     }
     freeToken(&token);
 
     // 2. Check for "ifj25" string literal
     if (getNextToken(scanner, &token) != 0)
     {
-        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scanner->line, NULL);
+        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scannerLine(scanner), NULL);
     }
     if (token.type != STRING_LITERAL)
     {
-        errorExit(SYNTAX_ERROR, "Expected string literal after import", scanner->line, &token);
+        errorExit(SYNTAX_ERROR, "Expected string literal after import", tokenLine(&token), &token);
     }
     if (!token.value || !token.value->stringVal || strcmp(token.value->stringVal, "ifj25") != 0)
     {
-        errorExit(SYNTAX_ERROR, "Imported module must be \"ifj25\"", scanner->line, &token);
+        errorExit(SYNTAX_ERROR, "Imported module must be \"ifj25\"", tokenLine(&token), &token);
     }
     freeToken(&token);
 
     // 3. Check for 'for' keyword
     if (getNextToken(scanner, &token) != 0)
     {
-        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scanner->line, NULL);
+        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scannerLine(scanner), NULL);
     }
     if (token.type != KW_FOR)
     {
-        errorExit(SYNTAX_ERROR, "Expected 'for' after module name", scanner->line, &token);
+        errorExit(SYNTAX_ERROR, "Expected 'for' after module name", tokenLine(&token), &token);
     }
     freeToken(&token);
 
     // 4. Check for 'Ifj' keyword
     if (getNextToken(scanner, &token) != 0)
     {
-        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scanner->line, NULL);
+        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scannerLine(scanner), NULL);
     }
     if (token.type != KW_IFJ)
     {
-        errorExit(SYNTAX_ERROR, "Expected 'Ifj' after for", scanner->line, &token);
+        errorExit(SYNTAX_ERROR, "Expected 'Ifj' after for", tokenLine(&token), &token);
     }
     freeToken(&token);
 
     // 5. Check for End of Line (prologue must be on its own line)
     if (getNextToken(scanner, &token) != 0)
     {
-        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scanner->line, NULL);
+        errorExit(LEXICAL_ERROR, "Lexical error in prologue", scannerLine(scanner), NULL);
     }
     if (token.type != EOL && token.type != EOF_TOKEN)
     {
-        errorExit(SYNTAX_ERROR, "Prologue must end with newline", scanner->line, &token);
+        errorExit(SYNTAX_ERROR, "Prologue must end with newline", tokenLine(&token), &token);
     }
     freeToken(&token);
 
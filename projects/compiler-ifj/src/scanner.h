@@ -8,8 +8,13 @@
 #define SCANNER_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
+#include "scankernel.h"
+#include "sourcemap.h"
+
 typedef enum
 {
     // --- KEYWORDS ---
@@ -84,17 +89,29 @@ typedef struct
 typedef struct
 {
     TokenType type;
+    uint32_t offset;  // Byte offset of token start, line/column via tokenLine/tokenLocation
     TokenValue *value;
-    int line;  // To know where we ended, when error occurs (copied from Scanner during analysis)
 } Token;
 
+#define TOKEN_RING_SIZE 4  // Maximum lookahead of scannerPeek, power of two
+
 typedef struct
 {
-    FILE *source;       // Input stream
-    int line;           // Current line number (tracked during scanning)
+    FILE *source;       // Input stream (read whole by initScanner)
+    char *buffer;       // Content of source, followed by SCAN_KERNEL_PADDING zero bytes
+    size_t length;      // Number of bytes of source in buffer
+    size_t pos;         // Index of next byte to read
+    const ScanKernels *kernels;  // Skip kernels for whitespace, comments and strings
+    Token *preTokens;   // Tokens lexed in parallel by prelexSource (NULL when sequential)
+    size_t preCount;    // Number of tokens in preTokens
+    size_t preNext;     // Index of the next token to hand out
+    bool preError;      // Last token of preTokens is a lexical error
+    size_t preErrorPos; // Scanner position at that error
+    SourceMap map;      // Line starts of source, line numbers are computed only on demand
     bool prologueRead;  // Flag if prologue was read
-    Token lookAheadToken;
-    bool isLookingAhead;
+    Token ring[TOKEN_RING_SIZE];  // Tokens read ahead, owned by scanner until consumed
+    unsigned ringHead;            // Index of the oldest token in ring
+    unsigned ringCount;           // Number of tokens in ring
     bool lastWasEOL;
 } Scanner;
 
@@ -103,7 +120,10 @@ TokenType identifyKeyword(const char *str);
 int readPrologue(Scanner *scanner);
 void initScanner(Scanner *scanner, FILE *source);
 void disposeScanner(Scanner *scanner);
-int lookAhead(Scanner *scanner, Token *token);
+int scannerPeek(Scanner *scanner, unsigned k, Token **token);
 void freeToken(Token *token);
+int scannerLine(const Scanner *scanner);
+int tokenLine(const Token *token);
+SourceLocation tokenLocation(const Token *token);
 
 #endif  // SCANNER_H
\ No newline at end of file
@@ -8,13 +8,17 @@
 
 #include "semantic.h"
 
+#include <setjmp.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "error.h"
+#include "stats.h"
 #include "symtable.h"
+#include "threadpool.h"
 
 /**
  * @brief Used to find exact symbol for function
@@ -274,19 +278,32 @@ void semanticExpression(AstNode* node)
             {
                 semanticExpression(right);
                 if (!(right->expressionType & TYPE_BOOL) && right->expressionType != TYPE_UNKNOWN)
-                    errorExit(SEM_TYPE, "Operand of '!' must be boolean", node->token.line,
+                    errorExit(SEM_TYPE, "Operand of '!' must be boolean", tokenLine(&node->token),
                               &node->token);
                 node->expressionType = TYPE_BOOL;
                 return;
             }
 
-            semanticExpression(left);
-            semanticExpression(right);
+            // Levá větev řetězce operátorů se prochází cyklem zdola nahoru
+            NodeVec spine;
+            nodeVecInit(&spine);
+            astLeftSpine(node, &spine);
+            semanticExpression(((AstBin*)spine.items[spine.count - 1]->children)->left);
 
-            if (!checkBinaryTypes(left, node, right))
-                errorExit(SEM_TYPE, "Type mismatch in expression", node->token.line, &node->token);
+            for (long i = spine.count - 1; i >= 0; i--)
+            {
+                AstNode* op = spine.items[i];
+                left = ((AstBin*)op->children)->left;
+                right = ((AstBin*)op->children)->right;
+                semanticExpression(right);
 
-            node->expressionType = getBinaryResultType(left, node, right);
+                if (!checkBinaryTypes(left, op, right))
+                    errorExit(SEM_TYPE, "Type mismatch in expression", tokenLine(&op->token),
+                              &op->token);
+
+                op->expressionType = getBinaryResultType(left, op, right);
+            }
+            nodeVecDispose(&spine);
             return;
         }
 
@@ -324,7 +341,7 @@ void semanticAssignment(AstNode* node)
     if (left->expressionType != TYPE_UNKNOWN && right->expressionType != TYPE_UNKNOWN &&
         left->expressionType != right->expressionType)
     {
-        errorExit(SEM_TYPE, "Invalid assignment: incompatible types", left->token.line,
+        errorExit(SEM_TYPE, "Invalid assignment: incompatible types", tokenLine(&left->token),
                   &left->token);
     }
 
@@ -386,7 +403,7 @@ void checkFunctionCallNode(AstNode* node, SymTableStack* stack)
     AstNode* paramsNode = ((AstBin*)node->children)->right;
     int argc = 0;
     if (paramsNode && paramsNode->type == AST_PARAMS)
-        argc = ((AstN*)paramsNode->children)->childrenList->count;
+        argc = ((AstN*)paramsNode->children)->nodes.count;
 
     // 2. Try to find Exact Match (name$argc)
     Symbol* exact = findFunctionExact(stack, name, argc);
@@ -395,11 +412,10 @@ void checkFunctionCallNode(AstNode* node, SymTableStack* stack)
         // Check argument types against definition
         if (paramsNode)
         {
-            ListItem* argItem = ((AstN*)paramsNode->children)->childrenList->firstItem;
-            for (int i = 0; i < argc; i++)
+            NodeVec* args = &((AstN*)paramsNode->children)->nodes;
+            for (int i = 0; i < argc && i < args->count; i++)
             {
-                if (!argItem) break;
-                AstNode* arg = argItem->item;
+                AstNode* arg = args->items[i];
 
                 // Argument types must match
                 ExprType expected = exact->paramTypes[i];
@@ -407,15 +423,15 @@ void checkFunctionCallNode(AstNode* node, SymTableStack* stack)
 
                 if ((expected & got) == 0 && expected != TYPE_UNKNOWN)
                 {
-                    errorExit(SEM_ARG, "Invalid argument type for function", arg->token.line,
+                    errorExit(SEM_ARG, "Invalid argument type for function", tokenLine(&arg->token),
                               &arg->token);
                 }
-                argItem = argItem->next;
             }
         }
 
         // Success: Update node type
         node->expressionType = exact->expressionType;
+        node->symbol = exact;
         return;
     }
 
@@ -424,7 +440,8 @@ void checkFunctionCallNode(AstNode* node, SymTableStack* stack)
     if (getter)
     {
         if (argc != 0)
-            errorExit(SEM_ARG, "Getter cannot take arguments", node->token.line, &node->token);
+            errorExit(SEM_ARG, "Getter cannot take arguments", tokenLine(&node->token),
+                      &node->token);
 
         node->expressionType = getter->expressionType;
         return;
@@ -434,7 +451,7 @@ void checkFunctionCallNode(AstNode* node, SymTableStack* stack)
     Symbol* setter = findSetter(stack, name);
     if (setter)
     {
-        errorExit(SEM_TYPE, "Setter cannot be called as a function", node->token.line,
+        errorExit(SEM_TYPE, "Setter cannot be called as a function", tokenLine(&node->token),
                   &node->token);
     }
 
@@ -442,18 +459,168 @@ void checkFunctionCallNode(AstNode* node, SymTableStack* stack)
     Symbol* overload = findFunctionAnyArity(stack, name);
     if (overload)
     {
-        errorExit(SEM_ARG, "Wrong number of arguments", node->token.line, &node->token);
+        errorExit(SEM_ARG, "Wrong number of arguments", tokenLine(&node->token), &node->token);
     }
 
     // 6. Undefined
-    errorExit(SEM_UNDEF, "Call to undefined function", node->token.line, &node->token);
+    errorExit(SEM_UNDEF, "Call to undefined function", tokenLine(&node->token), &node->token);
+}
+
+/* --------------------------------------------------------- */
+/* DEFERRED TYPE RESOLUTION                                  */
+/* --------------------------------------------------------- */
+
+/**
+ * @brief Symbol known to resolver, with return items when it is a function
+ */
+typedef struct
+{
+    Symbol* symbol;  // NULL = empty slot
+    long returns;    // first edge of return items of function, -1 = none
+    ExprType base;   // return type of function from returns known already while parsing
+} TypeSymbol;
+
+/**
+ * @brief Type of global symbol set by a function checked in parallel
+ */
+typedef struct
+{
+    Symbol* symbol;
+    ExprType type;
+} TypeWrite;
+
+/**
+ * @brief State of one sweep over resolveLater items
+ *
+ * Items are visited once in source order. Final types of variables and functions are
+ * computed afterwards by inferProgram, the sweep only checks the items and gives symbols
+ * their first types.
+ */
+typedef struct
+{
+    SymTableStack* stack;
+    NodeVec* items;
+    TypeSymbol* symbols;  // open addressing table keyed by symbol
+    long symbolCapacity;  // power of two
+    long symbolCount;
+    long* edgeItem;       // return edge lists of symbols, item index
+    long* edgeNext;       // next edge of the same list, -1 = end
+    long edgeCount;
+    long edgeCapacity;
+    bool report;          // errors are reported (outside of return)
+    bool deferGlobals;    // types of global symbols are only recorded into writes
+    TypeWrite* writes;    // deferred writes in order of execution
+    long writeCount;
+    long writeCapacity;
+} TypeResolver;
+
+static void* typeAlloc(size_t size)
+{
+    void* memory = malloc(size);
+    if (!memory) errorExit(INTERNAL_ERROR, "Failed to allocate type resolver", 0, NULL);
+    return memory;
+}
+
+static TypeSymbol* typeSymbolFind(TypeResolver* res, Symbol* symbol)
+{
+    unsigned long hash = (unsigned long)(uintptr_t)symbol >> 4;
+    long mask = res->symbolCapacity - 1;
+    long i = (long)(hash * 2654435761UL) & mask;
+    while (res->symbols[i].symbol && res->symbols[i].symbol != symbol) i = (i + 1) & mask;
+    return &res->symbols[i];
+}
+
+static TypeSymbol* typeSymbolGet(TypeResolver* res, Symbol* symbol)
+{
+    // Tabulka je nejvýš z poloviny plná
+    if ((res->symbolCount + 1) * 2 > res->symbolCapacity)
+    {
+        TypeSymbol* old = res->symbols;
+        long oldCapacity = res->symbolCapacity;
+        res->symbolCapacity *= 2;
+        res->symbols = typeAlloc(sizeof(TypeSymbol) * res->symbolCapacity);
+        for (long i = 0; i < res->symbolCapacity; i++) res->symbols[i].symbol = NULL;
+        for (long i = 0; i < oldCapacity; i++)
+        {
+            if (old[i].symbol) *typeSymbolFind(res, old[i].symbol) = old[i];
+        }
+        free(old);
+    }
+
+    TypeSymbol* entry = typeSymbolFind(res, symbol);
+    if (!entry->symbol)
+    {
+        entry->symbol = symbol;
+        entry->returns = -1;
+        entry->base = symbol->expressionType & ~TYPE_UNKNOWN;
+        res->symbolCount++;
+    }
+    return entry;
+}
+
+static void typeEdgeAdd(TypeResolver* res, long* head, long item)
+{
+    if (res->edgeCount == res->edgeCapacity)
+    {
+        res->edgeCapacity *= 2;
+        res->edgeItem = realloc(res->edgeItem, sizeof(long) * res->edgeCapacity);
+        res->edgeNext = realloc(res->edgeNext, sizeof(long) * res->edgeCapacity);
+        if (!res->edgeItem || !res->edgeNext)
+            errorExit(INTERNAL_ERROR, "Failed to allocate type resolver", 0, NULL);
+    }
+
+    res->edgeItem[res->edgeCount] = item;
+    res->edgeNext[res->edgeCount] = *head;
+    *head = res->edgeCount++;
+}
+
+static bool typeSymbolGlobal(SymTableStack* stack, Symbol* symbol)
+{
+    return scopeFindSymbol(stack->scopes[0], symbol->name) == symbol;
+}
+
+/**
+ * @brief Record write of global symbol, it is applied after the parallel part
+ */
+static void typeWriteDefer(TypeResolver* res, Symbol* symbol, ExprType type)
+{
+    // Hodnotu před první vlastní změnou mohla změnit dřívější funkce, zapíše se vždy
+    for (long i = res->writeCount - 1; i >= 0; i--)
+    {
+        if (res->writes[i].symbol != symbol) continue;
+        if (res->writes[i].type == type) return;
+        break;
+    }
+
+    if (res->writeCount == res->writeCapacity)
+    {
+        res->writeCapacity = res->writeCapacity ? res->writeCapacity * 2 : 8;
+        res->writes = realloc(res->writes, sizeof(TypeWrite) * res->writeCapacity);
+        if (!res->writes)
+            errorExit(INTERNAL_ERROR, "Failed to allocate type resolver", 0, NULL);
+    }
+    res->writes[res->writeCount++] = (TypeWrite){symbol, type};
+}
+
+/**
+ * @brief Set type of symbol, writes of global symbols may be deferred
+ */
+static void typeResolverSet(TypeResolver* res, Symbol* symbol, ExprType type)
+{
+    if (res->deferGlobals && typeSymbolGlobal(res->stack, symbol))
+    {
+        typeWriteDefer(res, symbol, type);
+        return;
+    }
+
+    symbol->expressionType = type;
 }
 
 /**
- * @brief Recursively traverses the AST to resolve types that were unknown during parsing.
- * Handles Assignments, Expressions, and Function Calls.
+ * @brief Logic to resolve types of a single resolveLater item.
+ * Handles Assignments, Expressions, Function Calls and Returns.
  */
-void resolveRecursive(AstNode* node, SymTableStack* stack)
+static void resolveRecursive(TypeResolver* res, AstNode* node)
 {
     if (!node) return;
 
@@ -461,30 +628,35 @@ void resolveRecursive(AstNode* node, SymTableStack* stack)
     {
         case AST_FUN_CALL:
         {
-            checkFunctionCallNode(node, stack);
+            if (res->report)
+                checkFunctionCallNode(node, res->stack);
+            else if (node->symbol)
+                node->expressionType = node->symbol->expressionType;
             break;
         }
 
         case AST_VAR_ASSIGN:
         {
             AstBin* children = (AstBin*)node->children;
-            resolveRecursive(children->right, stack);
+            resolveRecursive(res, children->right);
+            ExprType type = children->right->expressionType;
 
             if (children->left->expressionType == TYPE_UNKNOWN)
             {
-                children->left->expressionType = children->right->expressionType;
+                children->left->expressionType = type;
 
                 if (children->left->type == AST_IDENTIFIER)
                 {
-                    Symbol* s =
-                        symTableStackFindSymbol(stack, children->left->token.value->stringVal);
+                    Symbol* s = children->left->symbol;
                     if (s)
-                        s->expressionType = children->right->expressionType;
+                        typeResolverSet(res, s, type);
                     else
                     {
-                        Symbol* newSym = symbolCreate(children->left->token.value->stringVal,
-                                                      children->right->expressionType, SYM_VAR, 0);
-                        scopeAddSymbol(stack->scopes[stack->top], newSym);
+                        Symbol* newSym =
+                            symbolCreate(&res->stack->arena, children->left->token.value->stringVal,
+                                         type, SYM_VAR, 0);
+                        scopeAddSymbol(res->stack->scopes[res->stack->top], newSym);
+                        children->left->symbol = newSym;
                     }
                 }
             }
@@ -496,16 +668,45 @@ void resolveRecursive(AstNode* node, SymTableStack* stack)
 
         case AST_EXPRESSION:
         {
-            AstBin* children = (AstBin*)node->children;
-            resolveRecursive(children->left, stack);
-            resolveRecursive(children->right, stack);
+            // Levá větev řetězce operátorů se prochází cyklem zdola nahoru
+            NodeVec spine;
+            nodeVecInit(&spine);
+            astLeftSpine(node, &spine);
+            resolveRecursive(res, ((AstBin*)spine.items[spine.count - 1]->children)->left);
+
+            for (long i = spine.count - 1; i >= 0; i--)
+            {
+                AstNode* op = spine.items[i];
+                AstBin* children = (AstBin*)op->children;
+                resolveRecursive(res, children->right);
+
+                if (res->report && !checkBinaryTypes(children->left, op, children->right))
+                {
+                    errorExit(SEM_TYPE, "Type mismatch in expression (resolved later)",
+                              tokenLine(&op->token), &op->token);
+                }
+                op->expressionType = getBinaryResultType(children->left, op, children->right);
+            }
+            nodeVecDispose(&spine);
+            break;
+        }
 
-            if (!checkBinaryTypes(children->left, node, children->right))
+        case AST_RETURN:
+        {
+            // Výraz byl zkontrolován už při parsování, zde se jen dopočítá typ funkce
+            bool report = res->report;
+            res->report = false;
+            resolveRecursive(res, ((AstBin*)node->children)->right);
+            res->report = report;
+
+            TypeSymbol* entry = typeSymbolFind(res, node->symbol);
+            ExprType type = entry->base;
+            for (long e = entry->returns; e >= 0; e = res->edgeNext[e])
             {
-                errorExit(SEM_TYPE, "Type mismatch in expression (resolved later)",
-                          node->token.line, &node->token);
+                AstNode* ret = res->items->items[res->edgeItem[e]];
+                type |= ((AstBin*)ret->children)->right->expressionType;
             }
-            node->expressionType = getBinaryResultType(children->left, node, children->right);
+            typeResolverSet(res, node->symbol, type);
             break;
         }
 
@@ -513,8 +714,8 @@ void resolveRecursive(AstNode* node, SymTableStack* stack)
             return;
 
         case AST_IDENTIFIER:
-            Symbol* symbol = symTableStackFindSymbol(stack, node->token.value->stringVal);
-            if (symbol) node->expressionType = symbol->expressionType;
+            // Identifikátor byl navázán na deklaraci už při parsování
+            if (node->symbol) node->expressionType = node->symbol->expressionType;
             break;
         case AST_IFJ:
             node->expressionType = ((AstBin*)node->children)->right->expressionType;
@@ -525,21 +726,417 @@ void resolveRecursive(AstNode* node, SymTableStack* stack)
     }
 }
 
+static void typeSymbolsInit(TypeResolver* res)
+{
+    res->symbolCapacity = 64;
+    res->symbolCount = 0;
+    res->symbols = typeAlloc(sizeof(TypeSymbol) * res->symbolCapacity);
+    for (long i = 0; i < res->symbolCapacity; i++) res->symbols[i].symbol = NULL;
+}
+
+static void typeResolverInit(TypeResolver* res, NodeVec* items, SymTableStack* stack)
+{
+    long count = items->count;
+    res->stack = stack;
+    res->items = items;
+    typeSymbolsInit(res);
+    res->edgeCapacity = count * 2;
+    res->edgeCount = 0;
+    res->edgeItem = typeAlloc(sizeof(long) * res->edgeCapacity);
+    res->edgeNext = typeAlloc(sizeof(long) * res->edgeCapacity);
+    res->deferGlobals = false;
+    res->writes = NULL;
+    res->writeCount = 0;
+    res->writeCapacity = 0;
+
+    // Typ funkce je sjednocením typů všech jejích returnů
+    for (long i = 0; i < count; i++)
+    {
+        AstNode* item = items->items[i];
+        if (item->type == AST_RETURN && item->symbol)
+        {
+            TypeSymbol* entry = typeSymbolGet(res, item->symbol);
+            typeEdgeAdd(res, &entry->returns, i);
+        }
+    }
+}
+
+static void typeResolverDispose(TypeResolver* res)
+{
+    free(res->symbols);
+    free(res->edgeItem);
+    free(res->edgeNext);
+    free(res->writes);
+}
+
+/**
+ * @brief Visit of item, checks it and sets first types of symbols it assigns
+ */
+static void typeResolverVisit(TypeResolver* res, long item)
+{
+    res->report = true;
+    resolveRecursive(res, res->items->items[item]);
+}
+
 /**
  * @brief Iterates through checkLaterList and resolves all unknown types
  *
  * @param checkLaterList - list to be resolved
  * @param stack - symtable stack used for resolving symbol types
  */
-void semanticResolveCheckLater(SLList* checkLaterList, SymTableStack* stack)
+void semanticResolveCheckLater(NodeVec* checkLaterList, SymTableStack* stack)
 {
-    if (!checkLaterList) return;
+    if (!checkLaterList || checkLaterList->count == 0) return;
+
+    TypeResolver res;
+    typeResolverInit(&res, checkLaterList, stack);
 
-    ListItem* resolve = checkLaterList->firstItem;
+    for (long i = 0; i < checkLaterList->count; i++) typeResolverVisit(&res, i);
 
-    while (resolve)
+    typeResolverDispose(&res);
+}
+
+/* --------------------------------------------------------- */
+/* PARALLEL VISITS                                           */
+/* --------------------------------------------------------- */
+
+#define SEMANTIC_PARALLEL_MIN_ITEMS 1024  // shorter lists are resolved serially
+
+static long semanticParallelMin = SEMANTIC_PARALLEL_MIN_ITEMS;
+
+void semanticSetParallelMin(long items)
+{
+    semanticParallelMin = items >= 0 ? items : SEMANTIC_PARALLEL_MIN_ITEMS;
+}
+
+/**
+ * @brief resolveLater items of one function
+ */
+typedef struct
+{
+    long first;     // index of the first item in checkLaterList
+    long count;     // items of function are contiguous in checkLaterList
+    bool parallel;  // visits do not depend on other functions and run in a task
+    NodeVec items;  // item pointers for own resolver, indices are local to function
+    TypeResolver resolver;
+    ErrorTrap trap;
+    bool failed;           // trap holds the first error of function
+    const SourceMap* map;  // source map of compiled file for diagnostics of task
+} SemanticFunction;
+
+/**
+ * @brief Item with its index in checkLaterList, sorted by node address
+ */
+typedef struct
+{
+    AstNode* node;
+    long index;
+} SemanticItem;
+
+static int semanticCompareItem(const void* a, const void* b)
+{
+    uintptr_t left = (uintptr_t)((const SemanticItem*)a)->node;
+    uintptr_t right = (uintptr_t)((const SemanticItem*)b)->node;
+    return (left > right) - (left < right);
+}
+
+/**
+ * @brief Marks items found in subtree of function as owned by it
+ */
+static void semanticAssignItems(SemanticItem* sorted, long count, long* owner, long fun,
+                                AstNode* node)
+{
+    // Na pořadí nezáleží, levý potomek se prochází cyklem kvůli dlouhým řetězcům operátorů
+    while (node)
     {
-        resolveRecursive(resolve->item, stack);
-        resolve = resolve->next;
+        SemanticItem key = {node, 0};
+        SemanticItem* found =
+            bsearch(&key, sorted, count, sizeof(SemanticItem), semanticCompareItem);
+        if (found && owner[found->index] < 0) owner[found->index] = fun;
+
+        switch (node->type)
+        {
+            case AST_LITERAL:
+            case AST_TYPE:
+            case AST_IDENTIFIER:
+            case AST_VAR_DEC:
+                return;
+
+            case AST_CLASS_DEC:
+            case AST_BLOCK:
+            case AST_PARAMS:
+            {
+                NodeVec* nodes = &((AstN*)node->children)->nodes;
+                for (long i = 0; i < nodes->count; i++)
+                    semanticAssignItems(sorted, count, owner, fun, nodes->items[i]);
+                return;
+            }
+
+            default:
+            {
+                AstBin* children = node->children;
+                if (!children) return;
+                semanticAssignItems(sorted, count, owner, fun, children->right);
+                node = children->left;
+                break;
+            }
+        }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Symbol whose type visit of call reads, same lookup as checkFunctionCallNode
+ */
+static Symbol* semanticCallTarget(SymTableStack* stack, AstNode* node)
+{
+    if (node->symbol) return node->symbol;
+
+    AstNode* paramsNode = ((AstBin*)node->children)->right;
+    int argc = 0;
+    if (paramsNode && paramsNode->type == AST_PARAMS)
+        argc = ((AstN*)paramsNode->children)->nodes.count;
+
+    Symbol* exact = findFunctionExact(stack, node->token.value->stringVal, argc);
+    return exact ? exact : findGetter(stack, node->token.value->stringVal);
+}
+
+/**
+ * @brief Walks item the same way as its visit in resolveRecursive
+ *
+ * With record set, global symbols the item writes are added to written. Otherwise it looks for
+ * reads of global symbols contained in written.
+ *
+ * @return true when item must be visited serially
+ */
+static bool semanticGlobalsWalk(SymTableStack* stack, AstNode* node, TypeResolver* written,
+                                bool record)
+{
+    if (!node) return false;
+
+    switch (node->type)
+    {
+        case AST_FUN_CALL:
+        {
+            Symbol* target = record ? NULL : semanticCallTarget(stack, node);
+            return target && typeSymbolFind(written, target)->symbol;
+        }
+
+        case AST_VAR_ASSIGN:
+        {
+            AstBin* children = (AstBin*)node->children;
+            Symbol* target = children->left->symbol;
+
+            // Přiřazení bez symbolu zakládá nový symbol ve sdílené tabulce
+            if (!target) return true;
+            if (record && typeSymbolGlobal(stack, target)) typeSymbolGet(written, target);
+            return semanticGlobalsWalk(stack, children->right, written, record);
+        }
+
+        case AST_EXPRESSION:
+        {
+            // Výsledek nezávisí na pořadí, levá větev řetězce operátorů se prochází cyklem
+            AstNode* operand = node;
+            while (operand && operand->type == AST_EXPRESSION)
+            {
+                AstBin* children = (AstBin*)operand->children;
+                if (semanticGlobalsWalk(stack, children->right, written, record)) return true;
+                operand = children->left;
+            }
+            return semanticGlobalsWalk(stack, operand, written, record);
+        }
+
+        case AST_RETURN:
+            if (record && node->symbol) typeSymbolGet(written, node->symbol);
+            return semanticGlobalsWalk(stack, ((AstBin*)node->children)->right, written, record);
+
+        case AST_IDENTIFIER:
+            return !record && node->symbol && typeSymbolFind(written, node->symbol)->symbol;
+
+        default:
+            return false;
+    }
+}
+
+static void semanticFunctionTask(void* arg)
+{
+    SemanticFunction* fun = arg;
+
+    sourceMapSetCurrent(fun->map);
+    errorTrapSet(&fun->trap);
+    if (setjmp(fun->trap.jump) == 0)
+    {
+        for (long i = 0; i < fun->items.count; i++) typeResolverVisit(&fun->resolver, i);
+    }
+    else
+    {
+        fun->failed = true;
+    }
+    errorTrapSet(NULL);
+}
+
+/**
+ * @brief Takes over results of function checked in parallel as if it was visited serially
+ */
+static void semanticMergeFunction(TypeResolver* res, SemanticFunction* fun)
+{
+    // Chyba první takové funkce je i první chybou sériového průchodu
+    if (fun->failed) errorExit(fun->trap.code, fun->trap.msg, fun->trap.line, fun->trap.token);
+
+    for (long i = 0; i < fun->resolver.writeCount; i++)
+    {
+        typeResolverSet(res, fun->resolver.writes[i].symbol, fun->resolver.writes[i].type);
+    }
+}
+
+/**
+ * @brief Splits checkLaterList by functions of program
+ *
+ * @return SemanticFunction* array of functions in source order, NULL when some item does not
+ * belong to exactly one contiguous range
+ */
+static SemanticFunction* semanticSplitFunctions(NodeVec* list, AstNode* root, long* functionCount)
+{
+    long count = list->count;
+    NodeVec* members = &((AstN*)root->children)->nodes;
+
+    SemanticItem* sorted = typeAlloc(sizeof(SemanticItem) * count);
+    long* owner = typeAlloc(sizeof(long) * count);
+    for (long i = 0; i < count; i++)
+    {
+        sorted[i] = (SemanticItem){list->items[i], i};
+        owner[i] = -1;
+    }
+    qsort(sorted, count, sizeof(SemanticItem), semanticCompareItem);
+
+    for (long f = 0; f < members->count; f++)
+        semanticAssignItems(sorted, count, owner, f, members->items[f]);
+
+    // Položky funkcí jdou v seznamu za sebou, protože se funkce parsují postupně
+    bool contiguous = owner[0] >= 0;
+    for (long i = 1; i < count && contiguous; i++)
+        contiguous = owner[i] >= owner[i - 1];
+
+    SemanticFunction* functions = NULL;
+    if (contiguous)
+    {
+        functions = typeAlloc(sizeof(SemanticFunction) * members->count);
+        *functionCount = 0;
+        for (long i = 0; i < count; i++)
+        {
+            if (i == 0 || owner[i] != owner[i - 1])
+            {
+                SemanticFunction* fun = &functions[(*functionCount)++];
+                memset(fun, 0, sizeof(SemanticFunction));
+                fun->first = i;
+            }
+            functions[*functionCount - 1].count++;
+        }
+    }
+
+    free(sorted);
+    free(owner);
+    return functions;
+}
+
+/**
+ * @brief Same result as semanticResolveCheckLater, visits of functions run in parallel
+ *
+ * Function whose items read no global symbol (function type, getter or global variable) that
+ * an earlier function or the function itself writes sees exactly the state the serial sweep
+ * would show it, so it is visited by a worker thread. Its writes of global symbols and its
+ * errors are held back. Afterwards functions are merged in source order, the others are
+ * visited serially at their place and the first error in source order is reported, so the
+ * exit code never differs from the serial run.
+ *
+ * @param checkLaterList - list to be resolved
+ * @param stack - symtable stack used for resolving symbol types
+ * @param root - AST_CLASS_DEC root of program
+ */
+void semanticResolveCheckLaterParallel(NodeVec* checkLaterList, SymTableStack* stack,
+                                       AstNode* root)
+{
+    if (!checkLaterList || checkLaterList->count == 0) return;
+
+    int threads = threadPoolDefaultSize();
+    long functionCount = 0;
+    SemanticFunction* functions = NULL;
+    if (threads > 1 && checkLaterList->count >= semanticParallelMin && root &&
+        root->type == AST_CLASS_DEC)
+    {
+        functions = semanticSplitFunctions(checkLaterList, root, &functionCount);
+    }
+    if (!functions)
+    {
+        semanticResolveCheckLater(checkLaterList, stack);
+        return;
+    }
+
+    // Globální symboly zapsané funkcemi až po aktuální včetně
+    TypeResolver written;
+    typeSymbolsInit(&written);
+    long parallelCount = 0;
+    for (long f = 0; f < functionCount; f++)
+    {
+        SemanticFunction* fun = &functions[f];
+        bool serial = false;
+        for (long i = 0; i < fun->count; i++)
+        {
+            AstNode* item = checkLaterList->items[fun->first + i];
+            serial = semanticGlobalsWalk(stack, item, &written, true) || serial;
+        }
+        for (long i = 0; i < fun->count && !serial; i++)
+        {
+            AstNode* item = checkLaterList->items[fun->first + i];
+            serial = semanticGlobalsWalk(stack, item, &written, false);
+        }
+        fun->parallel = !serial;
+        if (fun->parallel) parallelCount++;
+    }
+    free(written.symbols);
+
+    TypeResolver res;
+    typeResolverInit(&res, checkLaterList, stack);
+
+    if (parallelCount > 1)
+    {
+        ThreadPool* pool = threadPoolCreate(threads);
+        for (long f = 0; f < functionCount; f++)
+        {
+            SemanticFunction* fun = &functions[f];
+            if (!fun->parallel) continue;
+
+            nodeVecInit(&fun->items);
+            for (long i = 0; i < fun->count; i++)
+                nodeVecPush(&fun->items, checkLaterList->items[fun->first + i]);
+            typeResolverInit(&fun->resolver, &fun->items, stack);
+            fun->resolver.deferGlobals = true;
+            fun->map = sourceMapCurrent();
+            threadPoolSubmit(pool, semanticFunctionTask, fun);
+            STATS_COUNT(STAT_SEM_TASKS, 1);
+        }
+        threadPoolWait(pool);
+        threadPoolDestroy(pool);
+    }
+    else
+    {
+        for (long f = 0; f < functionCount; f++) functions[f].parallel = false;
+    }
+
+    for (long f = 0; f < functionCount; f++)
+    {
+        SemanticFunction* fun = &functions[f];
+        if (fun->parallel)
+        {
+            semanticMergeFunction(&res, fun);
+            typeResolverDispose(&fun->resolver);
+            nodeVecDispose(&fun->items);
+        }
+        else
+        {
+            for (long i = 0; i < fun->count; i++) typeResolverVisit(&res, fun->first + i);
+        }
+    }
+
+    typeResolverDispose(&res);
+    free(functions);
+}
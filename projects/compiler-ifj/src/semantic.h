@@ -28,6 +28,9 @@ typedef enum
 } operationType;
 void semanticExpression(AstNode* node);
 void semanticAssignment(AstNode* node);
-void semanticResolveCheckLater(SLList* checkLaterList, SymTableStack* stack);
+void semanticResolveCheckLater(NodeVec* checkLaterList, SymTableStack* stack);
+void semanticResolveCheckLaterParallel(NodeVec* checkLaterList, SymTableStack* stack,
+                                       AstNode* root);
+void semanticSetParallelMin(long items);  // --semantic-parallel-min=N, < 0 restores default
 bool checkFunDec(Scope* globalScope);
 #endif  // SEMANTIC_H
\ No newline at end of file
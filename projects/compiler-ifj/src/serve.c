@@ -0,0 +1,348 @@
+/**
+ * @file serve.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Compiler daemon serving compile requests over a unix socket
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "serve.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "driver.h"
+#include "error.h"
+#include "scankernel.h"
+#include "utils.h"
+
+#define SERVE_BACKLOG 64
+#define SERVE_COPY_BUFFER 65536
+
+static volatile sig_atomic_t serveStopping = 0;
+
+static void serveStop(int signal)
+{
+    (void)signal;
+    serveStopping = 1;
+}
+
+static bool serveReadAll(int fd, void* data, size_t length)
+{
+    char* pos = data;
+    while (length > 0)
+    {
+        ssize_t got = read(fd, pos, length);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        pos += got;
+        length -= (size_t)got;
+    }
+    return true;
+}
+
+static bool serveWriteAll(int fd, const void* data, size_t length)
+{
+    const char* pos = data;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, pos, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        pos += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+static uint32_t serveDecode(const unsigned char* bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 |
+           (uint32_t)bytes[3];
+}
+
+static void serveEncode(unsigned char* bytes, uint32_t value)
+{
+    bytes[0] = (unsigned char)(value >> 24);
+    bytes[1] = (unsigned char)(value >> 16);
+    bytes[2] = (unsigned char)(value >> 8);
+    bytes[3] = (unsigned char)value;
+}
+
+/**
+ * @brief Copies count bytes between descriptors
+ */
+static bool serveCopy(int from, int to, uint32_t count)
+{
+    char buffer[SERVE_COPY_BUFFER];
+    while (count > 0)
+    {
+        size_t chunk = count < sizeof(buffer) ? count : sizeof(buffer);
+        if (!serveReadAll(from, buffer, chunk) || !serveWriteAll(to, buffer, chunk))
+        {
+            return false;
+        }
+        count -= (uint32_t)chunk;
+    }
+    return true;
+}
+
+/**
+ * @brief Length of temporary file, its offset is moved back to start
+ */
+static uint32_t serveRewind(int fd)
+{
+    off_t length = lseek(fd, 0, SEEK_END);
+    lseek(fd, 0, SEEK_SET);
+    return length < 0 ? 0 : (uint32_t)length;
+}
+
+/**
+ * @brief Sends response without output, used when request was not compiled
+ */
+static void serveAnswer(int conn, int code)
+{
+    unsigned char header[SERVE_RESPONSE_HEADER];
+    serveEncode(header, (uint32_t)code);
+    serveEncode(header + 4, 0);
+    serveEncode(header + 8, 0);
+    serveWriteAll(conn, header, SERVE_RESPONSE_HEADER);
+}
+
+/**
+ * @brief Handles one connection in process forked for it, errors are caught like in batch
+ *
+ * @return int 0 when response was sent (or client is gone), otherwise exit code of request
+ * which the daemon sends instead
+ */
+static int serveConnection(int conn, SymTableStack* symStack)
+{
+    FILE* source = tmpfile();
+    FILE* out = tmpfile();
+    FILE* err = tmpfile();
+    unsigned char header[SERVE_RESPONSE_HEADER];
+    if (!source || !out || !err)
+    {
+        return INTERNAL_ERROR;
+    }
+
+    // Zdroj ide do súboru, kompilátor ho tak číta rovnako ako zo stdin
+    if (!serveReadAll(conn, header, SERVE_REQUEST_HEADER) ||
+        !serveCopy(conn, fileno(source), serveDecode(header)))
+    {
+        return 0;
+    }
+    serveRewind(fileno(source));
+
+    ErrorTrap trap;
+    memset(&trap, 0, sizeof(trap));
+    trap.log = err;
+    CompileState state;
+    int code;
+
+    emitSetOutput(out);
+    errorTrapSet(&trap);
+    if (setjmp(trap.jump) == 0)
+    {
+        compileRun(&state, source, symStack, NULL);
+        code = 0;
+    }
+    else
+    {
+        // Proces po odpovedi končí, zdroj a AST v state uvoľní systém
+        code = trap.code;
+    }
+    errorTrapSet(NULL);
+    emitSetOutput(NULL);
+    if (fflush(out) != 0 || fflush(err) != 0)
+    {
+        return INTERNAL_ERROR;
+    }
+
+    uint32_t outLength = serveRewind(fileno(out));
+    uint32_t errLength = serveRewind(fileno(err));
+    serveEncode(header, (uint32_t)code);
+    serveEncode(header + 4, outLength);
+    serveEncode(header + 8, errLength);
+    if (serveWriteAll(conn, header, SERVE_RESPONSE_HEADER))
+    {
+        if (serveCopy(fileno(out), conn, outLength)) serveCopy(fileno(err), conn, errLength);
+    }
+    return 0;
+}
+
+/**
+ * @brief Connection whose process has not been reaped yet, the daemon keeps it open
+ */
+typedef struct
+{
+    pid_t pid;
+    int conn;
+} ServeRequest;
+
+typedef struct
+{
+    ServeRequest* items;
+    long count;
+    long capacity;
+} ServeRequests;
+
+static void serveRequestsAdd(ServeRequests* requests, pid_t pid, int conn)
+{
+    if (requests->count == requests->capacity)
+    {
+        requests->capacity = requests->capacity ? requests->capacity * 2 : 16;
+        requests->items = realloc(requests->items, sizeof(ServeRequest) * requests->capacity);
+        if (!requests->items)
+        {
+            errorExit(INTERNAL_ERROR, "Failed to allocate daemon requests", 0, NULL);
+        }
+    }
+    requests->items[requests->count++] = (ServeRequest){pid, conn};
+}
+
+/**
+ * @brief Reaps finished request processes and closes their connections
+ *
+ * Process that did not answer (killed by signal, or failed before compiling) is answered by
+ * the daemon, a crash is reported as exit code 128 + signal like in shell.
+ */
+static void serveReap(ServeRequests* requests)
+{
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        for (long i = 0; i < requests->count; i++)
+        {
+            if (requests->items[i].pid != pid) continue;
+
+            int conn = requests->items[i].conn;
+            if (WIFSIGNALED(status))
+                serveAnswer(conn, 128 + WTERMSIG(status));
+            else if (WEXITSTATUS(status) != 0)
+                serveAnswer(conn, WEXITSTATUS(status));
+            close(conn);
+            requests->items[i] = requests->items[--requests->count];
+            break;
+        }
+    }
+}
+
+static void serveChildExited(int signal)
+{
+    (void)signal;  // Len preruší pselect, procesy uprace serveReap
+}
+
+int serveRun(const char* socketPath)
+{
+    // Všetko, čo nezávisí od zdroja, sa pripraví raz a procesy požiadaviek to zdedia
+    scanKernelsGet();
+    SymTableStack* symStack = compileSymStackCreate();
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        errorExit(INTERNAL_ERROR, "Socket path too long", 0, NULL);
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || listener >= FD_SETSIZE)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to create socket", 0, NULL);
+    }
+    unlink(socketPath);  // Socket po predchádzajúcom behu
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(listener, SERVE_BACKLOG) < 0)
+    {
+        close(listener);
+        errorExit(INTERNAL_ERROR, "Failed to listen on socket", 0, NULL);
+    }
+
+    // Signály sa doručujú len vnútri pselect, koniec procesu tak neprekĺzne pred čakaním
+    sigset_t handled;
+    sigset_t waitMask;
+    sigemptyset(&handled);
+    sigaddset(&handled, SIGINT);
+    sigaddset(&handled, SIGTERM);
+    sigaddset(&handled, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &handled, &waitMask);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_handler = serveStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    action.sa_handler = serveChildExited;
+    sigaction(SIGCHLD, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);  // Klient môže odísť skôr, než dostane odpoveď
+
+    ServeRequests requests = {0};
+    while (!serveStopping)
+    {
+        serveReap(&requests);
+
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(listener, &ready);
+        if (pselect(listener + 1, &ready, NULL, NULL, NULL, &waitMask) < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        int conn = accept(listener, NULL, NULL);
+        if (conn < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(listener);
+            for (long i = 0; i < requests.count; i++) close(requests.items[i].conn);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            signal(SIGCHLD, SIG_DFL);
+            sigprocmask(SIG_SETMASK, &waitMask, NULL);
+            _exit(serveConnection(conn, symStack));
+        }
+        if (pid < 0)
+        {
+            serveAnswer(conn, INTERNAL_ERROR);
+            close(conn);
+            continue;
+        }
+        serveRequestsAdd(&requests, pid, conn);
+    }
+
+    // Procesy požiadaviek, ktoré ešte bežia, odpovedia klientom samy
+    for (long i = 0; i < requests.count; i++) close(requests.items[i].conn);
+    free(requests.items);
+    close(listener);
+    unlink(socketPath);
+    freeSymTableStack(symStack);
+    return serveStopping ? 0 : INTERNAL_ERROR;
+}
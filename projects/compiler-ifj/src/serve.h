@@ -0,0 +1,37 @@
+/**
+ * @file serve.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Compiler daemon serving compile requests over a unix socket
+ * @version 0.1
+ * @date 2025-12-02
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Protocol (one request per connection, numbers are 32-bit big-endian):
+ *   request:  source length, source bytes
+ *   response: exit code, stdout length, stderr length, stdout bytes, stderr bytes
+ */
+
+#ifndef SERVE_H
+#define SERVE_H
+
+#define SERVE_SOCKET_ENV "IFJ_COMPILER_SOCKET"  // socket of daemon used by compiler-client
+#define SERVE_REQUEST_HEADER 4                  // source length
+#define SERVE_RESPONSE_HEADER 12                // exit code, stdout length, stderr length
+
+/**
+ * @brief Runs compiler daemon listening on socketPath until SIGINT or SIGTERM
+ *
+ * Symbol table with builtins is prepared once, every request is compiled in one process forked
+ * from the warm daemon, so requests run concurrently and a crash of one cannot affect the
+ * others. Errors of compilation are caught in that process by ErrorTrap. Output, error
+ * messages and exit code are the same as from `./compiler < source`. When the process is
+ * killed by a signal, or fork fails, the daemon answers itself with exit code 128 + signal,
+ * or INTERNAL_ERROR.
+ *
+ * @param socketPath path of unix socket, existing file is replaced
+ * @return int exit code of daemon
+ */
+int serveRun(const char* socketPath);
+
+#endif  // SERVE_H
@@ -0,0 +1,88 @@
+/**
+ * @file sourcemap.c
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Table of line starts for translating byte offsets to line and column
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "sourcemap.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+// Každé vlákno kompiluje svůj soubor (--batch), úlohy vláken jednoho souboru si mapu předají
+static pthread_key_t currentMapKey;
+static pthread_once_t currentMapKeyOnce = PTHREAD_ONCE_INIT;
+
+static void currentMapKeyCreate(void)
+{
+    pthread_key_create(&currentMapKey, NULL);
+}
+
+void sourceMapBuild(SourceMap *map, const char *buffer, size_t length,
+                    const ScanKernels *kernels)
+{
+    const char *end = buffer + length;
+
+    // Nejdřív spočítáme řádky, tabulka se pak alokuje jen jednou
+    map->lineCount = kernels->countNewlines(buffer, end) + 1;
+    map->lineStarts = malloc(sizeof(uint32_t) * map->lineCount);
+    if (!map->lineStarts)
+    {
+        errorExit(INTERNAL_ERROR, "Failed to allocate line table", 0, NULL);
+    }
+
+    size_t line = 0;
+    map->lineStarts[line++] = 0;
+
+    const char *pos = buffer;
+    while ((pos = kernels->findLineEnd(pos, end)) < end)
+    {
+        pos++;
+        map->lineStarts[line++] = (uint32_t)(pos - buffer);
+    }
+}
+
+SourceLocation sourceMapLocate(const SourceMap *map, uint32_t offset)
+{
+    // Poslední řádek, který začíná na offset nebo před ním
+    size_t low = 0;
+    size_t high = map->lineCount;
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (map->lineStarts[middle] <= offset)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    SourceLocation location = {(int)low + 1, (int)(offset - map->lineStarts[low]) + 1};
+    return location;
+}
+
+void sourceMapDispose(SourceMap *map)
+{
+    if (sourceMapCurrent() == map)
+    {
+        sourceMapSetCurrent(NULL);
+    }
+    free(map->lineStarts);
+    map->lineStarts = NULL;
+    map->lineCount = 0;
+}
+
+void sourceMapSetCurrent(const SourceMap *map)
+{
+    pthread_once(&currentMapKeyOnce, currentMapKeyCreate);
+    pthread_setspecific(currentMapKey, map);
+}
+
+const SourceMap *sourceMapCurrent(void)
+{
+    pthread_once(&currentMapKeyOnce, currentMapKeyCreate);
+    return pthread_getspecific(currentMapKey);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file sourcemap.h
+ * @author Samuel Vajda (xvajdas00)
+ * @brief Table of line starts for translating byte offsets to line and column
+ *
+ * Tokens carry only 32-bit byte offset, line and column are looked up here when a
+ * diagnostic needs them.
+ */
+
+#ifndef SOURCEMAP_H
+#define SOURCEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scankernel.h"
+
+#define SOURCE_MAX_SIZE UINT32_MAX  // offsets are 32-bit
+
+/**
+ * @brief Offsets of line starts of one source file
+ */
+typedef struct
+{
+    uint32_t *lineStarts;  // lineStarts[i] = offset of the first byte of line i + 1
+    size_t lineCount;
+} SourceMap;
+
+typedef struct
+{
+    int line;    // from 1
+    int column;  // from 1, in bytes
+} SourceLocation;
+
+/**
+ * @brief Build line table of buffer, newlines are counted and found by scan kernels
+ *
+ * @param map map to fill
+ * @param buffer source text
+ * @param length length of source (at most SOURCE_MAX_SIZE)
+ * @param kernels kernels used to find newlines
+ */
+void sourceMapBuild(SourceMap *map, const char *buffer, size_t length,
+                    const ScanKernels *kernels);
+
+/**
+ * @brief Line and column of byte offset (binary search in line table)
+ *
+ * @param map built map
+ * @param offset byte offset in source
+ * @return SourceLocation
+ */
+SourceLocation sourceMapLocate(const SourceMap *map, uint32_t offset);
+
+/**
+ * @brief Free line table
+ *
+ * @param map map to dispose
+ */
+void sourceMapDispose(SourceMap *map);
+
+/**
+ * @brief Set map of the file being compiled by calling thread, used by tokenLine and
+ * diagnostics. Tasks working on the file in other threads have to set it as well.
+ *
+ * @param map map or NULL
+ */
+void sourceMapSetCurrent(const SourceMap *map);
+
+/**
+ * @brief Map of the file being compiled by calling thread
+ *
+ * @return const SourceMap* NULL when no file is open
+ */
+const SourceMap *sourceMapCurrent(void);
+
+#endif  // SOURCEMAP_H
@@ -0,0 +1,168 @@
+/**
+ * @file stats.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Per-phase timers, counters and memory statistics of compilation
+ * @version 0.1
+ * @date 2025-12-04
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+bool statsActive = false;
+
+static bool statsTimePasses = false;
+static bool statsMemory = false;
+static bool statsJson = false;
+static uint64_t statsStart = 0;  // time of statsEnable, total of report
+static pid_t statsOwner = 0;     // process that reports, forked children inherit atexit handler
+static uint64_t statsPhases[PHASE_COUNT];
+static uint64_t statsCounters[STAT_COUNT];
+
+static const char *const PHASE_NAMES[PHASE_COUNT] = {
+    "read", "prologue", "parse", "semantic", "funDec", "bind", "infer", "generate",
+};
+
+static const char *const COUNTER_NAMES[STAT_COUNT] = {
+    "tokens", "astNodes", "symbols", "instructions", "labels",
+    "temps", "arenaAllocs", "arenaBlocks", "arenaBytes", "semTasks", "genTasks",
+};
+
+static uint64_t statsNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static long statsPeakRssKiB(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return usage.ru_maxrss;  // Linux udává v KiB
+}
+
+static uint64_t statsLoad(const uint64_t *value)
+{
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static void statsReportJson(double totalMs)
+{
+    fprintf(stderr, "{\"totalMs\":%.3f", totalMs);
+    if (statsTimePasses)
+    {
+        fprintf(stderr, ",\"phasesMs\":{");
+        for (int i = 0; i < PHASE_COUNT; i++)
+        {
+            fprintf(stderr, "%s\"%s\":%.3f", i ? "," : "", PHASE_NAMES[i],
+                    statsLoad(&statsPhases[i]) / 1e6);
+        }
+        fprintf(stderr, "}");
+    }
+    fprintf(stderr, ",\"counters\":{");
+    for (int i = 0; i < STAT_COUNT; i++)
+    {
+        fprintf(stderr, "%s\"%s\":%llu", i ? "," : "", COUNTER_NAMES[i],
+                (unsigned long long)statsLoad(&statsCounters[i]));
+    }
+    fprintf(stderr, "}");
+    if (statsMemory)
+    {
+        fprintf(stderr, ",\"memory\":{\"peakRssKiB\":%ld}", statsPeakRssKiB());
+    }
+    fprintf(stderr, "}\n");
+}
+
+static void statsReportText(double totalMs)
+{
+    fprintf(stderr, "=== Compiler statistics ===\n");
+    if (statsTimePasses)
+    {
+        fprintf(stderr, "%-14s %12s %7s\n", "phase", "time [ms]", "share");
+        for (int i = 0; i < PHASE_COUNT; i++)
+        {
+            double ms = statsLoad(&statsPhases[i]) / 1e6;
+            fprintf(stderr, "%-14s %12.3f %6.1f%%\n", PHASE_NAMES[i], ms,
+                    totalMs > 0 ? 100.0 * ms / totalMs : 0.0);
+        }
+        fprintf(stderr, "%-14s %12.3f\n", "total", totalMs);
+    }
+    fprintf(stderr, "%-14s %12s\n", "counter", "value");
+    for (int i = 0; i < STAT_COUNT; i++)
+    {
+        fprintf(stderr, "%-14s %12llu\n", COUNTER_NAMES[i],
+                (unsigned long long)statsLoad(&statsCounters[i]));
+    }
+    if (statsMemory)
+    {
+        fprintf(stderr, "%-14s %12ld\n", "peakRssKiB", statsPeakRssKiB());
+    }
+}
+
+/**
+ * @brief Report at process exit, runs after return from main and after errorExit
+ */
+static void statsReport(void)
+{
+    if (getpid() != statsOwner) return;
+
+    double totalMs = (statsNow() - statsStart) / 1e6;
+    if (statsJson)
+        statsReportJson(totalMs);
+    else
+        statsReportText(totalMs);
+}
+
+void statsEnable(bool timePasses, bool memStats, bool json)
+{
+    if (!statsActive)
+    {
+        statsStart = statsNow();
+        statsOwner = getpid();
+        atexit(statsReport);
+    }
+    statsActive = true;
+    statsTimePasses = statsTimePasses || timePasses;
+    statsMemory = statsMemory || memStats;
+    statsJson = statsJson || json;
+}
+
+void statsCollect(void)
+{
+    statsActive = true;
+}
+
+void statsTakePhases(uint64_t nanoseconds[PHASE_COUNT])
+{
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        nanoseconds[i] = __atomic_exchange_n(&statsPhases[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void statsAdd(StatsCounter counter, uint64_t amount)
+{
+    __atomic_fetch_add(&statsCounters[counter], amount, __ATOMIC_RELAXED);
+}
+
+uint64_t statsPhaseBegin(void)
+{
+    return statsActive ? statsNow() : 0;
+}
+
+void statsPhaseEnd(StatsPhase phase, uint64_t start)
+{
+    if (!statsActive) return;
+    __atomic_fetch_add(&statsPhases[phase], statsNow() - start, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file stats.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Per-phase timers, counters and memory statistics of compilation
+ * @version 0.1
+ * @date 2025-12-04
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Enabled by --time-passes, --mem-stats or --stats-json, the report is written to stderr when
+ * the process exits (also after errorExit). Counters are shared by all threads.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum
+{
+    PHASE_READ,        // reading source, line table, parallel prelexing
+    PHASE_PROLOGUE,    // readPrologue
+    PHASE_PARSE,       // parseProgram
+    PHASE_SEMANTIC,    // semanticResolveCheckLater
+    PHASE_FUN_DEC,     // checkFunDec
+    PHASE_BIND,        // bindProgram
+    PHASE_INFER,       // inferProgram
+    PHASE_GENERATE,    // generate
+    PHASE_COUNT
+} StatsPhase;
+
+typedef enum
+{
+    STAT_TOKENS,        // tokens consumed by parser
+    STAT_AST_NODES,     // nodes created by astCreateNode
+    STAT_SYMBOLS,       // symbols created in symbol tables (builtins included)
+    STAT_INSTRUCTIONS,  // lines of IFJcode25 emitted (cached functions are not counted)
+    STAT_LABELS,        // unique labels generated
+    STAT_TEMPS,         // temporary variables generated
+    STAT_ARENA_ALLOCS,  // allocations from arenas
+    STAT_ARENA_BLOCKS,  // arena blocks taken from malloc
+    STAT_ARENA_BYTES,   // bytes of arena blocks taken from malloc
+    STAT_SEM_TASKS,     // functions checked by semantic worker threads
+    STAT_GEN_TASKS,     // functions generated by codegen worker threads
+    STAT_COUNT
+} StatsCounter;
+
+extern bool statsActive;  // any statistics are collected, checked by STATS_COUNT
+
+// Cheap when statistics are off, a single load and branch
+#define STATS_COUNT(counter, amount)                     \
+    do                                                   \
+    {                                                    \
+        if (statsActive) statsAdd((counter), (amount)); \
+    } while (0)
+
+/**
+ * @brief Turn statistics on and register report at process exit
+ *
+ * Only the process that enabled statistics writes the report. Processes forked from it (compile
+ * requests of --serve) inherit the handler and counters, but stay silent, their stderr belongs
+ * to the compiled program.
+ *
+ * @param timePasses report time of phases
+ * @param memStats report memory usage
+ * @param json write report as one JSON object instead of table
+ */
+void statsEnable(bool timePasses, bool memStats, bool json);
+
+/**
+ * @brief Turn statistics on without report at exit, for tools reading them with statsTakePhases
+ */
+void statsCollect(void);
+
+/**
+ * @brief Copy time of every phase since last call (or statsCollect) and reset it to zero
+ *
+ * @param nanoseconds receives time of every phase, phases of concurrent compilations are summed
+ */
+void statsTakePhases(uint64_t nanoseconds[PHASE_COUNT]);
+
+/**
+ * @brief Add amount to counter (atomic, callable from any thread)
+ */
+void statsAdd(StatsCounter counter, uint64_t amount);
+
+/**
+ * @brief Start of phase
+ *
+ * @return uint64_t monotonic time in nanoseconds, 0 when statistics are off
+ */
+uint64_t statsPhaseBegin(void);
+
+/**
+ * @brief Add time since start to phase (phases of many files in --batch are summed)
+ *
+ * @param phase finished phase
+ * @param start value of statsPhaseBegin
+ */
+void statsPhaseEnd(StatsPhase phase, uint64_t start);
+
+#endif  // STATS_H
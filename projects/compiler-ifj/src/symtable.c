@@ -9,6 +9,8 @@
 
 #include "symtable.h"
 
+#include "error.h"
+#include "stats.h"
 #include "utils.h"
 
 /* --------------------------------------------------------------- */
@@ -20,39 +22,49 @@ SymTableStack *symTableStackCreate(int initial_capacity)
     SymTableStack *stack = malloc(sizeof(SymTableStack));
     if (!stack)
     {
-        fprintf(stderr, "Allocation error\n");
-        exit(1);
+        errorExit(INTERNAL_ERROR, "Failed to allocate symbol table stack", 0, NULL);
     }
 
-    stack->scopes = malloc(sizeof(Scope *) * initial_capacity);
+    stack->scopes = calloc(initial_capacity, sizeof(Scope *));
     if (!stack->scopes)
     {
         free(stack);
-        fprintf(stderr, "Allocation error\n");
-        exit(1);
+        errorExit(INTERNAL_ERROR, "Failed to allocate symbol table stack", 0, NULL);
     }
 
     stack->capacity = initial_capacity;
     stack->top = -1;
+    arenaInit(&stack->arena, 0);
     return stack;
 }
 
 void symTableStackPush(SymTableStack *stack)
 {
-    Scope *newScope = scopeCreate(16);
     if (stack->top + 1 >= stack->capacity)
     {
         int newCapacity = stack->capacity * 2;
         Scope **newTables = realloc(stack->scopes, sizeof(Scope *) * newCapacity);
         if (!newTables)
         {
-            fprintf(stderr, "Allocation error\n");
-            exit(1);
+            errorExit(INTERNAL_ERROR, "Failed to grow symbol table stack", 0, NULL);
         }
+        memset(newTables + stack->capacity, 0, sizeof(Scope *) * (newCapacity - stack->capacity));
         stack->scopes = newTables;
         stack->capacity = newCapacity;
     }
-    stack->scopes[++stack->top] = newScope;
+
+    // Scope nad vrcholem zůstal z posledního pop, stačí ho vyčistit
+    Scope *scope = stack->scopes[stack->top + 1];
+    if (scope)
+    {
+        scopeClear(scope);
+    }
+    else
+    {
+        scope = scopeCreate(&stack->arena, 16);
+    }
+    scope->parent = stack->top >= 0 ? stack->scopes[stack->top] : NULL;
+    stack->scopes[++stack->top] = scope;
 }
 
 void symTableStackPop(SymTableStack *stack)
@@ -61,7 +73,21 @@ void symTableStackPop(SymTableStack *stack)
     {
         return;
     }
-    freeScope(stack->scopes[stack->top--]);
+    stack->top--;
+}
+
+Scope *symTableStackFreeze(SymTableStack *stack)
+{
+    if (stack->top < 0)
+    {
+        return NULL;
+    }
+
+    // Slot uvolníme, aby další push nepřepsal snapshot
+    Scope *scope = stack->scopes[stack->top];
+    stack->scopes[stack->top--] = NULL;
+    scope->frozen = true;
+    return scope;
 }
 
 Scope *symTableStackGetScope(SymTableStack *stack, int index)
@@ -86,18 +112,39 @@ Symbol *symTableStackFindSymbol(SymTableStack *stack, char *name)
     return NULL;
 }
 
-void freeSymTableStack(SymTableStack *stack)
+Symbol *symTableStackFindUnique(SymTableStack *stack, const char *name, SymbolKind kind,
+                                int paramCount)
 {
-    if (!stack) return;
+    char buff[256];
+    int len = symbolFormatUniqueName(buff, sizeof(buff), name, kind, paramCount);
+    if (len < 0)
+    {
+        return NULL;
+    }
 
-    for (int i = 0; i <= stack->top; i++)
+    if ((size_t)len < sizeof(buff))
     {
-        if (stack->scopes[i] != NULL)
-        {
-            freeScope(stack->scopes[i]);
-        }
+        return symTableStackFindSymbol(stack, buff);
     }
 
+    // Dlouhé jméno se nevejde do bufferu
+    return symTableStackFindSymbol(stack,
+                                   symbolGetUniqueName(&stack->arena, name, kind, paramCount));
+}
+
+void symTableStackReset(SymTableStack *stack)
+{
+    // Scopes leží v aréně, push je po resetu nesmí znovu použít
+    memset(stack->scopes, 0, sizeof(Scope *) * stack->capacity);
+    stack->top = -1;
+    arenaReset(&stack->arena);
+}
+
+void freeSymTableStack(SymTableStack *stack)
+{
+    if (!stack) return;
+
+    arenaDispose(&stack->arena);
     free(stack->scopes);
     free(stack);
 }
@@ -106,24 +153,16 @@ void freeSymTableStack(SymTableStack *stack)
 /* SCOPE FUNCTIONS                                                 */
 /* --------------------------------------------------------------- */
 
-Scope *scopeCreate(int size)
+Scope *scopeCreate(Arena *arena, int size)
 {
-    Scope *scope = malloc(sizeof(Scope));
-    if (!scope)
-    {
-        fprintf(stderr, "Allocation error\n");
-        exit(1);
-    }
+    Scope *scope = arenaAlloc(arena, sizeof(Scope));
 
     scope->size = size;
     scope->currentSize = 0;
-    scope->symbols = calloc(size, sizeof(Symbol *));
-    if (!scope->symbols)
-    {
-        fprintf(stderr, "Allocation error\n");
-        free(scope);
-        exit(1);
-    }
+    scope->arena = arena;
+    scope->parent = NULL;
+    scope->frozen = false;
+    scope->symbols = arenaCalloc(arena, size * sizeof(Symbol *));
 
     return scope;
 }
@@ -132,13 +171,8 @@ int scopeDoubleCapacity(Scope *scope)
 {
     int newSize = scope->size * 2;
 
-    Symbol **newTable = calloc(newSize, sizeof(Symbol *));
-    if (!newTable)
-    {
-        fprintf(stderr, "Allocation error\n");
-        free(scope->symbols);
-        exit(1);
-    }
+    // Stará tabulka zůstane v aréně, uvolní se s celým SymTableStack
+    Symbol **newTable = arenaCalloc(scope->arena, newSize * sizeof(Symbol *));
 
     for (int i = 0; i < scope->size; i++)
     {
@@ -155,8 +189,6 @@ int scopeDoubleCapacity(Scope *scope)
         }
     }
 
-    free(scope->symbols);
-
     scope->symbols = newTable;
     scope->size = newSize;
 
@@ -177,7 +209,7 @@ int getHash(char *str, int size)
 
 int scopeAddSymbol(Scope *scope, Symbol *sym)
 {
-    if (!sym || !sym->name)
+    if (!sym || !sym->name || scope->frozen)
     {
         return -1;
     }
@@ -247,23 +279,28 @@ Symbol *scopeFindSymbol(Scope *scope, char *name)
     return NULL;
 }
 
-int freeScope(Scope *scope)
+Symbol *scopeChainFindSymbol(Scope *scope, char *name)
 {
-    if (scope == NULL)
+    for (; scope != NULL; scope = scope->parent)
     {
-        return -1;
+        Symbol *sym = scopeFindSymbol(scope, name);
+        if (sym != NULL)
+        {
+            return sym;
+        }
     }
+    return NULL;
+}
 
-    for (int i = 0; i < scope->size; i++)
+int scopeClear(Scope *scope)
+{
+    if (scope == NULL)
     {
-        if (scope->symbols[i] != NULL && scope->symbols[i] != TOMBSTONE)  // free valid pointers
-        {
-            freeSymbol(scope->symbols[i]);
-        }
+        return -1;
     }
 
-    free(scope->symbols);
-    free(scope);
+    memset(scope->symbols, 0, scope->size * sizeof(Symbol *));
+    scope->currentSize = 0;
 
     return 0;
 }
@@ -272,47 +309,33 @@ int freeScope(Scope *scope)
 /* SYMBOL FUNCTIONS                                                */
 /* --------------------------------------------------------------- */
 
-Symbol *symbolCreate(char *name, ExprType type, SymbolKind kind, int numOfParams)
+Symbol *symbolCreate(Arena *arena, const char *name, ExprType type, SymbolKind kind,
+                     int numOfParams)
 {
-    Symbol *new = malloc(sizeof(Symbol));
-    if (!new)
-    {
-        fprintf(stderr, "Allocation error\n");
-        exit(1);
-    }
-
-    // Deep copy basic name
-    size_t len = strlen(name);
-    new->name = malloc(len + 1);
-    if (!new->name)
-    {
-        fprintf(stderr, "Allocation error\n");
-        exit(1);
-    }
-    memcpy(new->name, name, len + 1);
+    Symbol *new = arenaAlloc(arena, sizeof(Symbol));
+    STATS_COUNT(STAT_SYMBOLS, 1);
 
     if (kind == SYM_FUNC || kind == SYM_GET || kind == SYM_SET)
     {
         // Create unique overload name
-        char *unique = symbolGetUniqueName(name, kind, numOfParams);
-        if (!unique)
-        {
-            fprintf(stderr, "Allocation error\n");
-            exit(1);
-        }
-
-        free(new->name);
-        new->name = unique;
+        new->name = symbolGetUniqueName(arena, name, kind, numOfParams);
+    }
+    else
+    {
+        new->name = arenaStrdup(arena, name);
     }
 
     new->expressionType = type;
     new->kind = kind;
     new->declared = false;
     new->numOfParams = numOfParams;
+    new->storage = STORAGE_UNBOUND;
+    new->slot = -1;
+    new->frameName = NULL;
 
     if (numOfParams > 0)
     {
-        new->paramTypes = malloc(sizeof(ExprType) * numOfParams);
+        new->paramTypes = arenaAlloc(arena, sizeof(ExprType) * numOfParams);
         for (int i = 0; i < numOfParams; i++) new->paramTypes[i] = TYPE_UNKNOWN;
     }
     else
@@ -333,51 +356,30 @@ void symbolUpdate(Symbol *dest, Symbol *source)
     }
 }
 
-char *symbolGetUniqueName(const char *name, SymbolKind kind, int paramCount)
+int symbolFormatUniqueName(char *buffer, size_t size, const char *name, SymbolKind kind,
+                           int paramCount)
 {
-    // Determine suffix length:
     // - getter: "#get"
     // - setter: "#set"
     // - normal function: "$<digits>"
-    const char *suffix = NULL;
-    char numericSuffix[16];  // enough for "$" + up to 10 digits + '\0'
-
     if (kind == SYM_GET)
     {
-        suffix = "#get";
+        return snprintf(buffer, size, "%s#get", name);
     }
     else if (kind == SYM_SET)
     {
-        suffix = "#set";
-    }
-    else
-    {
-        // normal function → append "$<paramCount>"
-        snprintf(numericSuffix, sizeof(numericSuffix), "$%d", paramCount);
-        suffix = numericSuffix;
+        return snprintf(buffer, size, "%s#set", name);
     }
 
-    // Allocate memory
-    size_t len = strlen(name) + strlen(suffix) + 1;  // +1 for '\0'
-    char *uniqueName = malloc(len);
-    if (!uniqueName)
-    {
-        fprintf(stderr, "Allocation failed\n");
-        return NULL;
-    }
-
-    // Build final name
-    strcpy(uniqueName, name);
-    strcat(uniqueName, suffix);
-
-    return uniqueName;
+    return snprintf(buffer, size, "%s$%d", name, paramCount);
 }
 
-void freeSymbol(Symbol *symbol)
+char *symbolGetUniqueName(Arena *arena, const char *name, SymbolKind kind, int paramCount)
 {
-    if (symbol != NULL)
-    {
-        free(symbol->name);
-        free(symbol);
-    }
+    // Suffix má nejvýše "$" + 10 číslic
+    size_t len = strlen(name) + 12;
+    char *uniqueName = arenaAlloc(arena, len);
+    symbolFormatUniqueName(uniqueName, len, name, kind, paramCount);
+
+    return uniqueName;
 }
@@ -15,6 +15,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+
 #define TOMBSTONE ((Symbol *)1)
 #define INITIAL_CAPACITY_STACK 32
 #define INITIAL_CAPACITY_SCOPE 64
@@ -39,6 +41,20 @@ typedef enum
     TYPE_BOOL = 1 << 5      // 100000 // 32
 } ExprType;
 
+/**
+ * @brief Where value of symbol lives in generated code, filled by binding pass
+ *
+ */
+typedef enum
+{
+    STORAGE_UNBOUND,  // binding pass has not visited symbol yet
+    STORAGE_GLOBAL,   // GF@frameName
+    STORAGE_LOCAL,    // LF@frameName, slot is index in function frame
+    STORAGE_GETTER,   // CALL frameName
+    STORAGE_SETTER,   // CALL frameName
+    STORAGE_FUNC,     // CALL frameName
+} StorageClass;
+
 typedef struct
 {
     char *name;
@@ -47,6 +63,9 @@ typedef struct
     ExprType *paramTypes;  // ADD THIS
     bool declared;
     int numOfParams;
+    StorageClass storage;  // resolved by bindProgram
+    int slot;              // index of local in function frame, -1 otherwise
+    char *frameName;       // unique operand/label name in IFJcode25
 } Symbol;
 
 /**
@@ -58,17 +77,23 @@ typedef struct Scope
     Symbol **symbols;
     int size;
     int currentSize;
+    Arena *arena;          // arena of owning SymTableStack, table grows inside it
+    struct Scope *parent;  // enclosing scope, NULL for global scope
+    bool frozen;           // snapshot taken by symTableStackFreeze, no more inserts
 } Scope;
 
 /**
  * @brief Main Structure holding all tables(lists)
  *
+ * Scopes, symbols, their names and paramTypes are allocated from arena and live
+ * until freeSymTableStack. Popped scopes stay above top and are reused by next push.
  */
 typedef struct SymTableStack
 {
     Scope **scopes;
     int capacity;
     int top;
+    Arena arena;
 } SymTableStack;
 
 // TODO funkce ktere se nebudou pouzivat mimo symtable.c tady byt nemusi (ale muzou)
@@ -95,11 +120,20 @@ SymTableStack *symTableStackCreate(int initial_capacity);
 void symTableStackPush(SymTableStack *stack);
 
 /**
- * @brief Deletes top scope on stack
+ * @brief Deletes top scope on stack, its memory is kept for next push
  * @param stack
  */
 void symTableStackPop(SymTableStack *stack);
 
+/**
+ * @brief Pops top scope and keeps it as immutable snapshot (never reused by push)
+ *
+ * Snapshot stays valid until freeSymTableStack and can be searched with scopeChainFindSymbol
+ * @param stack
+ * @return Scope* frozen scope, NULL if stack is empty
+ */
+Scope *symTableStackFreeze(SymTableStack *stack);
+
 /**
  * @brief returns Scope at specified index(scope depth)
  * @param stack
@@ -117,7 +151,25 @@ Scope *symTableStackGetScope(SymTableStack *stack, int index);
 Symbol *symTableStackFindSymbol(SymTableStack *stack, char *name);
 
 /**
- * @brief Unallocate SymTableStack structure
+ * @brief Searches function/getter/setter by its base name without allocating unique name
+ *
+ * @param stack - SymTableStack struct
+ * @param name - base name of symbol (without suffix)
+ * @param kind - SYM_FUNC, SYM_GET or SYM_SET
+ * @param paramCount - arity of function
+ * @return Symbol* found symbol, null if not in table
+ */
+Symbol *symTableStackFindUnique(SymTableStack *stack, const char *name, SymbolKind kind,
+                                int paramCount);
+
+/**
+ * @brief Empties stack for next compilation, blocks of its arena are kept for reuse
+ * @param stack
+ */
+void symTableStackReset(SymTableStack *stack);
+
+/**
+ * @brief Unallocate SymTableStack structure together with its arena
  * @param stack
  */
 void freeSymTableStack(SymTableStack *stack);
@@ -127,12 +179,13 @@ void freeSymTableStack(SymTableStack *stack);
 /* --------------------------------------------------------------- */
 
 /**
- * @brief Creates (Scope *) of size
+ * @brief Creates (Scope *) of size inside arena
  *
+ * @param arena arena holding scope and its table
  * @param size size of table
  * @return Scope*
  */
-Scope *scopeCreate(int size);
+Scope *scopeCreate(Arena *arena, int size);
 
 /**
  * @brief Doubles capacity of Scope
@@ -168,29 +221,38 @@ int scopeAddSymbol(Scope *scope, Symbol *sym);
 Symbol *scopeFindSymbol(Scope *scope, char *name);
 
 /**
- * @brief Delete and Unallocate given Scope
+ * @brief Searches Symbol in scope and all its parents
+ *
+ * @param scope innermost scope of the chain
+ * @param name find item with this name
+ * @return Symbol* found symbol, null if not in chain
+ */
+Symbol *scopeChainFindSymbol(Scope *scope, char *name);
+
+/**
+ * @brief Removes all symbols from Scope so it can be reused, nothing is freed
  *
  * @param scope Scope
  * @return int
  */
-int freeScope(Scope *scope);
+int scopeClear(Scope *scope);
 
 /* --------------------------------------------------------------- */
 /* SYMBOL FUNCTIONS                                                */
 /* --------------------------------------------------------------- */
 
 /**
- * @brief Creates a new Symbol
+ * @brief Creates a new Symbol in arena
  *
+ * @param arena Arena owning the symbol (usually &stack->arena)
  * @param name Symbol->name
  * @param type Symbol->type
  * @param kind Symbol->kind
- * @param scope Symbol->scope
- * @param lineOfCode Symbol->lineOfCode
  * @param numOfParams Symbol->numOfParams
  * @return Symbol*
  */
-Symbol *symbolCreate(char *name, ExprType type, SymbolKind kind, int numOfParams);
+Symbol *symbolCreate(Arena *arena, const char *name, ExprType type, SymbolKind kind,
+                     int numOfParams);
 
 /**
  * @brief Update Symbol values
@@ -201,17 +263,26 @@ Symbol *symbolCreate(char *name, ExprType type, SymbolKind kind, int numOfParams
 void symbolUpdate(Symbol *dest, Symbol *src);
 
 /**
- * @brief //TODO DOPSAT POPIS
+ * @brief Writes unique name of function ("name$N"), getter ("name#get") or setter ("name#set")
  *
- * @param name
- * @param scopeID
- * @return char*
+ * @param buffer output buffer
+ * @param size size of buffer
+ * @param name base name
+ * @param kind kind of symbol
+ * @param paramCount arity of function
+ * @return int length of unique name (as snprintf)
  */
-char *symbolGetUniqueName(const char *name, SymbolKind kind, int paramCount);
+int symbolFormatUniqueName(char *buffer, size_t size, const char *name, SymbolKind kind,
+                           int paramCount);
+
 /**
- * @brief Delete and Unallocate given symbol
+ * @brief Returns unique name of function/getter/setter allocated in arena
  *
- * @param symbol Delete this symbol
+ * @param arena arena to allocate from
+ * @param name base name
+ * @param kind kind of symbol
+ * @param paramCount arity of function
+ * @return char*
  */
-void freeSymbol(Symbol *symbol);
+char *symbolGetUniqueName(Arena *arena, const char *name, SymbolKind kind, int paramCount);
 #endif  // SYMTABLE_H
\ No newline at end of file
@@ -0,0 +1,178 @@
+/**
+ * @file threadpool.c
+ * @author Filip Knapo (xknapof00)
+ * @brief Fixed size pool of worker threads executing submitted tasks
+ * @version 0.1
+ * @date 2025-11-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "error.h"
+
+typedef struct PoolJob
+{
+    ThreadPoolTask task;
+    void *arg;
+    struct PoolJob *next;
+} PoolJob;
+
+struct ThreadPool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t hasWork;  // signalled when job is queued or pool stops
+    pthread_cond_t idle;     // signalled when last pending job finishes
+    PoolJob *head;
+    PoolJob *tail;
+    int pending;  // queued + running jobs
+    bool stopping;
+    int threadCount;
+    pthread_t *threads;
+};
+
+// Pool whose worker is the calling thread, NULL outside of workers
+static pthread_key_t workerKey;
+static pthread_once_t workerKeyOnce = PTHREAD_ONCE_INIT;
+
+static void workerKeyCreate(void)
+{
+    pthread_key_create(&workerKey, NULL);
+}
+
+static void *poolWorker(void *arg)
+{
+    ThreadPool *pool = arg;
+    pthread_once(&workerKeyOnce, workerKeyCreate);
+    pthread_setspecific(workerKey, pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (true)
+    {
+        while (!pool->head && !pool->stopping)
+        {
+            pthread_cond_wait(&pool->hasWork, &pool->lock);
+        }
+        if (!pool->head) break;  // stopping and nothing left
+
+        PoolJob *job = pool->head;
+        pool->head = job->next;
+        if (!pool->head) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+        job->task(job->arg);
+        free(job);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0)
+        {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static int threadPoolOverride = 0;  // 0 = number of online CPUs
+
+int threadPoolDefaultSize(void)
+{
+    // Vnořený pool by k vláknům vnějšího přidal další, úloha workeru běží sériově
+    pthread_once(&workerKeyOnce, workerKeyCreate);
+    if (pthread_getspecific(workerKey)) return 1;
+
+    if (threadPoolOverride > 0) return threadPoolOverride;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 1 ? (int)cpus : 1;
+}
+
+void threadPoolSetDefaultSize(int threads)
+{
+    threadPoolOverride = threads > 0 ? threads : 0;
+}
+
+ThreadPool *threadPoolCreate(int threads)
+{
+    if (threads < 1) threads = 1;
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool) errorExit(INTERNAL_ERROR, "Unable to allocate thread pool", 0, NULL);
+
+    pool->threads = malloc(sizeof(pthread_t) * threads);
+    if (!pool->threads) errorExit(INTERNAL_ERROR, "Unable to allocate thread pool", 0, NULL);
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->hasWork, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    for (int i = 0; i < threads; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, poolWorker, pool) != 0)
+        {
+            errorExit(INTERNAL_ERROR, "Unable to start worker thread", 0, NULL);
+        }
+        pool->threadCount++;
+    }
+
+    return pool;
+}
+
+void threadPoolSubmit(ThreadPool *pool, ThreadPoolTask task, void *arg)
+{
+    PoolJob *job = malloc(sizeof(PoolJob));
+    if (!job) errorExit(INTERNAL_ERROR, "Unable to allocate thread pool job", 0, NULL);
+    job->task = task;
+    job->arg = arg;
+    job->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail)
+        pool->tail->next = job;
+    else
+        pool->head = job;
+    pool->tail = job;
+    pool->pending++;
+    pthread_cond_signal(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadPoolWait(ThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0)
+    {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadPoolDestroy(ThreadPool *pool)
+{
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->threadCount; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->hasWork);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
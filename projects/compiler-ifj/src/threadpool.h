@@ -0,0 +1,70 @@
+/**
+ * @file threadpool.h
+ * @author Filip Knapo (xknapof00)
+ * @brief Fixed size pool of worker threads executing submitted tasks
+ * @version 0.1
+ * @date 2025-11-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+typedef void (*ThreadPoolTask)(void *arg);
+
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief Number of workers worth starting on this machine (online CPUs)
+ *
+ * Called from a worker of some pool it returns 1, so tasks that would start a pool of their
+ * own (batch worker compiling with parallel passes) take their serial path instead and the
+ * process never runs more threads than the outer pool.
+ *
+ * @return int at least 1, the value of threadPoolSetDefaultSize when it was set
+ */
+int threadPoolDefaultSize(void);
+
+/**
+ * @brief Overrides threadPoolDefaultSize for the whole process (--threads=N)
+ *
+ * Lets tests run parallel paths on a machine with one CPU.
+ *
+ * @param threads number of workers, values < 1 restore the number of online CPUs
+ */
+void threadPoolSetDefaultSize(int threads);
+
+/**
+ * @brief Start pool with given number of worker threads
+ *
+ * @param threads number of workers (values < 1 mean 1)
+ * @return ThreadPool* never NULL, exits with INTERNAL_ERROR on failure
+ */
+ThreadPool *threadPoolCreate(int threads);
+
+/**
+ * @brief Queue task, it is run by the first idle worker
+ *
+ * @param pool pool to run task
+ * @param task function to call
+ * @param arg argument of task
+ */
+void threadPoolSubmit(ThreadPool *pool, ThreadPoolTask task, void *arg);
+
+/**
+ * @brief Block until every submitted task has finished
+ *
+ * @param pool pool to wait for
+ */
+void threadPoolWait(ThreadPool *pool);
+
+/**
+ * @brief Wait for queued tasks, stop workers and free pool
+ *
+ * @param pool pool to destroy (may be NULL)
+ */
+void threadPoolDestroy(ThreadPool *pool);
+
+#endif  // THREADPOOL_H
@@ -10,6 +10,9 @@
  *
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -19,6 +22,7 @@
 #include "error.h"
 #include "parser.h"
 #include "semantic.h"
+#include "stats.h"
 
 #define MAX_TYPE_STRING_LEN 100
 /**
@@ -295,7 +299,7 @@ void printToken(Token* token)
 {
     printf("Token: ");
     printTokenValue(token);
-    printf("\tType: %s\tLine: %d\n", tokenTypeStr(token->type), token->line);
+    printf("\tType: %s\tLine: %d\n", tokenTypeStr(token->type), tokenLine(token));
 }
 
 /* ----------------------------------------------------- */
@@ -461,26 +465,21 @@ void printASTTree(AstNode* node, int level, int isLast, int* prefix)
             case AST_BLOCK:
             case AST_PARAMS:
             {
-                AstN* nchildren = (AstN*)node->children;
-                ListItem* item =
-                    nchildren->childrenList ? nchildren->childrenList->firstItem : NULL;
+                NodeVec* nodes = &((AstN*)node->children)->nodes;
 
                 // Count children
-                ListItem* temp = item;
-                while (temp)
+                for (long i = 0; i < nodes->count; i++)
                 {
-                    if (temp->item) childCount++;
-                    temp = temp->next;
+                    if (nodes->items[i]) childCount++;
                 }
 
                 if (childCount > 0)
                 {
                     children = malloc(childCount * sizeof(AstNode*));
                     int idx = 0;
-                    while (item)
+                    for (long i = 0; i < nodes->count; i++)
                     {
-                        if (item->item) children[idx++] = item->item;
-                        item = item->next;
+                        if (nodes->items[i]) children[idx++] = nodes->items[i];
                     }
                 }
                 break;
@@ -505,27 +504,51 @@ void printASTTree(AstNode* node, int level, int isLast, int* prefix)
 /* Helper print functions for codegen         */
 /* ------------------------------------------ */
 
+// Výstup má každé vlákno vlastní, funkce se generujú paralelne do oddelených bufferov
+static pthread_key_t emitOutputKey;
+static pthread_once_t emitOutputKeyOnce = PTHREAD_ONCE_INIT;
+
+static void emitOutputKeyCreate(void)
+{
+    pthread_key_create(&emitOutputKey, NULL);
+}
+
+void emitSetOutput(FILE* output)
+{
+    pthread_once(&emitOutputKeyOnce, emitOutputKeyCreate);
+    pthread_setspecific(emitOutputKey, output);
+}
+
+FILE* emitGetOutput(void)
+{
+    pthread_once(&emitOutputKeyOnce, emitOutputKeyCreate);
+    FILE* output = pthread_getspecific(emitOutputKey);
+    return output ? output : stdout;  // NULL = stdout
+}
+
 void emit(const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    vprintf(fmt, args);
+    vfprintf(emitGetOutput(), fmt, args);
     va_end(args);
 }
 
 void emitIndent(int indent)
 {
-    for (int i = 0; i < indent; i++) printf("    ");  // 4 mezery
+    for (int i = 0; i < indent; i++) fputs("    ", emitGetOutput());  // 4 mezery
 }
 
 void emitLine(const char* fmt, ...)
 {
+    FILE* output = emitGetOutput();
     va_list args;
     va_start(args, fmt);
-    vprintf(fmt, args);
+    vfprintf(output, fmt, args);
     va_end(args);
 
-    printf("\n");
+    fputc('\n', output);
+    STATS_COUNT(STAT_INSTRUCTIONS, 1);
 }
 
 #include "symtable.h"
@@ -12,8 +12,6 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-#define ASTSTACK_MAX 100
-
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -27,6 +25,8 @@ void printToken(Token* token);
 void printASTTree(AstNode* node, int level, int isLast, int* prefix);
 const char* astNodeTypeName(AstNodeType type);
 
+void emitSetOutput(FILE* output);  // target of emit functions of calling thread, NULL = stdout
+FILE* emitGetOutput(void);
 void emitIndent(int indent);
 void emit(const char* fmt, ...);
 void emitLine(const char* fmt, ...);